@@ -0,0 +1,234 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "aes_api.hpp"
+#include "aes_cipher.hpp"
+#include "codec_data.hpp"
+
+namespace {
+
+cryptopp::buffer_t const key = [] {
+  std::string const str = "BAF7D2A2B1EAF3BE64AA64C3A0938E06";
+  return cryptopp::buffer_t(str.begin(), str.end());
+}();
+cryptopp::buffer_t const iv(CryptoPP::AES::BLOCKSIZE, 0x24);
+cryptopp::buffer_t const gcm_iv(cryptopp::GCM_IV_LENGTH, 0x24);
+
+cryptopp::buffer_t plain_text(benchmark::State const &state) {
+  auto const &input = codec_bench::payload(state);
+  return cryptopp::buffer_t(input.begin(), input.end());
+}
+
+}  // namespace
+
+static void BM_AesCbcEncrypt(benchmark::State &state) {
+  auto const plain = plain_text(state);
+  cryptopp::buffer_t cipher{};
+  cipher.reserve(cryptopp::GetCipherLen(plain.size()));
+
+  for (auto _ : state) {
+    cipher.clear();  // AesCbcEncrypt appends
+    if (!cryptopp::AesCbcEncrypt(key, iv, plain, cipher)) {
+      state.SkipWithError("AesCbcEncrypt failed");
+      break;
+    }
+    benchmark::DoNotOptimize(cipher.data());
+  }
+  codec_bench::report(state, plain.size(), 0);
+}
+BENCHMARK(BM_AesCbcEncrypt)->Apply(codec_bench::payload_args)->UseRealTime();
+
+static void BM_AesCbcDecrypt(benchmark::State &state) {
+  auto const plain = plain_text(state);
+  cryptopp::buffer_t cipher{};
+  if (!cryptopp::AesCbcEncrypt(key, iv, plain, cipher)) {
+    state.SkipWithError("AesCbcEncrypt failed");
+    return;
+  }
+  cryptopp::buffer_t recovered{};
+  recovered.reserve(cipher.size());
+
+  for (auto _ : state) {
+    recovered.clear();
+    if (!cryptopp::AesCbcDecrypt(key, iv, cipher, recovered)) {
+      state.SkipWithError("AesCbcDecrypt failed");
+      break;
+    }
+    benchmark::DoNotOptimize(recovered.data());
+  }
+  codec_bench::report(state, cipher.size(), 0);
+}
+BENCHMARK(BM_AesCbcDecrypt)->Apply(codec_bench::payload_args)->UseRealTime();
+
+static void BM_AesCtrEncrypt(benchmark::State &state) {
+  auto const plain = plain_text(state);
+  cryptopp::buffer_t cipher{};
+  for (auto _ : state) {
+    if (!cryptopp::AesCtrEncrypt(key, iv, plain, cipher)) {
+      state.SkipWithError("AesCtrEncrypt failed");
+      break;
+    }
+    benchmark::DoNotOptimize(cipher.data());
+  }
+  codec_bench::report(state, plain.size(), 0);
+}
+BENCHMARK(BM_AesCtrEncrypt)->Apply(codec_bench::payload_args)->UseRealTime();
+
+static void BM_AesGcmEncrypt(benchmark::State &state) {
+  auto const plain = plain_text(state);
+  cryptopp::buffer_t cipher{};
+  for (auto _ : state) {
+    if (!cryptopp::AesGcmEncrypt(key, gcm_iv, plain, cipher)) {
+      state.SkipWithError("AesGcmEncrypt failed");
+      break;
+    }
+    benchmark::DoNotOptimize(cipher.data());
+  }
+  codec_bench::report(state, plain.size(), 0);
+}
+BENCHMARK(BM_AesGcmEncrypt)->Apply(codec_bench::payload_args)->UseRealTime();
+
+static void BM_AesGcmDecrypt(benchmark::State &state) {
+  auto const plain = plain_text(state);
+  cryptopp::buffer_t cipher{}, recovered{};
+  if (!cryptopp::AesGcmEncrypt(key, gcm_iv, plain, cipher)) {
+    state.SkipWithError("AesGcmEncrypt failed");
+    return;
+  }
+  for (auto _ : state) {
+    if (!cryptopp::AesGcmDecrypt(key, gcm_iv, cipher, recovered)) {
+      state.SkipWithError("AesGcmDecrypt failed");
+      break;
+    }
+    benchmark::DoNotOptimize(recovered.data());
+  }
+  codec_bench::report(state, plain.size(), 0);
+}
+BENCHMARK(BM_AesGcmDecrypt)->Apply(codec_bench::payload_args)->UseRealTime();
+
+// Thread scaling on 256 MiB: CTR split into counter ranges vs. serial CBC (threads:0)
+static void BM_AesEncryptThreads(benchmark::State &state) {
+  auto const threads = static_cast<std::size_t>(state.range(0));
+  cryptopp::buffer_t const plain(std::size_t{256} << 20, 0x61);
+  cryptopp::buffer_t cipher{};
+  cipher.reserve(cryptopp::GetCipherLen(plain.size()));
+  utils::ThreadPool pool{std::max<std::size_t>(threads, 1)};
+
+  for (auto _ : state) {
+    bool ok = true;
+    if (threads == 0) {
+      cipher.clear();
+      ok = cryptopp::AesCbcEncrypt(key, iv, plain, cipher);
+    } else {
+      ok = cryptopp::AesCtrEncryptParallel(key, iv, plain, cipher, pool);
+    }
+    if (!ok) {
+      state.SkipWithError("encryption failed");
+      break;
+    }
+    benchmark::DoNotOptimize(cipher.data());
+  }
+  codec_bench::report(state, plain.size(), 0);
+}
+BENCHMARK(BM_AesEncryptThreads)
+    ->ArgName("threads")
+    ->Arg(0)
+    ->DenseRange(1, 8)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+// Thread scaling of CBC decryption on 256 MiB: AesCbcDecrypt (threads:0) vs. AesCbcDecryptParallel
+static void BM_AesCbcDecryptThreads(benchmark::State &state) {
+  auto const threads = static_cast<std::size_t>(state.range(0));
+  cryptopp::buffer_t const plain(std::size_t{256} << 20, 0x61);
+  cryptopp::buffer_t cipher{}, recovered{};
+  if (!cryptopp::AesCbcEncrypt(key, iv, plain, cipher)) {
+    state.SkipWithError("AesCbcEncrypt failed");
+    return;
+  }
+  recovered.reserve(cipher.size());
+  utils::ThreadPool pool{std::max<std::size_t>(threads, 1)};
+
+  for (auto _ : state) {
+    bool ok = true;
+    if (threads == 0) {
+      recovered.clear();
+      ok = cryptopp::AesCbcDecrypt(key, iv, cipher, recovered);
+    } else {
+      ok = cryptopp::AesCbcDecryptParallel(key, iv, cipher, recovered, pool);
+    }
+    if (!ok) {
+      state.SkipWithError("decryption failed");
+      break;
+    }
+    benchmark::DoNotOptimize(recovered.data());
+  }
+  codec_bench::report(state, cipher.size(), 0);
+}
+BENCHMARK(BM_AesCbcDecryptThreads)
+    ->ArgName("threads")
+    ->Arg(0)
+    ->DenseRange(1, 8)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+// Many 256-byte records, each with its own IV: items/s = messages/s
+namespace {
+
+constexpr std::size_t record_size = 256;
+constexpr std::size_t record_count = 4096;
+
+struct Records {
+  cryptopp::buffer_t plain = cryptopp::buffer_t(record_size * record_count, 0x61);
+  cryptopp::buffer_t ivs = cryptopp::buffer_t(CryptoPP::AES::BLOCKSIZE * record_count, 0x24);
+
+  std::span<cryptopp::byte_t const> record(std::size_t i) const {
+    return std::span(plain).subspan(i * record_size, record_size);
+  }
+  cryptopp::byte_t const *iv(std::size_t i) const { return ivs.data() + i * CryptoPP::AES::BLOCKSIZE; }
+};
+
+}  // namespace
+
+static void BM_AesCbcEncryptRecords(benchmark::State &state) {
+  Records const records{};
+  cryptopp::buffer_t iv_copy(CryptoPP::AES::BLOCKSIZE), plain(record_size), cipher{};
+  for (auto _ : state) {
+    for (std::size_t i = 0; i < record_count; ++i) {
+      std::copy_n(records.iv(i), iv_copy.size(), iv_copy.begin());
+      std::copy_n(records.record(i).begin(), record_size, plain.begin());
+      cipher.clear();
+      if (!cryptopp::AesCbcEncrypt(key, iv_copy, plain, cipher)) {
+        state.SkipWithError("AesCbcEncrypt failed");
+        return;
+      }
+      benchmark::DoNotOptimize(cipher.data());
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(record_count));
+  state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(records.plain.size()));
+}
+BENCHMARK(BM_AesCbcEncryptRecords)->UseRealTime();
+
+static void BM_AesCipherEncryptRecords(benchmark::State &state) {
+  Records const records{};
+  cryptopp::AesCipher cipher_object(key);
+  auto const cipher_len = cryptopp::GetCipherLen(record_size);
+  cryptopp::buffer_t out(cipher_len * record_count);
+  std::vector<cryptopp::AesMessage> messages{};
+  for (std::size_t i = 0; i < record_count; ++i) {
+    messages.push_back({records.iv(i), records.record(i), std::span(out).subspan(i * cipher_len, cipher_len)});
+  }
+  for (auto _ : state) {
+    cipher_object.encrypt_batch(messages);
+    benchmark::DoNotOptimize(out.data());
+  }
+  state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(record_count));
+  state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(records.plain.size()));
+}
+BENCHMARK(BM_AesCipherEncryptRecords)->UseRealTime();
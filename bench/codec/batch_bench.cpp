@@ -0,0 +1,214 @@
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+#include "codec_data.hpp"
+#include "lz4_batch.hpp"
+#include "zstdpp_batch.hpp"
+
+/* Batch API (one arena per batch) against the per-call loop
+ *
+ * 10k records of 64 .. 1024 bytes of logs. The per-call loop keeps one
+ * vector per output record, as callers of zstdpp::compress / lz4::compress
+ * do; the batch functions write one reused utils::Batch. `allocs/batch`
+ * counts every operator new of the iteration (operator new is replaced in
+ * this binary, hence its own executable: one relaxed atomic increment per
+ * allocation).
+ *
+ *   BatchBench
+ */
+namespace {
+
+std::atomic<std::size_t> allocations{0};
+
+}  // namespace
+
+void *operator new(std::size_t size) {
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void *p = std::malloc(size == 0 ? 1 : size)) {
+    return p;
+  }
+  throw std::bad_alloc{};
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment) {
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  auto const align = static_cast<std::size_t>(alignment);
+  if (void *p = std::aligned_alloc(align, (size + align - 1) / align * align)) {
+    return p;
+  }
+  throw std::bad_alloc{};
+}
+
+// GCC warns about free() on memory from `new`, not knowing the allocation above is malloc
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+void operator delete(void *p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+namespace {
+
+constexpr std::size_t record_count = 10000;
+
+/// Records cut from the logs corpus, 64 .. 1024 bytes each
+utils::Batch const &records() {
+  static auto const batch = [] {
+    auto const logs = utils::corpus::generate(utils::corpus::Kind::logs, record_count * 1024);
+    utils::Batch cut{};
+    std::size_t pos = 0;
+    for (std::size_t i = 0; i < record_count; ++i) {
+      auto const size = 64 + (i * 7919) % 961;
+      cut.push_back(std::span(reinterpret_cast<std::byte const *>(logs.data()) + pos, size));
+      pos += size;
+    }
+    return cut;
+  }();
+  return batch;
+}
+
+/// The same records, one vector each
+std::vector<utils::byte_buffer> const &record_vectors() {
+  static auto const vectors = [] {
+    std::vector<utils::byte_buffer> copies{};
+    for (auto record : records().records()) {
+      auto const *p = reinterpret_cast<std::uint8_t const *>(record.data());
+      copies.emplace_back(p, p + record.size());
+    }
+    return copies;
+  }();
+  return vectors;
+}
+
+utils::ThreadPool &threads() {
+  static utils::ThreadPool pool{4};
+  return pool;
+}
+
+/// `batch` runs once per iteration; counters: records/s, allocations per batch, ratio
+template <typename F>
+void run(benchmark::State &state, F &&batch, std::size_t compressed_size) {
+  auto const before = allocations.load(std::memory_order_relaxed);
+  for (auto _ : state) {
+    batch();
+  }
+  auto const count = allocations.load(std::memory_order_relaxed) - before;
+  state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * record_count));
+  state.counters["allocs/batch"] =
+      benchmark::Counter(static_cast<double>(count), benchmark::Counter::kAvgIterations);
+  codec_bench::report(state, records().arena.size(), compressed_size);
+}
+
+utils::ThreadPool *pool_arg(benchmark::State const &state) { return state.range(0) == 0 ? nullptr : &threads(); }
+
+void BM_ZstdPerCallCompress(benchmark::State &state) {
+  std::vector<zstdpp::buffer_t> out{};
+  std::size_t size = 0;
+  run(state, [&] {
+    out.clear();
+    size = 0;
+    for (auto const &record : record_vectors()) {
+      out.push_back(zstdpp::compress(record, 3));
+      size += out.back().size();
+    }
+  }, 0);
+  state.counters["ratio"] = static_cast<double>(records().arena.size()) / static_cast<double>(size);
+}
+
+void BM_ZstdBatchCompress(benchmark::State &state) {
+  auto const inputs = records().records();
+  zstdpp::Batch out{};
+  zstdpp::compress_batch(inputs, out, 3, pool_arg(state));  // warm: the arena keeps its capacity
+  run(state, [&] { zstdpp::compress_batch(inputs, out, 3, pool_arg(state)); }, out.arena.size());
+}
+
+void BM_ZstdPerCallDecompress(benchmark::State &state) {
+  std::vector<zstdpp::buffer_t> compressed{};
+  for (auto const &record : record_vectors()) {
+    compressed.push_back(zstdpp::compress(record, 3));
+  }
+  std::vector<zstdpp::buffer_t> out{};
+  run(state, [&] {
+    out.clear();
+    for (auto const &frame : compressed) {
+      out.push_back(zstdpp::decompress(frame));
+    }
+  }, 0);
+}
+
+void BM_ZstdBatchDecompress(benchmark::State &state) {
+  zstdpp::Batch compressed{}, out{};
+  zstdpp::compress_batch(records().records(), compressed);
+  auto const inputs = compressed.records();
+  zstdpp::decompress_batch(inputs, out, pool_arg(state));
+  run(state, [&] { zstdpp::decompress_batch(inputs, out, pool_arg(state)); }, compressed.arena.size());
+}
+
+void BM_Lz4PerCallCompress(benchmark::State &state) {
+  std::vector<lz4::buffer_t> out{};
+  std::size_t size = 0;
+  run(state, [&] {
+    out.clear();
+    size = 0;
+    for (auto const &record : record_vectors()) {
+      out.emplace_back();
+      size += lz4::compress(record, out.back());
+    }
+  }, 0);
+  state.counters["ratio"] = static_cast<double>(records().arena.size()) / static_cast<double>(size);
+}
+
+void BM_Lz4BatchCompress(benchmark::State &state) {
+  auto const inputs = records().records();
+  lz4::Batch out{};
+  lz4::compress_batch(inputs, out, lz4::default_level, pool_arg(state));
+  run(state, [&] { lz4::compress_batch(inputs, out, lz4::default_level, pool_arg(state)); }, out.arena.size());
+}
+
+void BM_Lz4PerCallDecompress(benchmark::State &state) {
+  std::vector<lz4::buffer_t> compressed(record_count);
+  for (std::size_t i = 0; i < record_count; ++i) {
+    lz4::compress(record_vectors()[i], compressed[i]);
+  }
+  std::vector<lz4::buffer_t> out{};
+  run(state, [&] {
+    out.clear();
+    for (std::size_t i = 0; i < record_count; ++i) {
+      out.emplace_back();
+      lz4::decompress(compressed[i], out.back(), record_vectors()[i].size());
+    }
+  }, 0);
+}
+
+void BM_Lz4BatchDecompress(benchmark::State &state) {
+  lz4::Batch compressed{}, out{};
+  lz4::compress_batch(records().records(), compressed);
+  auto const inputs = compressed.records();
+  auto const sizes = records().sizes();
+  lz4::decompress_batch(inputs, sizes, out, pool_arg(state));
+  run(state, [&] { lz4::decompress_batch(inputs, sizes, out, pool_arg(state)); }, compressed.arena.size());
+}
+
+}  // namespace
+
+BENCHMARK(BM_ZstdPerCallCompress)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_ZstdBatchCompress)->ArgName("threads")->Arg(0)->Arg(4)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_ZstdPerCallDecompress)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_ZstdBatchDecompress)->ArgName("threads")->Arg(0)->Arg(4)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_Lz4PerCallCompress)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_Lz4BatchCompress)->ArgName("threads")->Arg(0)->Arg(4)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_Lz4PerCallDecompress)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_Lz4BatchDecompress)->ArgName("threads")->Arg(0)->Arg(4)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
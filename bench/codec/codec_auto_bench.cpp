@@ -0,0 +1,68 @@
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "codec_auto.hpp"
+#include "codec_data.hpp"
+
+/* auto_compress against fixed zstd level 3 over a mixed corpus
+ *
+ * 48 blobs of 4 KiB .. 1 MiB: text, logs, JSON and numeric records, plus a
+ * third of random blobs standing for already compressed media. The CPU
+ * column is the total for the corpus; `ratio` is corpus input / output.
+ */
+namespace {
+
+std::vector<utils::byte_buffer> const &mixed_corpus() {
+  static auto const corpus = [] {
+    using utils::corpus::Kind;
+    constexpr Kind kinds[] = {Kind::text, Kind::random, Kind::logs, Kind::json, Kind::random, Kind::numeric};
+    constexpr std::size_t sizes[] = {4 << 10, 64 << 10, 256 << 10, 1 << 20};
+    std::vector<utils::byte_buffer> blobs{};
+    std::uint64_t seed = 1;
+    for (int round = 0; round < 2; ++round) {
+      for (auto size : sizes) {
+        for (auto kind : kinds) {
+          blobs.push_back(utils::corpus::generate(kind, size, seed++));
+        }
+      }
+    }
+    return blobs;
+  }();
+  return corpus;
+}
+
+template <typename F>
+void run(benchmark::State &state, F &&compress) {
+  auto const &corpus = mixed_corpus();
+  std::size_t input = 0;
+  std::size_t output = 0;
+  for (auto _ : state) {
+    input = 0;
+    output = 0;
+    for (auto const &blob : corpus) {
+      auto const packed = compress(blob);
+      benchmark::DoNotOptimize(packed.data());
+      input += blob.size();
+      output += packed.size();
+    }
+  }
+  codec_bench::report(state, input, output);
+}
+
+void BM_FixedZstd3(benchmark::State &state) {
+  run(state, [](utils::byte_buffer const &blob) { return zstdpp::compress(blob, 3); });
+}
+
+void BM_AutoCompress(benchmark::State &state, codec::Policy const &policy) {
+  run(state, [&](utils::byte_buffer const &blob) { return codec::auto_compress(codec::as_bytes(blob), policy); });
+}
+
+}  // namespace
+
+BENCHMARK(BM_FixedZstd3)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_AutoCompress, balanced, codec::Policy{})->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_AutoCompress, fast, codec::Policy::fast())->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_AutoCompress, ratio, codec::Policy::ratio())->Unit(benchmark::kMillisecond);
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include "byte_buffer.hpp"
+#include "corpus.hpp"
+
+/* Payloads shared by the CodecBench benchmarks
+ *
+ * Every benchmark takes two arguments: the data kind and the payload size
+ * (64 B .. 1 GiB). Payloads come from the synthetic corpus (corpus.hpp):
+ * data/ files written by corpus_gen when present, generated otherwise,
+ * identical on every machine. They are loaded outside the timed region and
+ * only the last one is kept, so the 1 GiB cases need about 2 GiB of memory
+ * (payload + output), not more.
+ *
+ *   CodecBench --benchmark_filter='BM_Zstd[A-Za-z]+/kind:0/size:4096/'
+ */
+namespace codec_bench {
+
+using DataKind = utils::corpus::Kind;
+
+/// The `kind` argument: an index in this list
+inline constexpr std::array kinds = {DataKind::text, DataKind::json, DataKind::random, DataKind::zeros};
+
+inline constexpr std::int64_t max_size = std::int64_t{1} << 30;
+
+/// Payload for (state.range(0), state.range(1)); cached until the next call with other arguments
+inline utils::byte_buffer const &payload(benchmark::State const &state) {
+  static DataKind kind{};
+  static utils::byte_buffer cache{};
+  auto const want_kind = kinds.at(static_cast<std::size_t>(state.range(0)));
+  auto const want_size = static_cast<std::size_t>(state.range(1));
+  if (cache.size() != want_size || kind != want_kind || want_size == 0) {
+    cache = utils::byte_buffer{};  // free the previous one first
+    cache = utils::corpus::load(want_kind, want_size);
+    kind = want_kind;
+  }
+  return cache;
+}
+
+/// Throughput and compression ratio (input / output) counters
+inline void report(benchmark::State &state, std::size_t input_size, std::size_t output_size) {
+  state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations()) * static_cast<std::int64_t>(input_size));
+  if (output_size > 0) {
+    state.counters["ratio"] = static_cast<double>(input_size) / static_cast<double>(output_size);
+  }
+}
+
+/// kind x size matrix: 64 B, 4 KiB, 256 KiB, 16 MiB, 1 GiB
+template <typename F>
+void for_each_payload(F &&f) {
+  for (std::int64_t kind = 0; kind < static_cast<std::int64_t>(kinds.size()); ++kind) {
+    for (std::int64_t size = 64; size <= max_size; size <<= 6) {
+      f(kind, size);
+    }
+  }
+}
+
+inline void payload_args(benchmark::internal::Benchmark *b) {
+  b->ArgNames({"kind", "size"});
+  for_each_payload([b](std::int64_t kind, std::int64_t size) { b->Args({kind, size}); });
+}
+
+/// A `size`-byte logs file in the temporary directory, written on first use (file benchmarks)
+inline std::filesystem::path input_file(std::size_t size) {
+  auto const dir = std::filesystem::temp_directory_path() / "codec_bench";
+  auto const path = dir / utils::corpus::file_name(DataKind::logs, size);
+  if (!std::filesystem::exists(path) || std::filesystem::file_size(path) != size) {
+    utils::corpus::write(dir, DataKind::logs, size);
+  }
+  return path;
+}
+
+/// Peak resident set size (Linux only): reset the high-water mark, then read it in MiB
+inline void reset_peak_rss() {
+  std::ofstream clear_refs("/proc/self/clear_refs");
+  clear_refs << "5";
+}
+
+inline double peak_rss_mib() {
+  std::ifstream status("/proc/self/status");
+  for (std::string line; std::getline(status, line);) {
+    if (line.rfind("VmHWM:", 0) == 0) {
+      return std::stod(line.substr(6)) / 1024.0;  // in kB
+    }
+  }
+  return 0.0;
+}
+
+}  // namespace codec_bench
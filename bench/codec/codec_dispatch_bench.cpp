@@ -0,0 +1,143 @@
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "codec.hpp"
+#include "codec_data.hpp"
+
+/* Compile-time (codec.hpp) vs. virtual dispatch on 4 KiB blocks
+ *
+ * BM_TemplateBlocks: codec::compress_blocks<C>, the codec call inlined in the loop
+ * BM_VirtualBlocks:  the same loop through an abstract interface, one indirect call per block
+ * BM_VirtualCopyBlocks: the usual runtime-polymorphic API, returning a new buffer per block
+ *
+ * With real codecs the indirect call is noise against 4 KiB of compression
+ * (zstd, lz4: within a few percent either way). The passthrough codec shows
+ * the dispatch alone, but also the code generation: once inlined, GCC knows
+ * the copy is at most 4 KiB and may expand the memcpy inline (rep movsq),
+ * slower than the library call the virtual version makes. Compare assembly,
+ * not only timings, before concluding.
+ */
+namespace {
+
+using codec_bench::payload;
+using codec_bench::report;
+
+constexpr std::size_t block_size = 4096;
+
+class VirtualCodec {
+ public:
+  virtual ~VirtualCodec() = default;
+  virtual std::size_t compress_bound(std::size_t size) const = 0;
+  virtual codec::Result compress_into(codec::rospan_t src, codec::span_t dst) const = 0;
+  virtual utils::byte_buffer compress(codec::rospan_t src) const = 0;
+};
+
+template <codec::Codec C>
+class VirtualCodecOf final : public VirtualCodec {
+ public:
+  std::size_t compress_bound(std::size_t size) const override { return C::compress_bound(size); }
+  codec::Result compress_into(codec::rospan_t src, codec::span_t dst) const override {
+    return codec_.compress_into(src, dst);
+  }
+  utils::byte_buffer compress(codec::rospan_t src) const override {
+    utils::byte_buffer out{};
+    out.resize(C::compress_bound(src.size()));
+    out.resize(codec_.compress_into(src, {reinterpret_cast<std::byte *>(out.data()), out.size()}).value());
+    return out;
+  }
+
+ private:
+  C codec_{};
+};
+
+// Selected at run time, as a plugin registry would
+std::unique_ptr<VirtualCodec> make_virtual(std::int64_t index) {
+  switch (index) {
+    case 0: return std::make_unique<VirtualCodecOf<codec::zstd_codec>>();
+    case 1: return std::make_unique<VirtualCodecOf<codec::lz4_codec>>();
+    default: return std::make_unique<VirtualCodecOf<codec::passthrough_codec>>();
+  }
+}
+
+template <codec::Codec C>
+void BM_TemplateBlocks(benchmark::State &state) {
+  auto const &data = payload(state);
+  C const codec{};
+  utils::byte_buffer out{};
+  for (auto _ : state) {
+    out.clear();
+    codec::compress_blocks(codec, codec::as_bytes(data), block_size, out);
+    benchmark::DoNotOptimize(out.data());
+  }
+  report(state, data.size(), out.size());
+}
+
+// Same framing as compress_blocks, through the interface
+std::size_t virtual_blocks(VirtualCodec const &codec, codec::rospan_t src, utils::byte_buffer &out) {
+  out.resize(src.size() + (src.size() / block_size + 1) * (8 + codec.compress_bound(block_size)));
+  auto *p = reinterpret_cast<std::byte *>(out.data());
+  for (std::size_t pos = 0; pos < src.size(); pos += block_size) {
+    auto const block = src.subspan(pos, std::min(block_size, src.size() - pos));
+    auto const size = codec.compress_into(block, {p + 8, codec.compress_bound(block.size())}).value();
+    codec::detail::put_le32(p, static_cast<std::uint32_t>(size));
+    codec::detail::put_le32(p + 4, static_cast<std::uint32_t>(block.size()));
+    p += 8 + size;
+  }
+  out.resize(static_cast<std::size_t>(p - reinterpret_cast<std::byte *>(out.data())));
+  return out.size();
+}
+
+void BM_VirtualBlocks(benchmark::State &state) {
+  auto const &data = payload(state);
+  auto const codec = make_virtual(state.range(2));
+  utils::byte_buffer out{};
+  for (auto _ : state) {
+    out.clear();
+    virtual_blocks(*codec, codec::as_bytes(data), out);
+    benchmark::DoNotOptimize(out.data());
+  }
+  report(state, data.size(), out.size());
+}
+
+void BM_VirtualCopyBlocks(benchmark::State &state) {
+  auto const &data = payload(state);
+  auto const codec = make_virtual(state.range(2));
+  auto const src = codec::as_bytes(data);
+  std::vector<utils::byte_buffer> blocks{};
+  std::size_t output = 0;
+  for (auto _ : state) {
+    blocks.clear();
+    output = 0;
+    for (std::size_t pos = 0; pos < src.size(); pos += block_size) {
+      blocks.push_back(codec->compress(src.subspan(pos, std::min(block_size, src.size() - pos))));
+      output += blocks.back().size();
+    }
+    benchmark::DoNotOptimize(blocks.data());
+  }
+  report(state, data.size(), output);
+}
+
+// text and random payloads of 1 MiB: 256 blocks
+void dispatch_args(benchmark::internal::Benchmark *b) {
+  b->ArgNames({"kind", "size"});
+  b->Args({0, 1 << 20})->Args({2, 1 << 20});
+}
+
+void virtual_args(benchmark::internal::Benchmark *b) {
+  b->ArgNames({"kind", "size", "codec"});  // codec: 0 zstd, 1 lz4, 2 passthrough
+  for (std::int64_t index = 0; index < 3; ++index) {
+    b->Args({0, 1 << 20, index})->Args({2, 1 << 20, index});
+  }
+}
+
+}  // namespace
+
+BENCHMARK_TEMPLATE(BM_TemplateBlocks, codec::zstd_codec)->Apply(dispatch_args);
+BENCHMARK_TEMPLATE(BM_TemplateBlocks, codec::lz4_codec)->Apply(dispatch_args);
+BENCHMARK_TEMPLATE(BM_TemplateBlocks, codec::passthrough_codec)->Apply(dispatch_args);
+BENCHMARK(BM_VirtualBlocks)->Apply(virtual_args);
+BENCHMARK(BM_VirtualCopyBlocks)->Apply(virtual_args);
@@ -0,0 +1,164 @@
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <streambuf>
+
+#include "codec_data.hpp"
+#include "lz4_api.hpp"
+#include "zstdpp.hpp"
+
+namespace {
+
+using codec_bench::payload;
+using codec_bench::report;
+
+// Output stream that only counts bytes: the stream benchmarks measure the codec, not a sink
+class CountingBuf : public std::streambuf {
+ public:
+  std::size_t count() const noexcept { return count_; }
+
+ protected:
+  std::streamsize xsputn(char const *, std::streamsize n) override {
+    count_ += static_cast<std::size_t>(n);
+    return n;
+  }
+  int_type overflow(int_type c) override {
+    if (!traits_type::eq_int_type(c, traits_type::eof())) {
+      ++count_;
+    }
+    return traits_type::not_eof(c);
+  }
+
+ private:
+  std::size_t count_{0};
+};
+
+// High levels are too slow for the largest payloads
+constexpr std::int64_t slow_level = 19;
+constexpr std::int64_t slow_level_max_size = std::int64_t{16} << 20;
+
+void zstd_level_args(benchmark::internal::Benchmark *b) {
+  b->ArgNames({"kind", "size", "level"});
+  codec_bench::for_each_payload([b](std::int64_t kind, std::int64_t size) {
+    for (std::int64_t level : {1, 3, 9, 19}) {
+      if (level < slow_level || size <= slow_level_max_size) {
+        b->Args({kind, size, level});
+      }
+    }
+  });
+}
+
+void zstd_thread_args(benchmark::internal::Benchmark *b) {
+  b->ArgNames({"kind", "size", "level", "threads"});
+  codec_bench::for_each_payload([b](std::int64_t kind, std::int64_t size) {
+    for (std::int64_t level : {1, 3, 9}) {
+      for (std::int64_t threads : {1, 2, 4, 8}) {
+        b->Args({kind, size, level, threads});
+      }
+    }
+  });
+}
+
+void lz4_level_args(benchmark::internal::Benchmark *b) {
+  // -8: accelerated, 1: default fast mode, 9: LZ4HC
+  b->ArgNames({"kind", "size", "level"});
+  codec_bench::for_each_payload([b](std::int64_t kind, std::int64_t size) {
+    for (std::int64_t level : {-8, 1, 9}) {
+      b->Args({kind, size, level});
+    }
+  });
+}
+
+}  // namespace
+
+/* zstd */
+
+static void BM_ZstdCompress(benchmark::State &state) {
+  auto const &input = payload(state);
+  auto const level = static_cast<zstdpp::compress_level_t>(state.range(2));
+  zstdpp::buffer_t output{};
+  output.resize(zstdpp::compress_bound(input.size()));
+
+  std::size_t size = 0;
+  for (auto _ : state) {
+    size = zstdpp::compress_into(zstdpp::utils::as_bytes(input), zstdpp::utils::as_writable_bytes(output), level)
+               .value();
+    benchmark::DoNotOptimize(output.data());
+  }
+  report(state, input.size(), size);
+}
+BENCHMARK(BM_ZstdCompress)->Apply(zstd_level_args)->UseRealTime();
+
+static void BM_ZstdDecompress(benchmark::State &state) {
+  auto const &input = payload(state);
+  auto const level = static_cast<zstdpp::compress_level_t>(state.range(2));
+  zstdpp::buffer_t compressed{};
+  compressed.resize(zstdpp::compress_bound(input.size()));
+  compressed.resize(
+      zstdpp::compress_into(zstdpp::utils::as_bytes(input), zstdpp::utils::as_writable_bytes(compressed), level)
+          .value());
+  zstdpp::buffer_t output{};
+  output.resize(input.size());
+
+  for (auto _ : state) {
+    zstdpp::decompress_into(zstdpp::utils::as_bytes(compressed), zstdpp::utils::as_writable_bytes(output)).value();
+    benchmark::DoNotOptimize(output.data());
+  }
+  report(state, input.size(), compressed.size());
+}
+BENCHMARK(BM_ZstdDecompress)->Apply(zstd_level_args)->UseRealTime();
+
+// Streaming API with zstd worker threads (real time: the work is not on the benchmark thread)
+static void BM_ZstdStreamCompress(benchmark::State &state) {
+  auto const &input = payload(state);
+  auto const level = static_cast<zstdpp::compress_level_t>(state.range(2));
+  auto const threads = static_cast<zstdpp::threads_number_t>(state.range(3));
+
+  std::size_t size = 0;
+  for (auto _ : state) {
+    CountingBuf sink{};
+    std::ostream out(&sink);
+    zstdpp::stream::Context ctx(level, threads);
+    zstdpp::stream::compress(ctx, zstdpp::utils::as_bytes(input), out);
+    size = sink.count();
+  }
+  report(state, input.size(), size);
+}
+BENCHMARK(BM_ZstdStreamCompress)->Apply(zstd_thread_args)->UseRealTime();
+
+/* lz4 */
+
+static void BM_Lz4Compress(benchmark::State &state) {
+  auto const &input = payload(state);
+  auto const level = static_cast<lz4::compress_level_t>(state.range(2));
+  lz4::buffer_t output{};
+  output.resize(lz4::compress_bound(input.size()));
+
+  std::size_t size = 0;
+  for (auto _ : state) {
+    size = lz4::compress_into(lz4::utils::as_bytes(input), lz4::utils::as_writable_bytes(output), level).value();
+    benchmark::DoNotOptimize(output.data());
+  }
+  report(state, input.size(), size);
+}
+BENCHMARK(BM_Lz4Compress)->Apply(lz4_level_args)->UseRealTime();
+
+static void BM_Lz4Decompress(benchmark::State &state) {
+  auto const &input = payload(state);
+  auto const level = static_cast<lz4::compress_level_t>(state.range(2));
+  lz4::buffer_t compressed{};
+  lz4::compress(input, compressed, level);
+  lz4::buffer_t output{};
+  output.resize(input.size());
+
+  for (auto _ : state) {
+    lz4::decompress_into(lz4::utils::as_bytes(compressed), lz4::utils::as_writable_bytes(output)).value();
+    benchmark::DoNotOptimize(output.data());
+  }
+  report(state, input.size(), compressed.size());
+}
+BENCHMARK(BM_Lz4Decompress)->Apply(lz4_level_args)->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,87 @@
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+
+#include "lz4_api.hpp"
+
+namespace {
+
+// Mixed corpus: text, JSON, random bytes and zeros (256 KiB each)
+lz4::buffer_t const& mixed_corpus() {
+  static lz4::buffer_t const corpus = [] {
+    constexpr std::size_t part = 256 << 10;
+    std::mt19937 rng{42};
+    std::string text{};
+    while (text.size() < part) {
+      text += "word" + std::to_string(rng() % 1024) + (rng() % 8 ? " " : ".\n");
+    }
+    std::string json{};
+    while (json.size() < part) {
+      json += "{\"id\":" + std::to_string(rng()) + ",\"service\":\"svc-" +
+              std::to_string(rng() % 16) + "\",\"latency_ms\":" + std::to_string(rng() % 500) +
+              "}\n";
+    }
+
+    lz4::buffer_t out{};
+    out.reserve(4 * part);
+    out.insert(out.end(), text.begin(), text.begin() + part);
+    out.insert(out.end(), json.begin(), json.begin() + part);
+    for (std::size_t i = 0; i < part; ++i) {
+      out.push_back(static_cast<lz4::byte_t>(rng()));
+    }
+    out.insert(out.end(), part, 0);
+    return out;
+  }();
+  return corpus;
+}
+
+}  // namespace
+
+// Level matrix: negative = acceleration, 1 = default fast mode, 3..12 = LZ4HC
+static void BM_Lz4CompressLevel(benchmark::State& state) {
+  auto const level = static_cast<lz4::compress_level_t>(state.range(0));
+  auto const& corpus = mixed_corpus();
+  lz4::buffer_t compressed{};
+  compressed.resize(lz4::compress_bound(corpus.size()));
+
+  std::size_t out_size = 0;
+  for (auto _ : state) {
+    out_size = lz4::compress_into(lz4::utils::as_bytes(corpus),
+                                  lz4::utils::as_writable_bytes(compressed), level)
+                   .value();
+    benchmark::DoNotOptimize(compressed.data());
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * corpus.size()));
+  state.counters["ratio"] = static_cast<double>(corpus.size()) / static_cast<double>(out_size);
+}
+BENCHMARK(BM_Lz4CompressLevel)
+    ->ArgName("level")
+    ->Arg(-10)->Arg(-1)->Arg(1)->Arg(3)->Arg(6)->Arg(9)->Arg(12)
+    ->Unit(benchmark::kMillisecond);
+
+// Decoding speed does not depend on the level (only on the output)
+static void BM_Lz4DecompressLevel(benchmark::State& state) {
+  auto const level = static_cast<lz4::compress_level_t>(state.range(0));
+  auto const& corpus = mixed_corpus();
+  lz4::buffer_t compressed{};
+  lz4::compress(corpus, compressed, level);
+  lz4::buffer_t decompressed{};
+  decompressed.resize(corpus.size());
+
+  for (auto _ : state) {
+    lz4::decompress_into(lz4::utils::as_bytes(compressed),
+                         lz4::utils::as_writable_bytes(decompressed))
+        .value();
+    benchmark::DoNotOptimize(decompressed.data());
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * corpus.size()));
+}
+BENCHMARK(BM_Lz4DecompressLevel)
+    ->ArgName("level")
+    ->Arg(-10)->Arg(1)->Arg(12)
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,82 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "lz4_message.hpp"
+
+namespace {
+
+// ~100 byte messages of a message bus: same keys, changing values
+std::vector<lz4::buffer_t> const& bus_messages() {
+  static std::vector<lz4::buffer_t> const messages = [] {
+    std::mt19937 rng{42};
+    std::vector<lz4::buffer_t> out{};
+    for (int i = 0; i < 10000; ++i) {
+      std::string msg = "{\"seq\":" + std::to_string(i) + ",\"topic\":\"orders." +
+                        std::to_string(rng() % 8) + "\",\"status\":\"" +
+                        (rng() % 3 ? "accepted" : "rejected") + "\",\"qty\":" +
+                        std::to_string(rng() % 100) + ",\"px\":" + std::to_string(rng() % 10000) +
+                        "}";
+      out.emplace_back(msg.begin(), msg.end());
+    }
+    return out;
+  }();
+  return messages;
+}
+
+template <typename Compress>
+void run_messages(benchmark::State& state, Compress&& compress) {
+  auto const& messages = bus_messages();
+  std::size_t in_bytes = 0, wire_bytes = 0;
+  for (auto _ : state) {
+    for (auto const& msg : messages) {
+      wire_bytes += compress(msg);
+      in_bytes += msg.size();
+    }
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * messages.size()));
+  state.counters["wire_bytes/msg"] = static_cast<double>(wire_bytes) /
+                                     static_cast<double>(state.iterations() * messages.size());
+  state.counters["ratio"] = static_cast<double>(in_bytes) / static_cast<double>(wire_bytes);
+}
+
+}  // namespace
+
+// Current mode: every message is an independent block
+static void BM_MessagesIndependent(benchmark::State& state) {
+  lz4::buffer_t block{};
+  run_messages(state, [&](lz4::buffer_t const& msg) { return lz4::compress(msg, block); });
+}
+BENCHMARK(BM_MessagesIndependent)->Unit(benchmark::kMillisecond);
+
+// Streaming mode: every message is compressed against the previous ones
+static void BM_MessagesStream(benchmark::State& state) {
+  lz4::MessageStream stream(1024);
+  lz4::buffer_t block(lz4::compress_bound(1024));
+  run_messages(state, [&](lz4::buffer_t const& msg) {
+    return stream.compress_into(lz4::utils::as_bytes(msg), lz4::utils::as_writable_bytes(block))
+        .value();
+  });
+}
+BENCHMARK(BM_MessagesStream)->Unit(benchmark::kMillisecond);
+
+// Consumer side of the streaming mode
+static void BM_MessagesStreamDecode(benchmark::State& state) {
+  auto const& messages = bus_messages();
+  lz4::MessageStream stream(1024);
+  std::vector<lz4::buffer_t> blocks{};
+  for (auto const& msg : messages) {
+    blocks.push_back(stream.compress(msg));
+  }
+  for (auto _ : state) {
+    lz4::MessageStreamDecoder decoder(1024);
+    for (auto const& block : blocks) {
+      benchmark::DoNotOptimize(decoder.decompress_view(lz4::utils::as_bytes(block)).data());
+    }
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * blocks.size()));
+}
+BENCHMARK(BM_MessagesStreamDecode)->Unit(benchmark::kMillisecond);
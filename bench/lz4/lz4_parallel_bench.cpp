@@ -0,0 +1,62 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <thread>
+
+#include "lz4_parallel.hpp"
+
+namespace {
+
+// 64 MiB of log-like text
+lz4::buffer_t const& large_input() {
+  static lz4::buffer_t const input = [] {
+    std::mt19937 rng{42};
+    std::string text{};
+    while (text.size() < (std::size_t{64} << 20)) {
+      text += "2024-01-01T00:00:" + std::to_string(rng() % 60) + " svc-" + std::to_string(rng() % 16) +
+              " request id=" + std::to_string(rng()) + " latency_ms=" + std::to_string(rng() % 500) + "\n";
+    }
+    return lz4::buffer_t(text.begin(), text.end());
+  }();
+  return input;
+}
+
+void thread_args(benchmark::internal::Benchmark* bench) {
+  auto const max_threads = static_cast<int64_t>(std::thread::hardware_concurrency());
+  for (int64_t threads = 1; threads < max_threads; threads *= 2) {
+    bench->Arg(threads);
+  }
+  bench->Arg(std::max<int64_t>(max_threads, 1));
+}
+
+}  // namespace
+
+// Throughput scaling from 1 to N worker threads (4 MiB chunks)
+static void BM_ParallelCompress(benchmark::State& state) {
+  auto const& input = large_input();
+  utils::ThreadPool pool{static_cast<std::size_t>(state.range(0))};
+  std::size_t out_size = 0;
+  for (auto _ : state) {
+    auto const compressed = lz4::parallel::compress(input, {}, pool);
+    out_size = compressed.size();
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * input.size()));
+  state.counters["ratio"] = static_cast<double>(input.size()) / static_cast<double>(out_size);
+}
+BENCHMARK(BM_ParallelCompress)->ArgName("threads")->Apply(thread_args)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+static void BM_ParallelDecompress(benchmark::State& state) {
+  auto const& input = large_input();
+  utils::ThreadPool pool{static_cast<std::size_t>(state.range(0))};
+  auto const compressed = lz4::parallel::compress(input, {}, pool);
+  for (auto _ : state) {
+    auto const decompressed = lz4::parallel::decompress(compressed, pool);
+    benchmark::DoNotOptimize(decompressed.data());
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * input.size()));
+}
+BENCHMARK(BM_ParallelDecompress)->ArgName("threads")->Apply(thread_args)->Unit(benchmark::kMillisecond)->UseRealTime();
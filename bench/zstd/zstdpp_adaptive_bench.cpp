@@ -0,0 +1,108 @@
+#include <benchmark/benchmark.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <thread>
+
+#include "corpus.hpp"
+#include "zstdpp_adaptive.hpp"
+
+/* Fixed vs. adaptive level into a destination of limited bandwidth
+ *
+ * RateLimitedBuf stands in for a throttled volume or a network link: it
+ * drops the data, but not faster than `rate` bytes per second (0: no
+ * limit). With a slow destination the adaptive level climbs (better ratio
+ * for free), with a fast one it stays low (throughput).
+ */
+namespace {
+
+constexpr std::size_t input_size = std::size_t{128} << 20;
+
+std::string const &input() {
+  static std::string const text = [] {
+    auto const data = utils::corpus::load(utils::corpus::Kind::logs, input_size);
+    return std::string(data.begin(), data.end());
+  }();
+  return text;
+}
+
+class RateLimitedBuf : public std::streambuf {
+ public:
+  explicit RateLimitedBuf(double rate) : rate_(rate) {}
+
+  std::uint64_t written() const { return written_; }
+
+ protected:
+  std::streamsize xsputn(char const *, std::streamsize n) override {
+    written_ += static_cast<std::uint64_t>(n);
+    if (rate_ > 0) {
+      std::this_thread::sleep_until(start_ + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                                 std::chrono::duration<double>(static_cast<double>(written_) / rate_)));
+    }
+    return n;
+  }
+  int_type overflow(int_type c) override {
+    if (!traits_type::eq_int_type(c, traits_type::eof())) {
+      char const ch = traits_type::to_char_type(c);
+      xsputn(&ch, 1);
+    }
+    return traits_type::not_eof(c);
+  }
+
+ private:
+  double const rate_;
+  std::chrono::steady_clock::time_point const start_ = std::chrono::steady_clock::now();
+  std::uint64_t written_{0};
+};
+
+constexpr double mib = 1 << 20;
+
+void rate_args(benchmark::internal::Benchmark *b, std::initializer_list<std::int64_t> levels) {
+  b->ArgNames({"level", "rate_MiBps"});
+  for (auto level : levels) {
+    for (std::int64_t rate : {8, 32, 128, 0}) {
+      b->Args({level, rate});
+    }
+  }
+  b->Unit(benchmark::kMillisecond)->UseRealTime()->Iterations(1);
+}
+
+void report(benchmark::State &state, std::uint64_t compressed) {
+  state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * input_size));
+  state.counters["ratio"] = static_cast<double>(input_size) / static_cast<double>(compressed);
+}
+
+}  // namespace
+
+static void BM_FixedLevelCompress(benchmark::State &state) {
+  std::uint64_t compressed = 0;
+  for (auto _ : state) {
+    RateLimitedBuf sink(static_cast<double>(state.range(1)) * mib);
+    std::ostream out(&sink);
+    std::istringstream in(input());
+    zstdpp::stream::compress(in, out, 1, static_cast<zstdpp::compress_level_t>(state.range(0)));
+    compressed = sink.written();
+  }
+  report(state, compressed);
+}
+BENCHMARK(BM_FixedLevelCompress)->Apply([](auto *b) { rate_args(b, {1, 3, 9}); });
+
+// level: the start level, between 1 and 19
+static void BM_AdaptiveCompress(benchmark::State &state) {
+  zstdpp::adaptive::Stats stats{};
+  for (auto _ : state) {
+    RateLimitedBuf sink(static_cast<double>(state.range(1)) * mib);
+    std::ostream out(&sink);
+    std::istringstream in(input());
+    stats = zstdpp::adaptive::compress(in, out, static_cast<zstdpp::compress_level_t>(state.range(0)), 1,
+                                       {.min_level = 1, .max_level = 19, .window = std::size_t{1} << 20});
+  }
+  report(state, stats.bytes_out);
+  state.counters["final_level"] = stats.final_level();
+  state.counters["level_changes"] = static_cast<double>(stats.levels.size() - 1);
+}
+BENCHMARK(BM_AdaptiveCompress)->Apply([](auto *b) { rate_args(b, {3}); });
@@ -0,0 +1,68 @@
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <string>
+
+#include "zstdpp.hpp"
+
+namespace {
+
+// Small, request-like payload (a few hundred bytes of text)
+zstdpp::buffer_t make_payload(std::size_t size) {
+  const std::string text =
+      "this is a string that I want to compress into a smaller\n"
+      "string. Just to make sure there is enough data in the\n"
+      "compression buffer, I'm going to fill this string with a\n"
+      "decent amount of content. Let's hope this works.\n";
+  zstdpp::buffer_t payload{};
+  payload.reserve(size);
+  while (payload.size() < size) {
+    payload.push_back(static_cast<zstdpp::byte_t>(text[payload.size() % text.size()]));
+  }
+  return payload;
+}
+
+}  // namespace
+
+// One-shot API: a context is created and freed inside every call
+static void BM_CompressOneShot(benchmark::State& state) {
+  auto const payload = make_payload(static_cast<std::size_t>(state.range(0)));
+  for (auto _ : state) {
+    auto compressed = zstdpp::compress(payload);
+    benchmark::DoNotOptimize(compressed.data());
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+}
+BENCHMARK(BM_CompressOneShot)->Arg(256)->Arg(2048)->Arg(64 << 10);
+
+// Pooled API: warm contexts are reused, zstd allocates nothing in steady state
+static void BM_CompressPooled(benchmark::State& state) {
+  auto const payload = make_payload(static_cast<std::size_t>(state.range(0)));
+  zstdpp::ContextPool pool{};
+  benchmark::DoNotOptimize(zstdpp::compress(pool, payload));  // warm up
+
+  auto const before = pool.stats().allocations;
+  for (auto _ : state) {
+    auto compressed = zstdpp::compress(pool, payload);
+    benchmark::DoNotOptimize(compressed.data());
+  }
+  auto const allocations = pool.stats().allocations - before;
+
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+  state.counters["allocs/call"] = benchmark::Counter(
+      static_cast<double>(allocations), benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_CompressPooled)->Arg(256)->Arg(2048)->Arg(64 << 10);
+
+static void BM_RoundTripPooledThreads(benchmark::State& state) {
+  static zstdpp::ContextPool pool{};
+  auto const payload = make_payload(2048);
+  for (auto _ : state) {
+    auto decompressed = zstdpp::decompress(pool, zstdpp::compress(pool, payload));
+    benchmark::DoNotOptimize(decompressed.data());
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+BENCHMARK(BM_RoundTripPooledThreads)->ThreadRange(1, 8)->UseRealTime();
+
+BENCHMARK_MAIN();
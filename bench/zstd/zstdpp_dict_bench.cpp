@@ -0,0 +1,72 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "zstdpp_dict.hpp"
+
+namespace {
+
+// JSON records of 200 to 2000 bytes
+std::vector<std::string> const& small_records() {
+  static std::vector<std::string> const records = [] {
+    std::mt19937 rng{42};
+    std::vector<std::string> out{};
+    for (int i = 0; i < 10000; ++i) {
+      std::string record = "{\"id\":" + std::to_string(rng()) + ",\"service\":\"svc-" +
+                           std::to_string(rng() % 16) + "\",\"level\":\"" +
+                           (rng() % 4 ? "info" : "error") + "\",\"events\":[";
+      auto const nb_events = 2 + rng() % 30;
+      for (std::uint32_t e = 0; e < nb_events; ++e) {
+        record += "{\"ts\":" + std::to_string(1700000000 + rng() % 100000) + ",\"latency_ms\":" +
+                  std::to_string(rng() % 500) + ",\"path\":\"/api/v1/items/" +
+                  std::to_string(rng() % 1000) + "\"},";
+      }
+      record += "{}]}";
+      out.push_back(std::move(record));
+    }
+    return out;
+  }();
+  return records;
+}
+
+}  // namespace
+
+static void BM_SmallRecordsNoDict(benchmark::State& state) {
+  auto const& records = small_records();
+  zstdpp::ContextPool pool{};
+  std::size_t in_bytes = 0, out_bytes = 0;
+  for (auto _ : state) {
+    for (auto const& record : records) {
+      auto const compressed = zstdpp::compress(pool, zstdpp::utils::to_bytes(record), 3);
+      in_bytes += record.size();
+      out_bytes += compressed.size();
+    }
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * records.size()));
+  state.counters["ratio"] = static_cast<double>(in_bytes) / static_cast<double>(out_bytes);
+}
+BENCHMARK(BM_SmallRecordsNoDict)->Unit(benchmark::kMillisecond);
+
+static void BM_SmallRecordsDict(benchmark::State& state) {
+  auto const& records = small_records();
+  zstdpp::DictionaryCache cache{};
+  auto const dict = zstdpp::Dictionary::train(
+      std::vector<std::string>(records.begin(), records.begin() + 2000));
+  cache.add(dict);
+
+  std::size_t in_bytes = 0, out_bytes = 0;
+  for (auto _ : state) {
+    for (auto const& record : records) {
+      auto const compressed =
+          zstdpp::compress_using_dict(cache, dict.id(), zstdpp::utils::as_bytes(record), 3);
+      in_bytes += record.size();
+      out_bytes += compressed.size();
+    }
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * records.size()));
+  state.counters["ratio"] = static_cast<double>(in_bytes) / static_cast<double>(out_bytes);
+}
+BENCHMARK(BM_SmallRecordsDict)->Unit(benchmark::kMillisecond);
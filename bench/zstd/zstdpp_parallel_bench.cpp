@@ -0,0 +1,89 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <sstream>
+#include <streambuf>
+#include <string>
+
+#include "corpus.hpp"
+#include "zstdpp_parallel.hpp"
+
+namespace {
+
+constexpr std::size_t input_size = std::size_t{256} << 20;
+
+std::string const &input() {
+  static std::string const text = [] {
+    auto const data = utils::corpus::load(utils::corpus::Kind::logs, input_size);
+    return std::string(data.begin(), data.end());
+  }();
+  return text;
+}
+
+/// Counts and drops what is written: measures decompression, not the output
+class NullBuf : public std::streambuf {
+ protected:
+  std::streamsize xsputn(char const *, std::streamsize n) override { return n; }
+  int_type overflow(int_type c) override { return traits_type::not_eof(c); }
+};
+
+void decompress_args(benchmark::internal::Benchmark *b) {
+  b->ArgName("threads")->Arg(0)->DenseRange(1, 8)->Unit(benchmark::kMillisecond)->UseRealTime();
+}
+
+}  // namespace
+
+// 256 MiB of logs written as 4 MiB frames, decompressed by stream::decompress (threads:0) or with N workers
+static void BM_ParallelDecompress(benchmark::State &state) {
+  auto const threads = static_cast<std::size_t>(state.range(0));
+  utils::ThreadPool pool{std::max<std::size_t>(threads, 1)};
+  std::stringstream in(input()), compressed;
+  zstdpp::parallel::compress(in, compressed, {}, pool);
+  auto const frames = compressed.str();
+
+  NullBuf null{};
+  std::ostream out(&null);
+  for (auto _ : state) {
+    std::istringstream frames_in(frames);
+    if (threads == 0) {
+      zstdpp::stream::decompress(frames_in, out);
+    } else {
+      zstdpp::parallel::decompress(frames_in, out, pool);
+    }
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(input_size));
+}
+BENCHMARK(BM_ParallelDecompress)->Apply(decompress_args);
+
+// The same data as a single frame (stream::compress): the parallel reader falls back to one thread
+static void BM_ParallelDecompressSingleFrame(benchmark::State &state) {
+  auto const threads = static_cast<std::size_t>(state.range(0));
+  utils::ThreadPool pool{std::max<std::size_t>(threads, 1)};
+  std::stringstream in(input()), compressed;
+  zstdpp::stream::compress(in, compressed);
+  auto const frame = compressed.str();
+
+  NullBuf null{};
+  std::ostream out(&null);
+  for (auto _ : state) {
+    std::istringstream frame_in(frame);
+    zstdpp::parallel::decompress(frame_in, out, pool);
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(input_size));
+}
+BENCHMARK(BM_ParallelDecompressSingleFrame)->ArgName("threads")->Arg(1)->Arg(8)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+static void BM_ParallelCompress(benchmark::State &state) {
+  auto const threads = static_cast<std::size_t>(state.range(0));
+  utils::ThreadPool pool{threads};
+  NullBuf null{};
+  std::ostream out(&null);
+  for (auto _ : state) {
+    std::istringstream in(input());
+    zstdpp::parallel::compress(in, out, {}, pool);
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(input_size));
+}
+BENCHMARK(BM_ParallelCompress)->ArgName("threads")->DenseRange(1, 8)->Unit(benchmark::kMillisecond)->UseRealTime();
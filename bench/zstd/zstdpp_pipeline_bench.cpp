@@ -0,0 +1,79 @@
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include "zstdpp_pipeline.hpp"
+
+#if defined(__unix__)
+#include <fcntl.h>  // posix_fadvise
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr std::size_t input_size = std::size_t{256} << 20;
+
+// Written once: mildly compressible log-like text
+std::filesystem::path const &input_file() {
+  static std::filesystem::path const path = [] {
+    auto file = std::filesystem::temp_directory_path() / "zstdpp_pipeline_bench.txt";
+    std::ofstream out(file, std::ios::binary);
+    std::string line;
+    for (std::size_t written = 0, i = 0; written < input_size; written += line.size(), ++i) {
+      line = "2024-01-01T00:00:" + std::to_string(i % 60) + " request id=" + std::to_string(i * 7919 % 100003) +
+             " status=" + std::to_string(200 + i % 5) + " bytes=" + std::to_string(i % 65536) + "\n";
+      out << line;
+    }
+    return file;
+  }();
+  return path;
+}
+
+// Cold cache: the input has to come from the disk again in every iteration
+void drop_page_cache(std::filesystem::path const &path) {
+#if defined(__unix__)
+  int const fd = ::open(path.c_str(), O_RDONLY);
+  if (fd >= 0) {
+    ::fdatasync(fd);
+    ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    ::close(fd);
+  }
+#else
+  (void)path;
+#endif
+}
+
+template <typename Compress>
+void run_cold(benchmark::State &state, Compress &&compress) {
+  auto const &in_path = input_file();
+  auto const out_path = std::filesystem::temp_directory_path() / "zstdpp_pipeline_bench.zst";
+  for (auto _ : state) {
+    state.PauseTiming();
+    drop_page_cache(in_path);
+    state.ResumeTiming();
+
+    std::ifstream in(in_path, std::ios::binary);
+    std::ofstream out(out_path, std::ios::binary | std::ios::trunc);
+    compress(in, out);
+  }
+  std::filesystem::remove(out_path);
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(input_size));
+}
+
+}  // namespace
+
+// Current loop: read, compress and write one after the other
+static void BM_StreamCompressColdCache(benchmark::State &state) {
+  run_cold(state, [](std::istream &in, std::ostream &out) { zstdpp::stream::compress(in, out); });
+}
+BENCHMARK(BM_StreamCompressColdCache)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// Pipeline: reader and writer threads overlap the I/O with the compression
+static void BM_PipelineCompressColdCache(benchmark::State &state) {
+  run_cold(state, [](std::istream &in, std::ostream &out) { zstdpp::pipeline::compress(in, out); });
+}
+BENCHMARK(BM_PipelineCompressColdCache)->Unit(benchmark::kMillisecond)->UseRealTime();
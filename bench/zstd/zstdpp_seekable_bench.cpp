@@ -0,0 +1,60 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <map>
+#include <sstream>
+#include <string>
+
+#include "zstdpp_seekable.hpp"
+
+namespace {
+
+// Compressed inputs shared by the benchmarks, by decompressed size
+std::string const& make_input(std::size_t size, bool seekable) {
+  static std::map<std::pair<std::size_t, bool>, std::string> cache{};
+  auto& compressed = cache[{size, seekable}];
+  if (compressed.empty()) {
+    std::string plain{};
+    plain.reserve(size);
+    for (int i = 0; plain.size() < size; ++i) {
+      plain += "line " + std::to_string(i) + ": GET /index.html 200\n";
+    }
+    std::stringstream in(plain), out{};
+    if (seekable) {
+      zstdpp::seekable::compress(in, out);
+    } else {
+      zstdpp::stream::compress(in, out);
+    }
+    compressed = out.str();
+  }
+  return compressed;
+}
+
+}  // namespace
+
+// Open + read the last 1 MiB through the seek table: only the covering frames are decompressed
+static void BM_SeekableReadTail(benchmark::State& state) {
+  auto const size = static_cast<std::size_t>(state.range(0)) << 20;
+  std::stringstream in(make_input(size, true));
+
+  zstdpp::buffer_t range{};
+  range.resize(1 << 20);
+  for (auto _ : state) {
+    zstdpp::seekable::Reader reader(in);
+    benchmark::DoNotOptimize(reader.read_at(reader.size() - range.size(), zstdpp::utils::as_writable_bytes(range)));
+    benchmark::ClobberMemory();
+  }
+}
+BENCHMARK(BM_SeekableReadTail)->Arg(16)->Arg(64)->Arg(256)->Unit(benchmark::kMicrosecond);
+
+// Same range from a single-frame stream: everything before it has to be decompressed
+static void BM_StreamReadTail(benchmark::State& state) {
+  auto const size = static_cast<std::size_t>(state.range(0)) << 20;
+  auto const& compressed = make_input(size, false);
+  for (auto _ : state) {
+    std::stringstream in(compressed), out{};
+    zstdpp::stream::decompress(in, out);
+    benchmark::DoNotOptimize(out.str().substr(size - (1 << 20)));
+  }
+}
+BENCHMARK(BM_StreamReadTail)->Arg(16)->Arg(64)->Arg(256)->Unit(benchmark::kMicrosecond);
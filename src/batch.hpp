@@ -0,0 +1,172 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <future>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#include "byte_buffer.hpp"
+#include "thread_pool.hpp"
+
+namespace utils {
+
+/* Records stored back to back in one arena
+ *
+ * Record i is arena[offsets[i], offsets[i + 1]): one buffer for the whole
+ * batch instead of one vector per record, and no allocation at all once a
+ * Batch is reused (clear() keeps the capacity). The batch codecs
+ * (zstdpp::compress_batch, lz4::compress_batch and their inverses) read a
+ * list of spans and write a Batch.
+ *
+ *   utils::Batch packed{};
+ *   zstdpp::compress_batch(records, packed);   // records: std::span<std::span<std::byte const>>
+ *   auto const second = packed[1];
+ */
+struct Batch {
+  byte_buffer arena{};
+  std::vector<std::size_t> offsets{0};  ///< size() + 1 entries
+
+  std::size_t size() const noexcept { return offsets.size() - 1; }
+  bool empty() const noexcept { return size() == 0; }
+  std::size_t record_size(std::size_t i) const noexcept { return offsets[i + 1] - offsets[i]; }
+
+  std::span<std::byte const> operator[](std::size_t i) const noexcept {
+    return {reinterpret_cast<std::byte const *>(arena.data()) + offsets[i], record_size(i)};
+  }
+
+  /// Views of every record, e.g. to compress or decompress the batch
+  std::vector<std::span<std::byte const>> records() const {
+    std::vector<std::span<std::byte const>> views{};
+    views.reserve(size());
+    for (std::size_t i = 0; i < size(); ++i) {
+      views.push_back((*this)[i]);
+    }
+    return views;
+  }
+
+  std::vector<std::size_t> sizes() const {
+    std::vector<std::size_t> sizes(size());
+    for (std::size_t i = 0; i < size(); ++i) {
+      sizes[i] = record_size(i);
+    }
+    return sizes;
+  }
+
+  void push_back(std::span<std::byte const> record) {
+    auto const offset = arena.size();
+    arena.resize(offset + record.size());
+    if (!record.empty()) {
+      std::memcpy(arena.data() + offset, record.data(), record.size());
+    }
+    offsets.push_back(arena.size());
+  }
+
+  void clear() noexcept {
+    arena.clear();
+    offsets.resize(1);
+    offsets[0] = 0;
+  }
+};
+
+namespace batch {
+
+/// Sub-batches smaller than this are not worth a task
+inline constexpr std::size_t default_min_records = 64;
+
+/* Fills `out` with `count` records produced by a codec:
+ *
+ * - bound(i): the largest output of record i, called once per record;
+ * - encode(first, last, region, sizes): writes records [first, last) back to
+ *   back at the beginning of `region` (which holds their bounds), replaces
+ *   bound(i), found in sizes[i - first], with the size of record i, and
+ *   returns the bytes written.
+ *
+ * The arena is sized once for all the bounds; a total larger than SIZE_MAX
+ * throws std::runtime_error. With a pool, contiguous
+ * sub-batches of at least `min_records` records (one per worker at most) run
+ * concurrently on their own region, which are then moved together; encode
+ * is called once per sub-batch, so it can set up a codec context once for
+ * all its records. Exceptions are rethrown once every sub-batch is done, and
+ * `out` is cleared.
+ */
+namespace detail {
+
+inline std::size_t checked_add(std::size_t total, std::size_t size) {
+  if (size > std::numeric_limits<std::size_t>::max() - total) {
+    throw std::runtime_error("utils::batch: output size overflow");
+  }
+  return total + size;
+}
+
+}  // namespace detail
+
+template <typename Bound, typename Encode>
+void transform(std::size_t count, Batch &out, Bound &&bound, Encode &&encode, ThreadPool *pool = nullptr,
+               std::size_t min_records = default_min_records) {
+  out.clear();
+  out.offsets.resize(count + 1);
+  auto const parts = pool == nullptr ? std::size_t{1}
+                                     : std::clamp<std::size_t>(count / std::max<std::size_t>(min_records, 1), 1,
+                                                               std::max<std::size_t>(pool->size(), 1));
+  try {
+    if (parts == 1) {
+      std::size_t capacity = 0;
+      for (std::size_t i = 0; i < count; ++i) {
+        out.offsets[i + 1] = bound(i);
+        capacity = detail::checked_add(capacity, out.offsets[i + 1]);
+      }
+      out.arena.resize(capacity);
+      auto const region = std::span<std::byte>(reinterpret_cast<std::byte *>(out.arena.data()), capacity);
+      out.arena.resize(encode(std::size_t{0}, count, region, out.offsets.data() + 1));
+    } else {
+      std::vector<std::size_t> first(parts + 1);
+      std::vector<std::size_t> region(parts + 1, 0);
+      for (std::size_t k = 0; k <= parts; ++k) {
+        first[k] = k * count / parts;
+      }
+      for (std::size_t k = 0; k < parts; ++k) {
+        region[k + 1] = region[k];
+        for (auto i = first[k]; i < first[k + 1]; ++i) {
+          out.offsets[i + 1] = bound(i);
+          region[k + 1] = detail::checked_add(region[k + 1], out.offsets[i + 1]);
+        }
+      }
+      out.arena.resize(region[parts]);
+      auto *const arena = reinterpret_cast<std::byte *>(out.arena.data());
+
+      std::vector<std::future<std::size_t>> pending{};
+      pending.reserve(parts);
+      for (std::size_t k = 0; k < parts; ++k) {
+        pending.push_back(pool->submit([&, k] {
+          return encode(first[k], first[k + 1], std::span<std::byte>(arena + region[k], region[k + 1] - region[k]),
+                        out.offsets.data() + first[k] + 1);
+        }));
+      }
+      for (auto const &task : pending) {
+        task.wait();
+      }
+      std::size_t used = 0;
+      for (std::size_t k = 0; k < parts; ++k) {
+        auto const size = pending[k].get();
+        if (size != 0 && used != region[k]) {
+          std::memmove(arena + used, arena + region[k], size);
+        }
+        used += size;
+      }
+      out.arena.resize(used);
+    }
+  } catch (...) {
+    out.clear();
+    throw;
+  }
+  for (std::size_t i = 0; i < count; ++i) {
+    out.offsets[i + 1] += out.offsets[i];
+  }
+}
+
+}  // namespace batch
+}  // namespace utils
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <span>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <sys/mman.h> // madvise
+#endif
+
+namespace utils {
+
+inline constexpr std::size_t huge_page_size = std::size_t{2} << 20; // 2 MiB
+
+/* Allocator which default-initializes its elements.
+ *
+ * `resize()` of a vector using it does not zero-fill the new bytes, which
+ * are meant to be overwritten right away (e.g. by a compressor).
+ *
+ * - Alignment : alignment of the storage (at least the default new alignment)
+ * - HugePages : for allocations of 2 MiB or more, align the storage on 2 MiB
+ *               and ask the kernel for transparent huge pages (Linux only).
+ */
+template <typename T, std::size_t Alignment = alignof(T), bool HugePages = false>
+struct default_init_allocator {
+  using value_type = T;
+  using is_always_equal = std::true_type;
+
+  template <typename U>
+  struct rebind {
+    using other = default_init_allocator<U, Alignment, HugePages>;
+  };
+
+  default_init_allocator() noexcept = default;
+  template <typename U>
+  default_init_allocator(default_init_allocator<U, Alignment, HugePages> const &) noexcept {}
+
+  T *allocate(std::size_t n) {
+    if (n > static_cast<std::size_t>(-1) / sizeof(T)) {
+      throw std::bad_array_new_length();
+    }
+    auto const bytes = n * sizeof(T);
+    auto *p = static_cast<T *>(::operator new(bytes, std::align_val_t{alignment_for(bytes)}));
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+    if (HugePages && bytes >= huge_page_size) {
+      ::madvise(p, bytes, MADV_HUGEPAGE); // only a hint: failure is harmless
+    }
+#endif
+    return p;
+  }
+
+  void deallocate(T *p, std::size_t n) noexcept {
+    auto const bytes = n * sizeof(T);
+    ::operator delete(p, bytes, std::align_val_t{alignment_for(bytes)});
+  }
+
+  // Value-initialization (`U()`) becomes default-initialization (`U`)
+  template <typename U>
+  void construct(U *p) noexcept(std::is_nothrow_default_constructible_v<U>) {
+    ::new (static_cast<void *>(p)) U;
+  }
+  template <typename U, typename... Args>
+  void construct(U *p, Args &&...args) {
+    ::new (static_cast<void *>(p)) U(std::forward<Args>(args)...);
+  }
+
+  template <typename U>
+  friend bool operator==(default_init_allocator const &,
+                         default_init_allocator<U, Alignment, HugePages> const &) noexcept {
+    return true;
+  }
+
+ private:
+  static constexpr std::size_t alignment_for(std::size_t bytes) noexcept {
+    constexpr std::size_t base = Alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__
+                                     ? Alignment
+                                     : __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+    return (HugePages && bytes >= huge_page_size && huge_page_size > base) ? huge_page_size
+                                                                           : base;
+  }
+};
+
+/* Growable byte buffer used as output of the compression wrappers.
+ *
+ * It is a std::vector, so:
+ * - resize() grows without zero-filling (default-init allocator),
+ * - clear() / shrinking resize() keep the capacity for the next use,
+ * - "releasing" it is a move: `auto out = std::move(buffer);`
+ * Use to_vector() where a plain std::vector<std::uint8_t> is required.
+ */
+using byte_buffer = std::vector<std::uint8_t, default_init_allocator<std::uint8_t>>;
+
+/// Byte buffer whose storage is aligned on `Alignment` bytes (e.g. 64 for cache lines, 4096 for O_DIRECT)
+template <std::size_t Alignment>
+using aligned_byte_buffer = std::vector<std::uint8_t, default_init_allocator<std::uint8_t, Alignment>>;
+
+/// Byte buffer backed by transparent huge pages when it grows past 2 MiB
+using huge_byte_buffer = std::vector<std::uint8_t, default_init_allocator<std::uint8_t, 64, true>>;
+
+/// Copy into a plain vector (for APIs which require std::vector<std::uint8_t>)
+template <typename Alloc>
+inline std::vector<std::uint8_t> to_vector(std::vector<std::uint8_t, Alloc> const &buffer) {
+  return std::vector<std::uint8_t>(buffer.begin(), buffer.end());
+}
+
+/* Views on bytes (no copy), for the span-based functions of the wrappers */
+
+inline std::span<std::byte const> as_bytes(std::string_view str) noexcept {
+  return {reinterpret_cast<std::byte const *>(str.data()), str.size()};
+}
+
+template <typename Alloc>
+inline std::span<std::byte const> as_bytes(std::vector<std::uint8_t, Alloc> const &buffer) noexcept {
+  return {reinterpret_cast<std::byte const *>(buffer.data()), buffer.size()};
+}
+
+template <typename Alloc>
+inline std::span<std::byte> as_writable_bytes(std::vector<std::uint8_t, Alloc> &buffer) noexcept {
+  return {reinterpret_cast<std::byte *>(buffer.data()), buffer.size()};
+}
+
+}  // namespace utils
@@ -0,0 +1,323 @@
+#pragma once
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+
+#include "byte_buffer.hpp"
+#include "lz4/lz4_frame.hpp"
+#include "zstd/zstdpp.hpp"
+
+namespace codec {
+
+/* One compile-time interface over zstdpp and lz4.
+ *
+ * A codec is a small value type (its level) modelling the Codec concept:
+ * non-allocating compress_into / decompress_into on caller buffers and a
+ * compress_bound, plus compile-time traits. The drivers below are
+ * templates over the codec, so the codec choice is resolved at compile
+ * time: no virtual call nor intermediate vector per block.
+ *
+ *   codec::compress_blocks(codec::lz4_codec{}, src, 4096, out);
+ *   codec::decompress_blocks(codec::lz4_codec{}, out, restored);
+ *
+ * Traits:
+ *   needs_size          decompression needs the original size from the
+ *                       caller (raw LZ4 blocks); otherwise decompressed_size()
+ *                       reads it from the compressed data
+ *   supports_streaming  compress(istream&, ostream&) / decompress(...) exist
+ */
+using rospan_t = std::span<std::byte const>;
+using span_t = std::span<std::byte>;
+using buffer_t = utils::byte_buffer;
+
+using utils::as_bytes;
+using utils::as_writable_bytes;
+
+/// A size, or an error message (common to zstdpp::Result and lz4::Result)
+class Result {
+ public:
+  Result(std::size_t size) noexcept : size_(size) {}
+  Result(zstdpp::Result const &r) noexcept : size_(*r), error_(r ? nullptr : r.message()) {}
+  Result(lz4::Result const &r) noexcept : size_(*r), error_(r ? nullptr : r.message()) {}
+
+  static Result failure(char const *message) noexcept {
+    Result r{0};
+    r.error_ = message;
+    return r;
+  }
+
+  bool has_value() const noexcept { return error_ == nullptr; }
+  explicit operator bool() const noexcept { return has_value(); }
+  std::size_t operator*() const noexcept { return size_; }
+  char const *message() const noexcept { return error_ != nullptr ? error_ : "No error detected"; }
+
+  /// The size, or throws std::runtime_error on error.
+  std::size_t value() const {
+    if (!has_value()) {
+      throw std::runtime_error(message());
+    }
+    return size_;
+  }
+
+ private:
+  std::size_t size_;
+  char const *error_{nullptr};
+};
+
+template <typename C>
+concept Codec = std::copyable<C> && requires(C const &codec, rospan_t src, span_t dst, std::size_t size) {
+  { C::name } -> std::convertible_to<std::string_view>;
+  { C::needs_size } -> std::convertible_to<bool>;
+  { C::supports_streaming } -> std::convertible_to<bool>;
+  { C::compress_bound(size) } -> std::same_as<std::size_t>;
+  { codec.compress_into(src, dst) } -> std::same_as<Result>;
+  /// `dst` holds the original size exactly
+  { codec.decompress_into(src, dst) } -> std::same_as<Result>;
+};
+
+/// Codecs which store the original size in their output
+template <typename C>
+concept SizedCodec = Codec<C> && !C::needs_size && requires(rospan_t src) {
+  { C::decompressed_size(src) } -> std::same_as<Result>;
+};
+
+template <typename C>
+concept StreamingCodec = Codec<C> && C::supports_streaming && requires(C const &codec, std::istream &in, std::ostream &out) {
+  codec.compress(in, out);
+  codec.decompress(in, out);
+};
+
+/* Models */
+
+struct zstd_codec {
+  static constexpr std::string_view name = "zstd";
+  static constexpr bool needs_size = false;
+  static constexpr bool supports_streaming = true;
+
+  zstdpp::compress_level_t level = 3;
+
+  static std::size_t compress_bound(std::size_t size) noexcept { return zstdpp::compress_bound(size); }
+  static Result decompressed_size(rospan_t src) noexcept { return zstdpp::decompressed_size(src); }
+
+  Result compress_into(rospan_t src, span_t dst) const { return zstdpp::compress_into(src, dst, level); }
+  Result decompress_into(rospan_t src, span_t dst) const { return zstdpp::decompress_into(src, dst); }
+
+  void compress(std::istream &in, std::ostream &out) const { zstdpp::stream::compress(in, out, 1, level); }
+  void decompress(std::istream &in, std::ostream &out) const { zstdpp::stream::decompress(in, out); }
+};
+
+/// LZ4 blocks (fast mode): the fastest decoder, but raw blocks do not store their size
+struct lz4_codec {
+  static constexpr std::string_view name = "lz4";
+  static constexpr bool needs_size = true;
+  static constexpr bool supports_streaming = true;
+
+  lz4::compress_level_t level = lz4::default_level;
+
+  static std::size_t compress_bound(std::size_t size) noexcept { return lz4::compress_bound(size); }
+
+  Result compress_into(rospan_t src, span_t dst) const { return lz4::compress_into(src, dst, level); }
+  Result decompress_into(rospan_t src, span_t dst) const { return lz4::decompress_into(src, dst); }
+
+  void compress(std::istream &in, std::ostream &out) const {
+    lz4::stream::compress(in, out, lz4::FrameParams{.compression_level = std::max(level, 0)});
+  }
+  void decompress(std::istream &in, std::ostream &out) const { lz4::stream::decompress(in, out); }
+};
+
+/// LZ4HC: slower compression, better ratio, the same decoder
+struct lz4hc_codec : lz4_codec {
+  static constexpr std::string_view name = "lz4hc";
+
+  lz4hc_codec(lz4::compress_level_t hc_level = LZ4HC_CLEVEL_DEFAULT) noexcept
+      : lz4_codec{std::clamp(hc_level, lz4::hc_min_level, lz4::max_level)} {}
+};
+
+/// Stored as is: a baseline, and for data which does not compress
+struct passthrough_codec {
+  static constexpr std::string_view name = "passthrough";
+  static constexpr bool needs_size = false;
+  static constexpr bool supports_streaming = false;
+
+  static std::size_t compress_bound(std::size_t size) noexcept { return size; }
+  static Result decompressed_size(rospan_t src) noexcept { return src.size(); }
+
+  Result compress_into(rospan_t src, span_t dst) const noexcept { return copy(src, dst); }
+  Result decompress_into(rospan_t src, span_t dst) const noexcept { return copy(src, dst); }
+
+ private:
+  static Result copy(rospan_t src, span_t dst) noexcept {
+    if (dst.size() < src.size()) {
+      return Result::failure("Destination buffer is too small");
+    }
+    if (!src.empty()) {
+      std::memcpy(dst.data(), src.data(), src.size());
+    }
+    return src.size();
+  }
+};
+
+static_assert(SizedCodec<zstd_codec> && StreamingCodec<zstd_codec>);
+static_assert(Codec<lz4_codec> && !SizedCodec<lz4_codec> && StreamingCodec<lz4_codec>);
+static_assert(Codec<lz4hc_codec> && StreamingCodec<lz4hc_codec>);
+static_assert(SizedCodec<passthrough_codec> && !StreamingCodec<passthrough_codec>);
+
+/* Block driver
+ *
+ * The input is cut into blocks of `block_size` bytes, each one compressed
+ * on its own (independent blocks: random access, parallelism):
+ *
+ *   block = [compressed size: u32 LE][original size: u32 LE, needs_size codecs only][data]
+ */
+namespace detail {
+
+inline void put_le32(std::byte *p, std::uint32_t value) noexcept {
+  for (int i = 0; i < 4; ++i) {
+    p[i] = static_cast<std::byte>(value >> (8 * i));
+  }
+}
+
+inline std::uint32_t get_le32(std::byte const *p) noexcept {
+  return std::to_integer<std::uint32_t>(p[0]) | (std::to_integer<std::uint32_t>(p[1]) << 8) |
+         (std::to_integer<std::uint32_t>(p[2]) << 16) | (std::to_integer<std::uint32_t>(p[3]) << 24);
+}
+
+template <Codec C>
+inline constexpr std::size_t block_header_size = C::needs_size ? 8 : 4;
+
+inline constexpr std::size_t max_block_size = std::size_t{1} << 30;
+
+}  // namespace detail
+
+/// Upper bound of compress_blocks() output for `size` bytes
+template <Codec C>
+std::size_t blocks_bound(std::size_t size, std::size_t block_size) noexcept {
+  auto const blocks = size / block_size + 1;
+  return size + blocks * (detail::block_header_size<C> + C::compress_bound(block_size) - block_size);
+}
+
+/// Compress `src` as independent blocks, appended to `out`; returns the bytes appended
+template <Codec C>
+std::size_t compress_blocks(C const &codec, rospan_t src, std::size_t block_size, buffer_t &out) {
+  if (block_size == 0 || block_size > detail::max_block_size) {
+    throw std::invalid_argument("codec::compress_blocks: invalid block size");
+  }
+  auto const start = out.size();
+  out.resize(start + blocks_bound<C>(src.size(), block_size));
+  auto *p = reinterpret_cast<std::byte *>(out.data()) + start;
+  for (std::size_t pos = 0; pos < src.size(); pos += block_size) {
+    auto const block = src.subspan(pos, std::min(block_size, src.size() - pos));
+    auto *const header = p;
+    p += detail::block_header_size<C>;
+    auto const size = codec.compress_into(block, span_t(p, C::compress_bound(block.size()))).value();
+    detail::put_le32(header, static_cast<std::uint32_t>(size));
+    if constexpr (C::needs_size) {
+      detail::put_le32(header + 4, static_cast<std::uint32_t>(block.size()));
+    }
+    p += size;
+  }
+  out.resize(static_cast<std::size_t>(p - reinterpret_cast<std::byte *>(out.data())));
+  return out.size() - start;
+}
+
+/// Decompress compress_blocks() output, appended to `out`; returns the bytes appended
+template <Codec C>
+std::size_t decompress_blocks(C const &codec, rospan_t src, buffer_t &out) {
+  auto const start = out.size();
+  for (std::size_t pos = 0; pos < src.size();) {
+    if (src.size() - pos < detail::block_header_size<C>) {
+      throw std::runtime_error("codec::decompress_blocks: truncated block header");
+    }
+    auto const size = detail::get_le32(src.data() + pos);
+    pos += detail::block_header_size<C>;
+    if (size > src.size() - pos) {
+      throw std::runtime_error("codec::decompress_blocks: truncated block");
+    }
+    auto const block = src.subspan(pos, size);
+    std::size_t original = 0;
+    if constexpr (C::needs_size) {
+      original = detail::get_le32(src.data() + pos - 4);
+    } else {
+      original = C::decompressed_size(block).value();
+    }
+    if (original > detail::max_block_size) {
+      throw std::runtime_error("codec::decompress_blocks: invalid block size");
+    }
+    auto const offset = out.size();
+    out.resize(offset + original);
+    auto const dst = span_t(reinterpret_cast<std::byte *>(out.data()) + offset, original);
+    if (codec.decompress_into(block, dst).value() != original) {
+      throw std::runtime_error("codec::decompress_blocks: block size mismatch");
+    }
+    pos += size;
+  }
+  return out.size() - start;
+}
+
+/* Stream driver: the codec's own streaming format when it has one,
+ * compress_blocks() chunks of `chunk_size` bytes otherwise.
+ */
+inline constexpr std::size_t default_chunk_size = std::size_t{1} << 20;
+
+template <Codec C>
+void compress(C const &codec, std::istream &in, std::ostream &out, std::size_t chunk_size = default_chunk_size) {
+  if constexpr (StreamingCodec<C>) {
+    codec.compress(in, out);
+  } else {
+    buffer_t chunk{};
+    buffer_t compressed{};
+    chunk.resize(chunk_size);
+    while (in) {
+      in.read(reinterpret_cast<char *>(chunk.data()), static_cast<std::streamsize>(chunk.size()));
+      auto const read = static_cast<std::size_t>(in.gcount());
+      compressed.clear();
+      compress_blocks(codec, rospan_t(reinterpret_cast<std::byte const *>(chunk.data()), read), chunk_size,
+                      compressed);
+      out.write(reinterpret_cast<char const *>(compressed.data()), static_cast<std::streamsize>(compressed.size()));
+    }
+    if (!out) {
+      throw std::runtime_error("codec::compress: write failed");
+    }
+  }
+}
+
+template <Codec C>
+void decompress(C const &codec, std::istream &in, std::ostream &out) {
+  if constexpr (StreamingCodec<C>) {
+    codec.decompress(in, out);
+  } else {
+    buffer_t block{};
+    buffer_t decompressed{};
+    std::byte header[detail::block_header_size<C>];
+    while (in.read(reinterpret_cast<char *>(header), sizeof(header))) {
+      auto const size = detail::get_le32(header);
+      if (size > C::compress_bound(detail::max_block_size)) {  // before allocating it
+        throw std::runtime_error("codec::decompress: invalid block size");
+      }
+      block.resize(sizeof(header) + size);
+      std::memcpy(block.data(), header, sizeof(header));
+      if (!in.read(reinterpret_cast<char *>(block.data() + sizeof(header)), size)) {
+        throw std::runtime_error("codec::decompress: truncated block");
+      }
+      decompressed.clear();
+      decompress_blocks(codec, rospan_t(reinterpret_cast<std::byte const *>(block.data()), block.size()),
+                        decompressed);
+      out.write(reinterpret_cast<char const *>(decompressed.data()), static_cast<std::streamsize>(decompressed.size()));
+    }
+    if (in.gcount() != 0) {
+      throw std::runtime_error("codec::decompress: truncated block header");
+    }
+    if (!out) {
+      throw std::runtime_error("codec::decompress: write failed");
+    }
+  }
+}
+
+}  // namespace codec
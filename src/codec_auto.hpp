@@ -0,0 +1,316 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#include "codec.hpp"
+#include "lz4/lz4_envelope.hpp"
+
+namespace codec {
+
+/* Automatic codec and level selection (auto_compress)
+ *
+ * One fixed setting wastes CPU on blobs which do not compress (already
+ * compressed media: zstd output is larger than the input) and leaves ratio
+ * on the table for those which compress well. auto_compress samples the
+ * input first:
+ *
+ * 1. a byte histogram of `slices` slices of `slice_size` bytes, spread over
+ *    the input: above `max_entropy` bits per byte the data is stored as is,
+ *    without any trial;
+ * 2. each candidate compresses the same slices; its score is
+ *
+ *      sampled output / input  +  cpu_weight * log2(relative_cost)
+ *
+ *    i.e. each doubling of the CPU time has to save `cpu_weight` of the
+ *    input size. The lowest score wins, unless it saves less than
+ *    `min_saving`: then the data is stored.
+ *
+ * The sample is small (16 KiB by default) so that the trials cost a few
+ * percent of compressing a large input. Inputs no larger than the sample
+ * only get the entropy check, then the `small` codec: trying every
+ * candidate on them would cost more than what the best one saves. Data
+ * which does not save `min_saving` after all is stored as well.
+ *
+ * The output is an lz4::envelope (lz4_envelope.hpp) whose codec is the one
+ * picked: LZ4 block, zstd frame or stored. auto_decompress decodes any of
+ * them, those of lz4::compress_framed included (checksum verified):
+ *
+ *   Flags (1) | Original_Size (varint, 1..10) | [XXH32 (4)] | Payload
+ *
+ *   codec::buffer_t packed = codec::auto_compress(data);
+ *   codec::buffer_t data2 = codec::auto_decompress(packed);
+ */
+/// Values are the envelope codec IDs
+enum class Method : std::uint8_t {
+  lz4 = lz4::envelope::codec_lz4,
+  stored = lz4::envelope::codec_stored,
+  zstd = lz4::envelope::codec_zstd,
+};
+
+struct Choice {
+  Method method{Method::stored};
+  int level{0};  ///< lz4: >= lz4::hc_min_level for LZ4HC
+};
+
+struct Candidate {
+  Method method;
+  int level;
+  double relative_cost;  ///< compression CPU time relative to LZ4 (1)
+};
+
+struct Policy {
+  /// Compression CPU time relative to LZ4, as measured on text and logs (CodecBench)
+  std::vector<Candidate> candidates{
+      {Method::lz4, lz4::default_level, 1.0},
+      {Method::zstd, 1, 2.0},
+      {Method::zstd, 3, 2.5},
+  };
+  double cpu_weight = 0.02;    ///< saving (fraction of the input) each doubling of CPU time must buy
+  double min_saving = 0.03;    ///< below: stored
+  double max_entropy = 7.9;    ///< bits per byte, above: stored without trial
+  std::size_t slice_size = std::size_t{4} << 10;
+  std::size_t slices = 4;
+  Choice small{Method::zstd, 1};  ///< for inputs no larger than the sample
+
+  /// Only the fastest candidates
+  static Policy fast() {
+    Policy policy{};
+    policy.candidates = {{Method::lz4, lz4::default_level, 1.0}, {Method::zstd, 1, 2.0}};
+    policy.small = {Method::lz4, lz4::default_level};
+    return policy;
+  }
+
+  /// Ratio first: every doubling of CPU only has to save 0.5%
+  static Policy ratio() {
+    Policy policy{};
+    policy.candidates.push_back({Method::zstd, 9, 12.0});
+    policy.candidates.push_back({Method::lz4, 9, 12.0});
+    policy.cpu_weight = 0.005;
+    policy.small = {Method::zstd, 9};
+    return policy;
+  }
+};
+
+namespace detail {
+
+/// auto_compress writes no checksum
+inline constexpr std::size_t max_auto_header = 1 + lz4::envelope::max_varint_size;
+
+/// Largest original size of a zstd envelope: more is rejected before anything is allocated
+inline constexpr std::size_t max_zstd_original_size = std::size_t{1} << 32;
+
+/// Shannon entropy of the bytes of `slices`, in bits per byte
+template <typename Slices>
+double entropy(Slices const &slices) noexcept {
+  std::array<std::uint64_t, 256> histogram{};
+  std::uint64_t total = 0;
+  for (rospan_t slice : slices) {
+    for (auto byte : slice) {
+      ++histogram[std::to_integer<std::uint8_t>(byte)];
+    }
+    total += slice.size();
+  }
+  double bits = 0;
+  for (auto count : histogram) {
+    if (count != 0) {
+      auto const p = static_cast<double>(count) / static_cast<double>(total);
+      bits -= p * std::log2(p);
+    }
+  }
+  return bits;
+}
+
+/// `slices` slices evenly spread over `src` (`src` itself when it is smaller than the sample)
+inline std::vector<rospan_t> sample(rospan_t src, Policy const &policy) {
+  auto const slice_size = std::max<std::size_t>(policy.slice_size, 1);
+  auto const slices = std::max<std::size_t>(policy.slices, 1);
+  if (src.size() <= slice_size * slices) {
+    return {src};
+  }
+  std::vector<rospan_t> sample{};
+  auto const stride = slices > 1 ? (src.size() - slice_size) / (slices - 1) : 0;
+  for (std::size_t i = 0; i < slices; ++i) {
+    sample.push_back(src.subspan(i * stride, slice_size));
+  }
+  return sample;
+}
+
+inline Result compress_with(Choice choice, rospan_t src, span_t dst) {
+  switch (choice.method) {
+    case Method::lz4: return lz4_codec{choice.level}.compress_into(src, dst);
+    case Method::zstd: return zstd_codec{choice.level}.compress_into(src, dst);
+    case Method::stored: break;
+  }
+  return passthrough_codec{}.compress_into(src, dst);
+}
+
+inline std::size_t payload_bound(std::size_t size) noexcept {
+  return std::max({size, zstd_codec::compress_bound(size), lz4_codec::compress_bound(size)});
+}
+
+inline double score(std::size_t in, std::size_t out, double relative_cost, Policy const &policy) noexcept {
+  return static_cast<double>(out) / static_cast<double>(in) + policy.cpu_weight * std::log2(relative_cost);
+}
+
+/// Best candidate for `sample` (from sample()), which is the whole input when `whole`
+inline Choice pick(std::vector<rospan_t> const &sample, bool whole, Policy const &policy) {
+  std::size_t sample_size = 0;
+  std::size_t largest = 0;
+  for (auto slice : sample) {
+    sample_size += slice.size();
+    largest = std::max(largest, slice.size());
+  }
+  if (sample_size == 0 || entropy(sample) > policy.max_entropy) {
+    return {};
+  }
+  if (whole) {
+    return policy.small;
+  }
+
+  Choice best{};
+  double best_score = 0;
+  std::size_t best_size = sample_size;
+  buffer_t scratch{};
+  scratch.resize(payload_bound(largest));
+  for (auto const &candidate : policy.candidates) {
+    Choice const choice{candidate.method, candidate.level};
+    std::size_t size = 0;
+    for (auto slice : sample) {
+      auto const result = compress_with(choice, slice, {reinterpret_cast<std::byte *>(scratch.data()), scratch.size()});
+      size += result ? *result : slice.size();
+    }
+    auto const candidate_score = score(sample_size, size, candidate.relative_cost, policy);
+    if (best.method == Method::stored || candidate_score < best_score) {
+      best = choice;
+      best_score = candidate_score;
+      best_size = size;
+    }
+  }
+  if (static_cast<double>(best_size) > static_cast<double>(sample_size) * (1 - policy.min_saving)) {
+    return {};
+  }
+  return best;
+}
+
+/// lz4::envelope::read_header(), plus the content size of a zstd frame checked against the header,
+/// and against what the frame can produce (ZSTD_decompressBound(), one block per 4 bytes)
+inline Result read_envelope(rospan_t src, lz4::envelope::Header &header) noexcept {
+  Result const result = lz4::envelope::read_header(src, header);
+  if (result && header.codec == lz4::envelope::codec_zstd) {
+    auto const payload = src.subspan(header.size);
+    auto const content = zstd_codec::decompressed_size(payload);
+    if (!content || *content != header.original_size || header.original_size > max_zstd_original_size ||
+        zstdpp::stream::detail::bounded_content_size(payload) != header.original_size) {
+      return Result::failure("Corrupted envelope");
+    }
+  }
+  return result;
+}
+
+}  // namespace detail
+
+/// The codec and level auto_compress would use for `src`
+inline Choice choose(rospan_t src, Policy const &policy = {}) {
+  auto const sample = detail::sample(src, policy);
+  return detail::pick(sample, sample.front().size() == src.size(), policy);
+}
+
+/// Size of the largest envelope for `size` bytes
+inline std::size_t auto_bound(std::size_t size) noexcept {
+  return detail::max_auto_header + detail::payload_bound(size);
+}
+
+/// `dst` holds auto_bound(src.size()) bytes; returns the envelope size
+inline Result auto_compress_into(rospan_t src, span_t dst, Policy const &policy = {}) {
+  if (dst.size() < auto_bound(src.size())) {
+    return Result::failure("Destination buffer is too small");
+  }
+  auto const choice = choose(src, policy);
+  lz4::envelope::Header header{};
+  header.original_size = src.size();
+  header.codec = static_cast<std::uint8_t>(choice.method);
+  header.size = 1 + lz4::envelope::varint_size(src.size());
+  auto const payload = dst.subspan(header.size);
+
+  auto size = detail::compress_with(choice, src, payload);
+  if (size && choice.method != Method::stored &&
+      static_cast<double>(*size) > static_cast<double>(src.size()) * (1 - policy.min_saving)) {
+    // the sample was wrong: not worth decoding
+    header.codec = lz4::envelope::codec_stored;
+    size = detail::compress_with({}, src, payload);
+  }
+  if (!size) {
+    return size;
+  }
+  lz4::envelope::write_header(header, dst);
+  return header.size + *size;
+}
+
+inline buffer_t auto_compress(rospan_t src, Policy const &policy = {}) {
+  buffer_t out{};
+  out.resize(auto_bound(src.size()));
+  out.resize(auto_compress_into(src, {reinterpret_cast<std::byte *>(out.data()), out.size()}, policy).value());
+  return out;
+}
+
+/// Method, original size and header size of an envelope
+struct AutoHeader {
+  Method method{Method::stored};
+  std::size_t original_size{0};
+  std::size_t size{0};
+};
+
+/// Sizes the payload cannot produce are rejected, before anything is allocated for them
+inline Result read_auto_header(rospan_t src, AutoHeader &header) noexcept {
+  lz4::envelope::Header envelope{};
+  auto const result = detail::read_envelope(src, envelope);
+  if (result) {
+    header.method = static_cast<Method>(envelope.codec);
+    header.original_size = envelope.original_size;
+    header.size = envelope.size;
+  }
+  return result;
+}
+
+/// `dst` holds the original size (see read_auto_header()) at least
+inline Result auto_decompress_into(rospan_t src, span_t dst) {
+  lz4::envelope::Header header{};
+  if (auto const result = detail::read_envelope(src, header); !result) {
+    return result;
+  }
+  if (dst.size() < header.original_size) {
+    return Result::failure("Destination buffer is too small");
+  }
+  auto const payload = src.subspan(header.size);
+  auto const out = dst.first(header.original_size);
+  Result result{0};
+  switch (static_cast<Method>(header.codec)) {
+    case Method::lz4: result = lz4_codec{}.decompress_into(payload, out); break;
+    case Method::zstd: result = zstd_codec{}.decompress_into(payload, out); break;
+    case Method::stored: result = passthrough_codec{}.decompress_into(payload, out); break;
+  }
+  if (result && *result != header.original_size) {
+    return Result::failure("Envelope size mismatch");
+  }
+  if (result && header.checksum && lz4::xxh32(out) != *header.checksum) {
+    return Result::failure("Envelope checksum mismatch");
+  }
+  return result;
+}
+
+inline buffer_t auto_decompress(rospan_t src) {
+  AutoHeader header{};
+  read_auto_header(src, header).value();
+  buffer_t out{};
+  out.resize(header.original_size);
+  auto_decompress_into(src, {reinterpret_cast<std::byte *>(out.data()), out.size()}).value();
+  return out;
+}
+
+}  // namespace codec
@@ -0,0 +1,289 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include "byte_buffer.hpp"
+
+#if !defined(CORPUS_DATA_DIR)
+#define CORPUS_DATA_DIR "data"
+#endif
+
+namespace utils {
+namespace corpus {
+
+/* Reproducible synthetic datasets for tests and benchmarks.
+ *
+ * generate(kind, size, seed) returns the same bytes on every machine and
+ * every standard library: only std::mt19937_64 (fully specified by the
+ * standard) is used, never the <random> distributions (implementation
+ * defined), and numbers are stored little-endian.
+ *
+ * The corpus_gen tool writes the datasets to data/ (file_name()); load()
+ * reads such a file when it exists and generates the data otherwise, so
+ * tests and benchmarks work either way and see the same bytes.
+ */
+enum class Kind : std::uint8_t {
+  text,        ///< English-like prose, Zipf-like word frequencies
+  logs,        ///< timestamped service log lines
+  json,        ///< one JSON record per line (NDJSON)
+  numeric,     ///< little-endian int32 random walk (sensor-like series)
+  random,      ///< incompressible (like already compressed or encrypted data)
+  sparse,      ///< mostly zero runs with short random bursts
+  zeros,       ///< all zero
+  repetitive,  ///< a 1 MiB block repeated with rare mutations (long-distance matches)
+};
+
+inline constexpr std::array all_kinds = {Kind::text,   Kind::logs,  Kind::json,  Kind::numeric,
+                                         Kind::random, Kind::sparse, Kind::zeros, Kind::repetitive};
+
+inline constexpr std::uint64_t default_seed = 42;
+
+inline std::string_view name(Kind kind) noexcept {
+  switch (kind) {
+    case Kind::text: return "text";
+    case Kind::logs: return "logs";
+    case Kind::json: return "json";
+    case Kind::numeric: return "numeric";
+    case Kind::random: return "random";
+    case Kind::sparse: return "sparse";
+    case Kind::zeros: return "zeros";
+    case Kind::repetitive: return "repetitive";
+  }
+  return "unknown";
+}
+
+inline std::optional<Kind> parse_kind(std::string_view str) noexcept {
+  for (auto kind : all_kinds) {
+    if (name(kind) == str) {
+      return kind;
+    }
+  }
+  return std::nullopt;
+}
+
+/// e.g. "logs-16777216-s42.bin"
+inline std::string file_name(Kind kind, std::size_t size, std::uint64_t seed = default_seed) {
+  return std::string(name(kind)) + "-" + std::to_string(size) + "-s" + std::to_string(seed) + ".bin";
+}
+
+namespace detail {
+
+class Writer {
+ public:
+  Writer(byte_buffer &out, std::size_t size) : out_(out), size_(size) { out_.reserve(size); }
+
+  bool full() const noexcept { return out_.size() >= size_; }
+
+  void put(std::string_view str) {
+    auto const n = std::min(str.size(), size_ - out_.size());
+    out_.insert(out_.end(), str.begin(), str.begin() + static_cast<std::ptrdiff_t>(n));
+  }
+
+  void put_byte(std::uint8_t byte) {
+    if (!full()) {
+      out_.push_back(byte);
+    }
+  }
+
+ private:
+  byte_buffer &out_;
+  std::size_t size_;
+};
+
+/// Portable uniform-ish integer in [0, n) (modulo bias is irrelevant here)
+inline std::uint64_t below(std::mt19937_64 &rng, std::uint64_t n) { return rng() % n; }
+
+/// Skewed index in [0, n): small values are much more frequent (Zipf-like)
+inline std::uint64_t skewed(std::mt19937_64 &rng, std::uint64_t n) { return below(rng, n) * below(rng, n) / n; }
+
+inline std::string hex(std::uint64_t value, int digits) {
+  static constexpr char digit[] = "0123456789abcdef";
+  std::string str(static_cast<std::size_t>(digits), '0');
+  for (int i = digits - 1; i >= 0; --i, value >>= 4) {
+    str[static_cast<std::size_t>(i)] = digit[value & 0xF];
+  }
+  return str;
+}
+
+inline std::string two_digits(std::uint64_t value) { return (value < 10 ? "0" : "") + std::to_string(value); }
+
+inline constexpr std::array<std::string_view, 48> words = {
+    "the",    "of",      "and",    "to",      "a",       "in",     "is",       "that",
+    "for",    "it",      "as",     "with",    "was",     "on",     "be",       "by",
+    "data",   "this",    "are",    "from",    "at",      "or",     "an",       "which",
+    "stream", "buffer",  "block",  "frame",   "level",   "window", "dictionary", "entropy",
+    "match",  "literal", "offset", "length",  "thread",  "memory", "format",   "header",
+    "input",  "output",  "size",   "bytes",   "ratio",   "speed",  "archive",  "checksum"};
+
+inline void text(Writer &out, std::mt19937_64 &rng) {
+  bool capital = true;
+  while (!out.full()) {
+    std::string word(words[skewed(rng, words.size())]);
+    if (capital) {
+      word[0] = static_cast<char>(word[0] - 'a' + 'A');
+    }
+    auto const end = below(rng, 12);
+    capital = end == 0;
+    out.put(word);
+    out.put(end == 0 ? ".\n" : end == 1 ? ", " : " ");
+  }
+}
+
+inline void logs(Writer &out, std::mt19937_64 &rng) {
+  static constexpr std::array<std::string_view, 4> levels = {"INFO", "INFO", "WARN", "ERROR"};
+  static constexpr std::array<std::string_view, 5> methods = {"GET", "GET", "GET", "POST", "DELETE"};
+  static constexpr std::array<std::string_view, 4> paths = {"/api/v1/items/", "/api/v1/users/", "/healthz",
+                                                            "/api/v2/orders/"};
+  // One rng() call per statement: the evaluation order of `a + f() + g()` is unspecified
+  std::uint64_t millis = 0;
+  std::string line{};
+  while (!out.full()) {
+    millis += below(rng, 250);
+    auto const seconds = millis / 1000;
+    line = "2024-05-01T" + two_digits(seconds / 3600 % 24) + ":" + two_digits(seconds / 60 % 60) + ":" +
+           two_digits(seconds % 60) + "." + std::to_string(100 + millis % 900) + "Z ";
+    line += levels[skewed(rng, levels.size())];
+    line += " [svc-" + std::to_string(skewed(rng, 8)) + "] req=";
+    line += hex(rng(), 16);
+    line += " method=";
+    line += methods[below(rng, methods.size())];
+    auto const path = paths[skewed(rng, paths.size())];
+    line += " path=";
+    line += path;
+    if (path != "/healthz") {
+      line += std::to_string(below(rng, 100000));
+    }
+    line += below(rng, 20) == 0 ? " status=500" : " status=200";
+    line += " dur_ms=" + std::to_string(skewed(rng, 2000)) + "\n";
+    out.put(line);
+  }
+}
+
+inline void json(Writer &out, std::mt19937_64 &rng) {
+  static constexpr std::array<std::string_view, 4> countries = {"JP", "US", "DE", "BR"};
+  std::string line{};
+  for (std::uint64_t id = 1000000; !out.full(); id += 1 + below(rng, 3)) {
+    line = "{\"id\":" + std::to_string(id) + ",\"user\":{\"name\":\"user";
+    line += std::to_string(skewed(rng, 50000));
+    line += "\",\"country\":\"";
+    line += countries[skewed(rng, countries.size())];
+    line += "\"},\"items\":[" + std::to_string(below(rng, 1000));
+    line += "," + std::to_string(below(rng, 1000));
+    line += "],\"price\":" + std::to_string(below(rng, 100000) / 100);
+    line += "." + two_digits(below(rng, 100));
+    line += below(rng, 4) != 0 ? ",\"paid\":true}\n" : ",\"paid\":false}\n";
+    out.put(line);
+  }
+}
+
+inline void numeric(Writer &out, std::mt19937_64 &rng) {
+  std::int64_t value = 1 << 20;
+  while (!out.full()) {
+    value += static_cast<std::int64_t>(below(rng, 201)) - 100;
+    auto const word = static_cast<std::uint32_t>(static_cast<std::int32_t>(value));
+    for (int shift = 0; shift < 32; shift += 8) {
+      out.put_byte(static_cast<std::uint8_t>(word >> shift));
+    }
+  }
+}
+
+inline void random(byte_buffer &out, std::size_t size, std::mt19937_64 &rng) {
+  out.resize(size);
+  for (std::size_t i = 0; i < size; i += sizeof(std::uint64_t)) {
+    auto const word = rng();
+    for (std::size_t b = 0; b < sizeof(word) && i + b < size; ++b) {
+      out[i + b] = static_cast<std::uint8_t>(word >> (8 * b));
+    }
+  }
+}
+
+inline void sparse(Writer &out, std::mt19937_64 &rng) {
+  while (!out.full()) {
+    for (auto zeros = skewed(rng, 4096); zeros > 0 && !out.full(); --zeros) {
+      out.put_byte(0);
+    }
+    for (auto burst = 1 + below(rng, 16); burst > 0; --burst) {
+      out.put_byte(static_cast<std::uint8_t>(rng()));
+    }
+  }
+}
+
+inline void repetitive(Writer &out, std::mt19937_64 &rng) {
+  constexpr std::size_t block_size = std::size_t{1} << 20;
+  byte_buffer block{};
+  Writer block_writer(block, block_size);
+  text(block_writer, rng);
+  while (!out.full()) {
+    for (int i = 0; i < 64; ++i) {  // ~0.006% of the bytes change between copies
+      block[below(rng, block.size())] = static_cast<std::uint8_t>(rng());
+    }
+    out.put(std::string_view(reinterpret_cast<char const *>(block.data()), block.size()));
+  }
+}
+
+}  // namespace detail
+
+/// `size` bytes of `kind`, identical for the same (kind, size, seed) everywhere
+inline byte_buffer generate(Kind kind, std::size_t size, std::uint64_t seed = default_seed) {
+  std::mt19937_64 rng{seed ^ (static_cast<std::uint64_t>(kind) << 56)};
+  byte_buffer out{};
+  detail::Writer writer(out, size);
+  switch (kind) {
+    case Kind::text: detail::text(writer, rng); break;
+    case Kind::logs: detail::logs(writer, rng); break;
+    case Kind::json: detail::json(writer, rng); break;
+    case Kind::numeric: detail::numeric(writer, rng); break;
+    case Kind::random: detail::random(out, size, rng); break;
+    case Kind::sparse: detail::sparse(writer, rng); break;
+    case Kind::zeros:
+      out.resize(size);
+      std::memset(out.data(), 0, size);
+      break;
+    case Kind::repetitive: detail::repetitive(writer, rng); break;
+  }
+  return out;
+}
+
+/// Write the dataset to `dir`/file_name(); returns the path
+inline std::filesystem::path write(std::filesystem::path const &dir, Kind kind, std::size_t size,
+                                   std::uint64_t seed = default_seed) {
+  std::filesystem::create_directories(dir);
+  auto const path = dir / file_name(kind, size, seed);
+  auto const data = generate(kind, size, seed);
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  file.write(reinterpret_cast<char const *>(data.data()), static_cast<std::streamsize>(data.size()));
+  if (!file) {
+    throw std::runtime_error("corpus: cannot write " + path.string());
+  }
+  return path;
+}
+
+/// The dataset from `dir` if corpus_gen wrote it there, generated otherwise
+inline byte_buffer load(Kind kind, std::size_t size, std::uint64_t seed = default_seed,
+                        std::filesystem::path const &dir = CORPUS_DATA_DIR) {
+  auto const path = dir / file_name(kind, size, seed);
+  std::error_code error{};
+  if (std::filesystem::file_size(path, error) == size && !error) {
+    std::ifstream file(path, std::ios::binary);
+    byte_buffer data{};
+    data.resize(size);
+    if (file.read(reinterpret_cast<char *>(data.data()), static_cast<std::streamsize>(size))) {
+      return data;
+    }
+  }
+  return generate(kind, size, seed);
+}
+
+}  // namespace corpus
+}  // namespace utils
@@ -0,0 +1,84 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <chrono>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "corpus.hpp"
+
+// Write the synthetic corpus (see corpus.hpp) to a directory:
+//   corpus_gen [-o data] [-s 16M] [--seed 42] [kind...]
+// Without kinds, every kind is written. Sizes accept K/M/G suffixes (x1024).
+namespace {
+
+std::size_t parse_size(std::string_view str) {
+  std::size_t pos = 0;
+  auto size = static_cast<std::size_t>(std::stoull(std::string(str), &pos));
+  auto const suffix = str.substr(pos);
+  if (suffix == "K" || suffix == "k") {
+    size <<= 10;
+  } else if (suffix == "M" || suffix == "m") {
+    size <<= 20;
+  } else if (suffix == "G" || suffix == "g") {
+    size <<= 30;
+  } else if (!suffix.empty()) {
+    throw std::invalid_argument("invalid size: " + std::string(str));
+  }
+  return size;
+}
+
+int usage() {
+  std::cerr << "usage: corpus_gen [-o dir] [-s size[K|M|G]] [--seed n] [kind...]\nkinds:";
+  for (auto kind : utils::corpus::all_kinds) {
+    std::cerr << ' ' << utils::corpus::name(kind);
+  }
+  std::cerr << std::endl;
+  return 2;
+}
+
+}  // namespace
+
+int main(int argc, const char **argv) {
+  std::string dir = CORPUS_DATA_DIR;
+  std::size_t size = std::size_t{16} << 20;
+  std::uint64_t seed = utils::corpus::default_seed;
+  std::vector<utils::corpus::Kind> kinds{};
+
+  try {
+    for (int i = 1; i < argc; ++i) {
+      std::string_view const arg = argv[i];
+      if ((arg == "-o" || arg == "-s" || arg == "--seed") && i + 1 >= argc) {
+        return usage();
+      }
+      if (arg == "-o") {
+        dir = argv[++i];
+      } else if (arg == "-s") {
+        size = parse_size(argv[++i]);
+      } else if (arg == "--seed") {
+        seed = std::stoull(argv[++i]);
+      } else if (auto const kind = utils::corpus::parse_kind(arg)) {
+        kinds.push_back(*kind);
+      } else {
+        return usage();
+      }
+    }
+    if (kinds.empty()) {
+      kinds.assign(utils::corpus::all_kinds.begin(), utils::corpus::all_kinds.end());
+    }
+
+    for (auto kind : kinds) {
+      auto const start = std::chrono::steady_clock::now();
+      auto const path = utils::corpus::write(dir, kind, size, seed);
+      auto const elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+      std::cout << path.string() << " (" << size << " bytes, " << elapsed.count() << " ms)" << std::endl;
+    }
+  } catch (std::exception const &e) {
+    std::cerr << "corpus_gen: " << e.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
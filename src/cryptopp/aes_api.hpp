@@ -3,23 +3,54 @@
 #include <cryptopp/cryptlib.h>
 #include <cryptopp/files.h>
 #include <cryptopp/filters.h>
+#include <cryptopp/gcm.h>
 #include <cryptopp/hex.h>
 #include <cryptopp/modes.h>
 #include <cryptopp/osrng.h>
 #include <cryptopp/rijndael.h>
 
+#include <algorithm>
 #include <cstddef>
+#include <future>
 #include <iostream>
 #include <string>
 #include <vector>
 
+#include "../thread_pool.hpp"
+
 namespace cryptopp {
 using byte_t = std::uint8_t;
 using buffer_t = std::vector<byte_t>;
 using string_t = std::string;
 using size_buffer_t = std::size_t;
 
-size_t GetCipherLen(size_t plain_len) {
+// GCM: 96-bit IV (the fast path of the spec), 128-bit tag appended to the ciphertext
+inline constexpr size_t GCM_IV_LENGTH = 12;
+inline constexpr size_t GCM_TAG_LENGTH = 16;
+
+namespace detail {
+inline void CheckKeyIv(const buffer_t &key, const buffer_t &iv,
+                       size_t iv_len = CryptoPP::AES::BLOCKSIZE) {
+  if (key.size() != CryptoPP::AES::MAX_KEYLENGTH)
+    throw CryptoPP::InvalidArgument("key size incorrect");
+  if (iv.size() != iv_len)
+    throw CryptoPP::InvalidArgument("iv size incorrect");
+}
+
+/// Length of the data in the decrypted last block, whose PKCS #7 padding is checked
+inline size_t UnpaddedLength(const byte_t *last_block) {
+  using namespace CryptoPP;
+  size_t const pad = last_block[AES::BLOCKSIZE - 1];
+  bool valid = pad >= 1 && pad <= AES::BLOCKSIZE;
+  for (size_t i = AES::BLOCKSIZE - pad; valid && i < AES::BLOCKSIZE; ++i)
+    valid = last_block[i] == pad;
+  if (!valid)
+    throw InvalidCiphertext("invalid PKCS #7 block padding found");
+  return AES::BLOCKSIZE - pad;
+}
+} // namespace detail
+
+inline size_t GetCipherLen(size_t plain_len) {
   using namespace CryptoPP;
   // AES block size is 16 bytes
   const size_t block_size = AES::BLOCKSIZE;
@@ -29,14 +60,11 @@ size_t GetCipherLen(size_t plain_len) {
   return plain_len + padding_len;
 }
 
-bool AesCbcEncrypt(const buffer_t &key, const buffer_t &iv,
+inline bool AesCbcEncrypt(const buffer_t &key, const buffer_t &iv,
                    const buffer_t &plain, buffer_t &cipher) {
   using namespace CryptoPP;
   try {
-    if (key.size() != AES::MAX_KEYLENGTH)
-      throw std::runtime_error("key size incorrect");
-    if (iv.size() != AES::BLOCKSIZE)
-      throw std::runtime_error("iv size incorrect");
+    detail::CheckKeyIv(key, iv);
 
     CBC_Mode<AES>::Encryption e;
     e.SetKeyWithIV(key.data(), key.size(), iv.data());
@@ -54,14 +82,11 @@ bool AesCbcEncrypt(const buffer_t &key, const buffer_t &iv,
   }
 }
 
-bool AesCbcDecrypt(const buffer_t &key, const buffer_t &iv,
+inline bool AesCbcDecrypt(const buffer_t &key, const buffer_t &iv,
                    const buffer_t &cipher, buffer_t &plain) {
   using namespace CryptoPP;
   try {
-    if (key.size() != AES::MAX_KEYLENGTH)
-      throw std::runtime_error("key size incorrect");
-    if (iv.size() != AES::BLOCKSIZE)
-      throw std::runtime_error("iv size incorrect");
+    detail::CheckKeyIv(key, iv);
 
     CBC_Mode<AES>::Decryption d;
     d.SetKeyWithIV(key.data(), key.size(), iv.data());
@@ -78,4 +103,193 @@ bool AesCbcDecrypt(const buffer_t &key, const buffer_t &iv,
     return false;
   }
 }
+
+/// Multi-threaded AesCbcDecrypt(): each plain block only depends on two
+/// cipher blocks, so the cipher is split on block boundaries and every
+/// segment is decrypted on `pool` with the previous cipher block as its IV.
+/// The padding is checked and removed once all segments are done.
+/// `plain` is replaced (cleared on failure); `segment_size` 0 means one
+/// segment per thread (at least 1 MiB each).
+inline bool AesCbcDecryptParallel(
+    const buffer_t &key, const buffer_t &iv, const buffer_t &cipher,
+    buffer_t &plain,
+    ::utils::ThreadPool &pool = ::utils::ThreadPool::global(),
+    size_t segment_size = 0) {
+  using namespace CryptoPP;
+  constexpr size_t min_segment = size_t{1} << 20;
+  try {
+    detail::CheckKeyIv(key, iv);
+    if (cipher.empty() || cipher.size() % AES::BLOCKSIZE != 0)
+      throw InvalidCiphertext("ciphertext length is not a multiple of block size");
+    if (segment_size == 0)
+      segment_size = std::max(min_segment, cipher.size() / pool.size() + 1);
+    segment_size = (segment_size + AES::BLOCKSIZE - 1) / AES::BLOCKSIZE * AES::BLOCKSIZE;
+    if (cipher.size() <= segment_size) {
+      plain.clear();
+      if (!AesCbcDecrypt(key, iv, cipher, plain)) {
+        plain.clear(); // VectorSink keeps what came before the bad padding
+        return false;
+      }
+      return true;
+    }
+
+    plain.resize(cipher.size());
+    std::vector<std::future<void>> segments{};
+    for (size_t offset = 0; offset < cipher.size(); offset += segment_size) {
+      size_t const length = std::min(segment_size, cipher.size() - offset);
+      segments.push_back(pool.submit([&key, &iv, &cipher, &plain, offset, length] {
+        const byte_t *chain = offset == 0 ? iv.data() : cipher.data() + offset - AES::BLOCKSIZE;
+        CBC_Mode<AES>::Decryption d;
+        d.SetKeyWithIV(key.data(), key.size(), chain);
+        d.ProcessData(plain.data() + offset, cipher.data() + offset, length);
+      }));
+    }
+    // all of them, before any get() may throw: the tasks use the buffers
+    for (auto &segment : segments)
+      segment.wait();
+    for (auto &segment : segments)
+      segment.get();
+
+    size_t const last = plain.size() - AES::BLOCKSIZE;
+    plain.resize(last + detail::UnpaddedLength(plain.data() + last));
+    return true;
+  } catch (const Exception &e) {
+    std::cerr << e.what() << std::endl;
+    plain.clear();
+    return false;
+  }
+}
+
+/* CTR mode: a keystream of AES(counter), counter = iv, iv + 1, ...
+ * No padding (the cipher is as long as the plain text), and any 16-byte
+ * aligned range can be processed on its own: see AesCtrEncryptParallel().
+ * Never reuse a (key, iv) pair.
+ */
+inline bool AesCtrEncrypt(const buffer_t &key, const buffer_t &iv,
+                          const buffer_t &plain, buffer_t &cipher) {
+  using namespace CryptoPP;
+  try {
+    detail::CheckKeyIv(key, iv);
+
+    CTR_Mode<AES>::Encryption e;
+    e.SetKeyWithIV(key.data(), key.size(), iv.data());
+    cipher.resize(plain.size());
+    e.ProcessData(cipher.data(), plain.data(), plain.size());
+    return true;
+  } catch (const Exception &e) {
+    std::cerr << e.what() << std::endl;
+    return false;
+  }
+}
+
+/// CTR decryption is the same operation as encryption
+inline bool AesCtrDecrypt(const buffer_t &key, const buffer_t &iv,
+                          const buffer_t &cipher, buffer_t &plain) {
+  return AesCtrEncrypt(key, iv, cipher, plain);
+}
+
+/// Multi-threaded AesCtrEncrypt(): the input is split into counter ranges,
+/// each one processed on `pool` from its own Seek()-ed position.
+/// Same output as AesCtrEncrypt(); `segment_size` 0 means one segment per
+/// thread (at least 1 MiB each).
+inline bool AesCtrEncryptParallel(
+    const buffer_t &key, const buffer_t &iv, const buffer_t &plain,
+    buffer_t &cipher,
+    ::utils::ThreadPool &pool = ::utils::ThreadPool::global(),
+    size_t segment_size = 0) {
+  using namespace CryptoPP;
+  constexpr size_t min_segment = size_t{1} << 20;
+  try {
+    detail::CheckKeyIv(key, iv);
+    if (segment_size == 0)
+      segment_size = std::max(min_segment, plain.size() / pool.size() + 1);
+    // whole blocks, so that every segment starts on a counter value
+    segment_size = (segment_size + AES::BLOCKSIZE - 1) / AES::BLOCKSIZE * AES::BLOCKSIZE;
+    if (plain.size() <= segment_size)
+      return AesCtrEncrypt(key, iv, plain, cipher);
+
+    cipher.resize(plain.size());
+    std::vector<std::future<void>> segments{};
+    for (size_t offset = 0; offset < plain.size(); offset += segment_size) {
+      size_t const length = std::min(segment_size, plain.size() - offset);
+      segments.push_back(pool.submit([&key, &iv, &plain, &cipher, offset, length] {
+        CTR_Mode<AES>::Encryption e;
+        e.SetKeyWithIV(key.data(), key.size(), iv.data());
+        e.Seek(offset);
+        e.ProcessData(cipher.data() + offset, plain.data() + offset, length);
+      }));
+    }
+    // all of them, before any get() may throw: the tasks use the buffers
+    for (auto &segment : segments)
+      segment.wait();
+    for (auto &segment : segments)
+      segment.get();
+    return true;
+  } catch (const Exception &e) {
+    std::cerr << e.what() << std::endl;
+    return false;
+  }
+}
+
+inline bool AesCtrDecryptParallel(
+    const buffer_t &key, const buffer_t &iv, const buffer_t &cipher,
+    buffer_t &plain,
+    ::utils::ThreadPool &pool = ::utils::ThreadPool::global(),
+    size_t segment_size = 0) {
+  return AesCtrEncryptParallel(key, iv, cipher, plain, pool, segment_size);
+}
+
+/* GCM mode: CTR encryption and authentication in the same pass.
+ * `cipher` is the cipher text followed by a GCM_TAG_LENGTH tag, which also
+ * covers `aad` (authenticated, not encrypted data, e.g. a header). The iv
+ * is GCM_IV_LENGTH bytes and must never be reused with the same key.
+ */
+inline bool AesGcmEncrypt(const buffer_t &key, const buffer_t &iv,
+                          const buffer_t &plain, buffer_t &cipher,
+                          const buffer_t &aad = {}) {
+  using namespace CryptoPP;
+  try {
+    detail::CheckKeyIv(key, iv, GCM_IV_LENGTH);
+
+    GCM<AES>::Encryption e;
+    e.SetKeyWithIV(key.data(), key.size(), iv.data(), iv.size());
+    cipher.resize(plain.size() + GCM_TAG_LENGTH);
+    e.EncryptAndAuthenticate(cipher.data(), cipher.data() + plain.size(),
+                             GCM_TAG_LENGTH, iv.data(), static_cast<int>(iv.size()),
+                             aad.data(), aad.size(), plain.data(), plain.size());
+    return true;
+  } catch (const Exception &e) {
+    std::cerr << e.what() << std::endl;
+    return false;
+  }
+}
+
+/// False (and `plain` empty) if the tag does not match: wrong key, iv or aad, or modified data
+inline bool AesGcmDecrypt(const buffer_t &key, const buffer_t &iv,
+                          const buffer_t &cipher, buffer_t &plain,
+                          const buffer_t &aad = {}) {
+  using namespace CryptoPP;
+  try {
+    detail::CheckKeyIv(key, iv, GCM_IV_LENGTH);
+    if (cipher.size() < GCM_TAG_LENGTH)
+      throw InvalidArgument("cipher shorter than the tag");
+
+    GCM<AES>::Decryption d;
+    d.SetKeyWithIV(key.data(), key.size(), iv.data(), iv.size());
+    size_t const plain_len = cipher.size() - GCM_TAG_LENGTH;
+    plain.resize(plain_len);
+    if (!d.DecryptAndVerify(plain.data(), cipher.data() + plain_len,
+                            GCM_TAG_LENGTH, iv.data(), static_cast<int>(iv.size()),
+                            aad.data(), aad.size(), cipher.data(), plain_len)) {
+      plain.clear();
+      std::cerr << "AES/GCM: message authentication failed" << std::endl;
+      return false;
+    }
+    return true;
+  } catch (const Exception &e) {
+    plain.clear();
+    std::cerr << e.what() << std::endl;
+    return false;
+  }
+}
 } // namespace cryptopp
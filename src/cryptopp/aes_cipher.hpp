@@ -0,0 +1,125 @@
+#pragma once
+
+#include <cryptopp/cryptlib.h>
+#include <cryptopp/modes.h>
+#include <cryptopp/rijndael.h>
+
+#include <cstddef>
+#include <cstring>
+#include <span>
+
+#include "aes_api.hpp"
+
+namespace cryptopp {
+
+/// One message of a batch: `output` must be presized (see AesCipher)
+struct AesMessage {
+  const byte_t *iv;              ///< AES::BLOCKSIZE bytes
+  std::span<const byte_t> input; ///< plain text to encrypt, or cipher text to decrypt
+  std::span<byte_t> output;      ///< destination, not resized
+  size_t size = 0;               ///< bytes written to `output`
+};
+
+/* AES-CBC (PKCS #7 padding) for many small messages under one key
+ *
+ * Same output as AesCbcEncrypt / AesCbcDecrypt, but the key schedule is
+ * expanded once in the constructor: each message only resynchronizes the
+ * IV, and is processed straight into a caller buffer (no filter chain, no
+ * allocation). Errors throw CryptoPP::Exception (InvalidArgument,
+ * InvalidCiphertext).
+ *
+ * Not thread-safe: use one AesCipher per thread.
+ */
+class AesCipher {
+public:
+  explicit AesCipher(const buffer_t &key) {
+    using namespace CryptoPP;
+    if (key.size() != AES::MAX_KEYLENGTH)
+      throw InvalidArgument("key size incorrect");
+    byte_t const zero_iv[AES::BLOCKSIZE] = {};
+    encryption_.SetKeyWithIV(key.data(), key.size(), zero_iv);
+    decryption_.SetKeyWithIV(key.data(), key.size(), zero_iv);
+  }
+
+  /// Encrypt `plain` into `cipher` (at least GetCipherLen(plain.size()) bytes); returns the cipher length
+  size_t encrypt(const byte_t *iv, std::span<const byte_t> plain,
+                 std::span<byte_t> cipher) {
+    using namespace CryptoPP;
+    size_t const cipher_len = GetCipherLen(plain.size());
+    if (cipher.size() < cipher_len)
+      throw InvalidArgument("AesCipher: cipher buffer too small");
+
+    encryption_.Resynchronize(iv);
+    size_t const full = plain.size() / AES::BLOCKSIZE * AES::BLOCKSIZE;
+    if (full > 0)
+      encryption_.ProcessData(cipher.data(), plain.data(), full);
+
+    // last block: the remaining bytes, and PKCS #7 padding (1 to 16 bytes)
+    byte_t last[AES::BLOCKSIZE];
+    size_t const rest = plain.size() - full;
+    if (rest > 0)
+      std::memcpy(last, plain.data() + full, rest);
+    std::memset(last + rest, static_cast<int>(AES::BLOCKSIZE - rest),
+                AES::BLOCKSIZE - rest);
+    encryption_.ProcessData(cipher.data() + full, last, AES::BLOCKSIZE);
+    return cipher_len;
+  }
+
+  /// Decrypt `cipher` into `plain` (at least cipher.size() - 1 bytes); returns the plain length
+  size_t decrypt(const byte_t *iv, std::span<const byte_t> cipher,
+                 std::span<byte_t> plain) {
+    using namespace CryptoPP;
+    if (cipher.empty() || cipher.size() % AES::BLOCKSIZE != 0)
+      throw InvalidCiphertext("AesCipher: cipher length is not a multiple of the block size");
+
+    decryption_.Resynchronize(iv);
+    size_t const full = cipher.size() - AES::BLOCKSIZE;
+    if (plain.size() < full)
+      throw InvalidArgument("AesCipher: plain buffer too small");
+    if (full > 0)
+      decryption_.ProcessData(plain.data(), cipher.data(), full);
+
+    byte_t last[AES::BLOCKSIZE];
+    decryption_.ProcessData(last, cipher.data() + full, AES::BLOCKSIZE);
+    size_t const rest = detail::UnpaddedLength(last);
+    if (plain.size() < full + rest)
+      throw InvalidArgument("AesCipher: plain buffer too small");
+    std::memcpy(plain.data() + full, last, rest);
+    return full + rest;
+  }
+
+  /// Value-semantics versions, like AesCbcEncrypt / AesCbcDecrypt (`out` is resized)
+  void encrypt(const buffer_t &iv, const buffer_t &plain, buffer_t &cipher) {
+    check_iv(iv);
+    cipher.resize(GetCipherLen(plain.size()));
+    encrypt(iv.data(), plain, cipher);
+  }
+
+  void decrypt(const buffer_t &iv, const buffer_t &cipher, buffer_t &plain) {
+    check_iv(iv);
+    plain.resize(cipher.size());
+    plain.resize(decrypt(iv.data(), cipher, std::span<byte_t>(plain)));
+  }
+
+  /// Encrypt every message (each with its own IV) into its presized output
+  void encrypt_batch(std::span<AesMessage> messages) {
+    for (auto &message : messages)
+      message.size = encrypt(message.iv, message.input, message.output);
+  }
+
+  void decrypt_batch(std::span<AesMessage> messages) {
+    for (auto &message : messages)
+      message.size = decrypt(message.iv, message.input, message.output);
+  }
+
+private:
+  static void check_iv(const buffer_t &iv) {
+    if (iv.size() != CryptoPP::AES::BLOCKSIZE)
+      throw CryptoPP::InvalidArgument("iv size incorrect");
+  }
+
+  CryptoPP::CBC_Mode<CryptoPP::AES>::Encryption encryption_{};
+  CryptoPP::CBC_Mode<CryptoPP::AES>::Decryption decryption_{};
+};
+
+} // namespace cryptopp
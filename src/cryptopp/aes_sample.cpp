@@ -54,13 +54,16 @@ int main(int argc, const char **argv) {
   if (argc > 1) {
     // コマンドライン引数がある場合は、argv[1] をファイル名として読み込む.
     std::string filename = argv[1];
-    std::ifstream ifs(filename);
+    std::ifstream ifs(filename, std::ios::binary | std::ios::ate);
     if (!ifs) {
       utils::PrintLn("failed to open file: {}", filename);
       return 1;
     }
-    plain = std::vector<byte>((std::istreambuf_iterator<char>(ifs)),
-                              std::istreambuf_iterator<char>());
+    // one read of the whole file (for large files, see cryptopp::stream in aes_stream.hpp)
+    plain.resize(static_cast<size_t>(ifs.tellg()));
+    ifs.seekg(0);
+    ifs.read(reinterpret_cast<char *>(plain.data()),
+             static_cast<std::streamsize>(plain.size()));
     utils::PrintLn("read {:L} bytes from {}", plain.size(), filename);
   } else {
     std::string plain_txt = "CBC Mode Test for pipeline processing";
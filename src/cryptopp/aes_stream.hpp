@@ -0,0 +1,135 @@
+#pragma once
+
+#include <cryptopp/cryptlib.h>
+#include <cryptopp/files.h>
+#include <cryptopp/filters.h>
+#include <cryptopp/modes.h>
+#include <cryptopp/rijndael.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+#include "aes_api.hpp"
+
+/* Streaming AES-CBC: istream -> StreamTransformationFilter -> FileSink(ostream)
+ *
+ * The input is read in chunks of `chunk_size` bytes into one reusable
+ * buffer and put into a single filter, which keeps the CBC chaining (and
+ * the PKCS #7 padding) across chunks: memory stays bounded by the chunk
+ * and the filter's buffers whatever the input size, and the output is the
+ * same as AesCbcEncrypt / AesCbcDecrypt on the whole input.
+ */
+namespace cryptopp {
+namespace stream {
+
+inline constexpr size_t default_chunk_size = size_t{1} << 18;
+
+namespace detail {
+
+/// Pump `in` through `filter` (which writes to the output) chunk by chunk
+inline void Pump(std::istream &in, CryptoPP::BufferedTransformation &filter,
+                 size_t chunk_size) {
+  buffer_t chunk(std::max<size_t>(chunk_size, 1));
+  for (;;) {
+    in.read(reinterpret_cast<char *>(chunk.data()),
+            static_cast<std::streamsize>(chunk.size()));
+    if (in.bad())
+      throw std::runtime_error("read failed");
+    auto const read = static_cast<size_t>(in.gcount());
+    if (read > 0)
+      filter.Put(chunk.data(), read);
+    if (read < chunk.size())
+      break;
+  }
+  filter.MessageEnd();
+}
+
+} // namespace detail
+
+inline bool encrypt(std::istream &in, std::ostream &out, const buffer_t &key,
+                    const buffer_t &iv,
+                    size_t chunk_size = default_chunk_size) {
+  using namespace CryptoPP;
+  if (!in) {
+    std::cerr << "input stream is not readable" << std::endl;
+    return false;
+  }
+  try {
+    ::cryptopp::detail::CheckKeyIv(key, iv);
+
+    CBC_Mode<AES>::Encryption e;
+    e.SetKeyWithIV(key.data(), key.size(), iv.data());
+    StreamTransformationFilter encryptor(e, new FileSink(out));
+    detail::Pump(in, encryptor, chunk_size);
+    return true;
+  } catch (const Exception &e) {
+    std::cerr << e.what() << std::endl;
+    return false;
+  } catch (const std::exception &e) {
+    std::cerr << e.what() << std::endl;
+    return false;
+  }
+}
+
+/// On failure (e.g. wrong key: bad padding), part of the output may already be written
+inline bool decrypt(std::istream &in, std::ostream &out, const buffer_t &key,
+                    const buffer_t &iv,
+                    size_t chunk_size = default_chunk_size) {
+  using namespace CryptoPP;
+  if (!in) {
+    std::cerr << "input stream is not readable" << std::endl;
+    return false;
+  }
+  try {
+    ::cryptopp::detail::CheckKeyIv(key, iv);
+
+    CBC_Mode<AES>::Decryption d;
+    d.SetKeyWithIV(key.data(), key.size(), iv.data());
+    StreamTransformationFilter decryptor(d, new FileSink(out));
+    detail::Pump(in, decryptor, chunk_size);
+    return true;
+  } catch (const Exception &e) {
+    std::cerr << e.what() << std::endl;
+    return false;
+  } catch (const std::exception &e) {
+    std::cerr << e.what() << std::endl;
+    return false;
+  }
+}
+
+inline bool encrypt_file(const string_t &in, const string_t &out,
+                         const buffer_t &key, const buffer_t &iv,
+                         size_t chunk_size = default_chunk_size) {
+  std::ifstream in_file(in, std::ios::binary);
+  if (!in_file) { // before creating (truncating) the output
+    std::cerr << "failed to open " << in << std::endl;
+    return false;
+  }
+  std::ofstream out_file(out, std::ios::binary);
+  if (!out_file) {
+    std::cerr << "failed to open " << out << std::endl;
+    return false;
+  }
+  return encrypt(in_file, out_file, key, iv, chunk_size);
+}
+
+inline bool decrypt_file(const string_t &in, const string_t &out,
+                         const buffer_t &key, const buffer_t &iv,
+                         size_t chunk_size = default_chunk_size) {
+  std::ifstream in_file(in, std::ios::binary);
+  if (!in_file) { // before creating (truncating) the output
+    std::cerr << "failed to open " << in << std::endl;
+    return false;
+  }
+  std::ofstream out_file(out, std::ios::binary);
+  if (!out_file) {
+    std::cerr << "failed to open " << out << std::endl;
+    return false;
+  }
+  return decrypt(in_file, out_file, key, iv, chunk_size);
+}
+
+} // namespace stream
+} // namespace cryptopp
@@ -0,0 +1,217 @@
+#pragma once
+
+#include <cryptopp/cryptlib.h>
+#include <cryptopp/files.h>
+#include <cryptopp/filters.h>
+#include <cryptopp/modes.h>
+#include <cryptopp/rijndael.h>
+
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <streambuf>
+
+#include "../zstd/zstdpp.hpp"
+#include "aes_api.hpp"
+
+/* Fused compress-then-encrypt (zstd -> AES-CBC) and decrypt-then-decompress
+ *
+ *   istream -> zstd stream -> StreamTransformationFilter -> FileSink(ostream)
+ *   FileSource(istream) -> StreamTransformationFilter -> zstd sink -> ostream
+ *
+ * Each zstd output chunk goes straight into the cipher, and each decrypted
+ * chunk straight into the decompressor: memory stays bounded by a few zstd
+ * and cipher buffers whatever the input size. The output is the same as
+ * AesCbcEncrypt(zstdpp::stream::compress(...)), so both ways interoperate.
+ */
+namespace cryptopp {
+
+namespace detail {
+
+/// std::streambuf writing into a Crypto++ filter: lets zstdpp::stream write its output to a cipher
+class TransformationBuf : public std::streambuf {
+public:
+  explicit TransformationBuf(CryptoPP::BufferedTransformation &target)
+      : target_(target) {}
+
+protected:
+  std::streamsize xsputn(const char *s, std::streamsize n) override {
+    target_.Put(reinterpret_cast<const CryptoPP::byte *>(s),
+                static_cast<size_t>(n));
+    return n;
+  }
+  int_type overflow(int_type c) override {
+    if (!traits_type::eq_int_type(c, traits_type::eof())) {
+      target_.Put(static_cast<CryptoPP::byte>(c));
+    }
+    return traits_type::not_eof(c);
+  }
+
+private:
+  CryptoPP::BufferedTransformation &target_;
+};
+
+/// Crypto++ sink decompressing the zstd frames it receives into an ostream
+class ZstdDecompressSink : public CryptoPP::Bufferless<CryptoPP::Sink> {
+public:
+  ZstdDecompressSink(zstdpp::stream::Context &ctx, std::ostream &out)
+      : ctx_(ctx), out_(out) {
+    buffer_.resize(ZSTD_DStreamOutSize());
+  }
+
+  size_t Put2(const CryptoPP::byte *in, size_t length, int messageEnd,
+              bool /*blocking*/) override {
+    ZSTD_inBuffer input = {in, length, 0};
+    // a full output buffer may leave data in zstd even once the input is consumed
+    bool full = false;
+    while (input.pos < input.size || full) {
+      ZSTD_outBuffer output = {buffer_.data(), buffer_.size(), 0};
+      auto const consumed = input.pos;
+      auto const ret = ctx_(input, output);
+      if (ZSTD_isError(ret))
+        throw std::runtime_error(ZSTD_getErrorName(ret));
+      // nothing read nor written: only a hint for the next frame, the last one ended
+      if (input.pos != consumed || output.pos > 0)
+        lastRet_ = ret;
+      out_.write(reinterpret_cast<const char *>(buffer_.data()),
+                 static_cast<std::streamsize>(output.pos));
+      if (!out_)
+        throw std::runtime_error("write failed");
+      full = output.pos == output.size;
+    }
+    if (messageEnd && lastRet_ != 0)
+      throw std::runtime_error("truncated zstd frame");
+    return 0; // everything processed
+  }
+
+private:
+  zstdpp::stream::Context &ctx_;
+  std::ostream &out_;
+  zstdpp::buffer_t buffer_{};
+  size_t lastRet_{0};
+};
+
+/// Run `compress(ostream&)` with its output encrypted into `out`
+template <typename Compress>
+bool CompressEncrypt(const buffer_t &key, const buffer_t &iv,
+                     std::ostream &out, Compress &&compress) {
+  using namespace CryptoPP;
+  try {
+    CheckKeyIv(key, iv);
+
+    CBC_Mode<AES>::Encryption e;
+    e.SetKeyWithIV(key.data(), key.size(), iv.data());
+    StreamTransformationFilter encryptor(e, new FileSink(out));
+
+    TransformationBuf buf(encryptor);
+    std::ostream compressed(&buf);
+    // the filter's exceptions must not be swallowed by the ostream
+    compressed.exceptions(std::ios::badbit);
+    compress(compressed);
+    encryptor.MessageEnd();
+    return true;
+  } catch (const Exception &e) {
+    std::cerr << e.what() << std::endl;
+    return false;
+  } catch (const std::exception &e) {
+    std::cerr << e.what() << std::endl;
+    return false;
+  }
+}
+
+} // namespace detail
+
+/// Compress `in` with `ctx` (a compression context) and encrypt it to `out`
+inline bool CompressEncrypt(zstdpp::stream::Context &ctx, std::istream &in,
+                            std::ostream &out, const buffer_t &key,
+                            const buffer_t &iv) {
+  return detail::CompressEncrypt(key, iv, out, [&](std::ostream &compressed) {
+    zstdpp::stream::compress(ctx, in, compressed);
+  });
+}
+
+inline bool CompressEncrypt(std::istream &in, std::ostream &out,
+                            const buffer_t &key, const buffer_t &iv,
+                            zstdpp::compress_level_t compress_level = 3,
+                            zstdpp::threads_number_t nThreads = 1) {
+  try {
+    zstdpp::stream::Context ctx(compress_level, nThreads);
+    return CompressEncrypt(ctx, in, out, key, iv);
+  } catch (const std::exception &e) {
+    std::cerr << e.what() << std::endl;
+    return false;
+  }
+}
+
+/// Decrypt `in` and decompress it with `ctx` (a decompression context) to `out`
+inline bool DecryptDecompress(zstdpp::stream::Context &ctx, std::istream &in,
+                              std::ostream &out, const buffer_t &key,
+                              const buffer_t &iv) {
+  using namespace CryptoPP;
+  try {
+    detail::CheckKeyIv(key, iv);
+
+    CBC_Mode<AES>::Decryption d;
+    d.SetKeyWithIV(key.data(), key.size(), iv.data());
+
+    FileSource s(in, true,
+                 new StreamTransformationFilter(
+                     d,
+                     new detail::ZstdDecompressSink(ctx, out)) // StreamTransformationFilter
+    );                                                         // FileSource
+    return true;
+  } catch (const Exception &e) {
+    std::cerr << e.what() << std::endl;
+    return false;
+  } catch (const std::exception &e) {
+    std::cerr << e.what() << std::endl;
+    return false;
+  }
+}
+
+inline bool DecryptDecompress(std::istream &in, std::ostream &out,
+                              const buffer_t &key, const buffer_t &iv) {
+  try {
+    zstdpp::stream::Context ctx{};
+    return DecryptDecompress(ctx, in, out, key, iv);
+  } catch (const std::exception &e) {
+    std::cerr << e.what() << std::endl;
+    return false;
+  }
+}
+
+/// File versions: streamed through fixed-size buffers (no mapping, so the RSS stays small too)
+inline bool CompressEncryptFile(const string_t &in, const string_t &out,
+                                const buffer_t &key, const buffer_t &iv,
+                                zstdpp::compress_level_t compress_level = 3,
+                                zstdpp::threads_number_t nThreads = 1) {
+  std::ifstream in_file(in, std::ios::binary);
+  if (!in_file) { // before creating (truncating) the output
+    std::cerr << "failed to open " << in << std::endl;
+    return false;
+  }
+  std::ofstream out_file(out, std::ios::binary);
+  if (!out_file) {
+    std::cerr << "failed to open " << out << std::endl;
+    return false;
+  }
+  return CompressEncrypt(in_file, out_file, key, iv, compress_level, nThreads);
+}
+
+inline bool DecryptDecompressFile(const string_t &in, const string_t &out,
+                                  const buffer_t &key, const buffer_t &iv) {
+  std::ifstream in_file(in, std::ios::binary);
+  if (!in_file) { // before creating (truncating) the output
+    std::cerr << "failed to open " << in << std::endl;
+    return false;
+  }
+  std::ofstream out_file(out, std::ios::binary);
+  if (!out_file) {
+    std::cerr << "failed to open " << out << std::endl;
+    return false;
+  }
+  return DecryptDecompress(in_file, out_file, key, iv);
+}
+
+} // namespace cryptopp
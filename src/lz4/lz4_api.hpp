@@ -1,44 +1,182 @@
 #pragma once
 
+#include <algorithm>
+#include <cstddef>
 #include <cstdint>
 #include <iostream>
+#include <span>
+#include <stdexcept>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "lz4.h"
+#include "lz4hc.h"
+
+#include "../byte_buffer.hpp"
 
 namespace lz4 {
     using byte_t = std::uint8_t;
-    using compress_level_t = std::uint8_t;
+    using compress_level_t = int;
     using threads_number_t = std::uint8_t;
-    using buffer_t = std::vector<byte_t>;
+    using buffer_t = ::utils::byte_buffer; // std::vector without zero-fill on resize()
     using string_t = std::string;
     using size_buffer_t = std::size_t;
+    using rospan_t = std::span<const std::byte>;
+    using span_t = std::span<std::byte>;
+
+    /* Compression levels
+     *   <= -1 : fast mode with acceleration = -level (faster, lower ratio)
+     *   0 .. 2: fast mode (LZ4_compress_default equivalent)
+     *   3 ..12: high compression mode (LZ4HC), slower compression, same decoding speed
+     */
+    inline constexpr compress_level_t default_level = 1;
+    inline constexpr compress_level_t hc_min_level = LZ4HC_CLEVEL_MIN;
+    inline constexpr compress_level_t max_level = LZ4HC_CLEVEL_MAX;
+
+    enum class Error {
+        none,
+        src_too_large,  ///< larger than LZ4_MAX_INPUT_SIZE
+        dst_too_small,
+        src_corrupted,  ///< malformed input, or `dst` too small to hold it
+        header_invalid, ///< not an envelope (see lz4_envelope.hpp), or unsupported flags
+        checksum_mismatch,
+    };
+
+    /* Result of the non-allocating functions: a size, or an error.
+     * (subset of C++23 `std::expected<size_buffer_t, Error>`)
+     */
+    class Result {
+      public:
+        Result(size_buffer_t size) noexcept : size_(size) {}
+
+        static Result failure(Error error) noexcept {
+            Result r{0};
+            r.error_ = error;
+            return r;
+        }
+
+        bool has_value() const noexcept { return error_ == Error::none; }
+        explicit operator bool() const noexcept { return has_value(); }
+        size_buffer_t operator*() const noexcept { return size_; }
+        Error error() const noexcept { return error_; }
+
+        char const* message() const noexcept {
+            switch (error_) {
+                case Error::none: return "No error detected";
+                case Error::src_too_large: return "Source size is too large";
+                case Error::dst_too_small: return "Destination buffer is too small";
+                case Error::src_corrupted: return "Data corruption detected";
+                case Error::header_invalid: return "Unknown or unsupported header";
+                case Error::checksum_mismatch: return "Checksum mismatch";
+            }
+            return "Unspecified error code";
+        }
+
+        /// The size, or throws std::runtime_error on error.
+        size_buffer_t value() const {
+            if (!has_value()) {
+                throw std::runtime_error(message());
+            }
+            return size_;
+        }
+
+      private:
+        size_buffer_t size_;
+        Error error_{Error::none};
+    };
+
+    namespace utils {
+        using ::utils::as_bytes;
+        using ::utils::as_writable_bytes;
+    } // namespace utils
+
+    /* Non-allocating functions on caller-owned buffers
+     *
+     * `dst` must hold compress_bound(src.size()) bytes for compression (less
+     * may fail with dst_too_small), and the original size for decompression.
+     */
+
+    inline size_buffer_t compress_bound(size_buffer_t src_size) noexcept {
+        return src_size > LZ4_MAX_INPUT_SIZE ? 0 : (size_buffer_t)LZ4_compressBound((int)src_size);
+    }
+
+    namespace detail {
+        /// Per-thread compression state, allocated once (instead of a fresh stack state per call)
+        template <bool HighCompression>
+        inline void* thread_state(){
+            thread_local ::utils::aligned_byte_buffer<64> state(
+                (size_buffer_t)(HighCompression ? LZ4_sizeofStateHC() : LZ4_sizeofState()));
+            return state.data();
+        }
+    } // namespace detail
+
+    inline Result compress_into(rospan_t src, span_t dst, compress_level_t compress_level = default_level) {
+        if (src.size() > LZ4_MAX_INPUT_SIZE) {
+            return Result::failure(Error::src_too_large);
+        }
+        const int dst_capacity = (int)std::min<size_buffer_t>(dst.size(), LZ4_MAX_INPUT_SIZE);
+        const int compress_size = compress_level >= hc_min_level
+            ? LZ4_compress_HC_extStateHC(
+                detail::thread_state<true>(),
+                (const char*)src.data(),
+                (char*)dst.data(),
+                (int)src.size(),
+                dst_capacity,
+                std::min(compress_level, max_level))
+            : LZ4_compress_fast_extState(
+                detail::thread_state<false>(),
+                (const char*)src.data(),
+                (char*)dst.data(),
+                (int)src.size(),
+                dst_capacity,
+                compress_level < 0 ? -compress_level : 1);
+        if (compress_size <= 0) {
+            return Result::failure(Error::dst_too_small);
+        }
+        return Result((size_buffer_t)compress_size);
+    }
+
+    inline Result compress_into(std::string_view src, span_t dst, compress_level_t compress_level = default_level) {
+        return compress_into(utils::as_bytes(src), dst, compress_level);
+    }
+
+    inline Result decompress_into(rospan_t src, span_t dst) noexcept {
+        if (src.size() > LZ4_MAX_INPUT_SIZE) {
+            return Result::failure(Error::src_too_large);
+        }
+        const int decomp_size = LZ4_decompress_safe(
+            (const char*)src.data(),
+            (char*)dst.data(),
+            (int)src.size(),
+            (int)std::min<size_buffer_t>(dst.size(), INT32_MAX)
+        );
+        if (decomp_size < 0) {
+            return Result::failure(Error::src_corrupted);
+        }
+        return Result((size_buffer_t)decomp_size);
+    }
+
+    /* Vector functions (on top of the non-allocating functions) */
 
     inline size_buffer_t compress(
         const buffer_t& src,
         buffer_t& dst,
-        compress_level_t compress_level = 3
+        compress_level_t compress_level = default_level
     ) {
-        const int max_dst_size = LZ4_compressBound((int)src.size());
-        dst.resize(max_dst_size);
-
-        const int compress_size = LZ4_compress_default(
-            (const char*)src.data(), 
-            (char*)dst.data(), 
-            (int)src.size(), 
-            max_dst_size
-        );
+        dst.resize(compress_bound(src.size()));
 
-        if (compress_size <= 0) {
-            std::cerr << "LZ4_compress_default() failed with code: " << compress_size << '\n';
+        const auto result = compress_into(utils::as_bytes(src), utils::as_writable_bytes(dst), compress_level);
+
+        if (!result) {
+            std::cerr << "LZ4 compression failed: " << result.message() << '\n';
             // Compression failed
             dst.clear();
             return 0;
         }
 
-        dst.resize(compress_size);
-        dst.shrink_to_fit();
+        dst.resize(*result);
+        dst.shrink_to_fit(); // callers keep one buffer per result
         return dst.size();
     }
     
@@ -49,27 +187,22 @@ namespace lz4 {
         // Here we assume the original size is known or fixed for simplicity.
         dst.resize(original_size);
 
-        const int decomp_size = LZ4_decompress_safe(
-            (const char*)src.data(), 
-            (char*)dst.data(), 
-            (int)src.size(), 
-            (int)original_size
-        );
+        const auto result = decompress_into(utils::as_bytes(src), utils::as_writable_bytes(dst));
         
-        if (decomp_size < 0) {
-            std::cerr << "LZ4_decompress_safe() failed with code: " << decomp_size << '\n';
+        if (!result) {
+            std::cerr << "LZ4_decompress_safe() failed: " << result.message() << '\n';
             // Decompression failed
             dst.clear();
             return 0;
         }
-        else if ((size_buffer_t)decomp_size != original_size) {
+        const size_buffer_t decomp_size = *result;
+        if (decomp_size != original_size) {
             std::cerr << "Warning: Decompressed size (" << decomp_size 
                       << ") does not match the expected original size (" 
                       << original_size << ").\n";
         }
 
         dst.resize(decomp_size);
-        dst.shrink_to_fit();
         return dst.size();
     }
 } // namespace lz4
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <stdexcept>
+
+#include "../batch.hpp"
+#include "../thread_pool.hpp"
+#include "lz4_api.hpp"
+
+/* Batches of small records
+ *
+ * compress() per record fills one output vector per record. compress_batch
+ * writes the LZ4 blocks back to back into a single utils::Batch arena, each
+ * thread using its own compression state (see compress_into):
+ *
+ *   std::vector<lz4::rospan_t> records = ...;
+ *   lz4::Batch packed{}, unpacked{};
+ *   lz4::compress_batch(records, packed);
+ *   lz4::decompress_batch(packed, sizes, unpacked);   // sizes[i] == records[i].size()
+ *
+ * As with single blocks, the original sizes are not stored: the caller
+ * keeps them (Batch::sizes() of an input batch). Reusing the output Batch
+ * across calls keeps its capacity: in steady state nothing is allocated.
+ * With a thread pool, sub-batches of at least `min_records` records run
+ * concurrently (see utils::batch). Errors throw std::runtime_error and
+ * leave the output empty.
+ */
+namespace lz4 {
+
+    using Batch = ::utils::Batch;
+
+    inline void compress_batch(
+        std::span<rospan_t const> inputs,
+        Batch& out,
+        compress_level_t compress_level = default_level,
+        ::utils::ThreadPool* threads = nullptr,
+        size_buffer_t min_records = ::utils::batch::default_min_records
+    ){
+        ::utils::batch::transform(inputs.size(), out,
+            [&](size_buffer_t i){ return compress_bound(inputs[i].size()); },
+            [&](size_buffer_t first, size_buffer_t last, span_t region, size_buffer_t* sizes){
+                size_buffer_t used = 0;
+                for (auto i = first; i < last; ++i) {
+                    auto const size = compress_into(inputs[i], region.subspan(used), compress_level).value();
+                    sizes[i - first] = size;
+                    used += size;
+                }
+                return used;
+            },
+            threads, min_records);
+    }
+
+    /// `original_sizes[i]`: the size of record i before compression
+    inline void decompress_batch(
+        std::span<rospan_t const> inputs,
+        std::span<size_buffer_t const> original_sizes,
+        Batch& out,
+        ::utils::ThreadPool* threads = nullptr,
+        size_buffer_t min_records = ::utils::batch::default_min_records
+    ){
+        if (original_sizes.size() != inputs.size()) {
+            throw std::invalid_argument("lz4::decompress_batch: one original size per record");
+        }
+        ::utils::batch::transform(inputs.size(), out,
+            [&](size_buffer_t i){
+                if (original_sizes[i] > LZ4_MAX_INPUT_SIZE || original_sizes[i] > inputs[i].size() * 255 + 16) {
+                    throw std::runtime_error("lz4::decompress_batch: original size larger than the block can produce");
+                }
+                return original_sizes[i];
+            },
+            [&](size_buffer_t first, size_buffer_t last, span_t region, size_buffer_t* sizes){
+                size_buffer_t used = 0;
+                for (auto i = first; i < last; ++i) {
+                    auto const size = decompress_into(inputs[i], region.subspan(used)).value();
+                    if (size != sizes[i - first]) {
+                        throw std::runtime_error("lz4::decompress_batch: original size mismatch");
+                    }
+                    sizes[i - first] = size;
+                    used += size;
+                }
+                return used;
+            },
+            threads, min_records);
+    }
+
+    inline void decompress_batch(
+        Batch const& in,
+        std::span<size_buffer_t const> original_sizes,
+        Batch& out,
+        ::utils::ThreadPool* threads = nullptr
+    ){
+        auto const records = in.records();
+        decompress_batch(records, original_sizes, out, threads);
+    }
+
+} // namespace lz4
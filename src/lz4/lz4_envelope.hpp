@@ -0,0 +1,252 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+
+#include "lz4_api.hpp"
+#include "lz4_xxhash.hpp"
+
+/* Self-describing LZ4 block ("envelope")
+ *
+ * A raw LZ4 block does not store its original size, which callers have to
+ * keep aside. An envelope prefixes the block with a small header:
+ *
+ *   Flags (1) | Original_Size (varint, 1..10) | [XXH32 of the original data (4, LE)] | Payload
+ *
+ *   Flags : bits 0-1  codec (0: LZ4 block, 1: stored as is, for incompressible data,
+ *                              2: zstd frame, written by codec::auto_compress)
+ *           bit  2    checksum present
+ *           bits 3-4  reserved (0)
+ *           bits 5-7  version (1)
+ *
+ * Decoding sizes the destination exactly, and every error is reported in
+ * the returned Result (nothing is written to stderr). The functions below
+ * write LZ4 and stored payloads only, and reject zstd ones; codec_auto.hpp
+ * reads the same header and decodes the three codecs.
+ *
+ *   lz4::buffer_t packed, unpacked;
+ *   lz4::compress_framed(data, packed);
+ *   lz4::decompress_framed(packed, unpacked);
+ */
+namespace lz4 {
+namespace envelope {
+
+    inline constexpr byte_t codec_mask = 0x03;
+    inline constexpr byte_t codec_lz4 = 0x00;
+    inline constexpr byte_t codec_stored = 0x01;
+    inline constexpr byte_t codec_zstd = 0x02;
+    inline constexpr byte_t flag_checksum = 0x04;
+    inline constexpr byte_t reserved_mask = 0x18;
+    inline constexpr byte_t version = 1;
+    inline constexpr int version_shift = 5;
+
+    inline constexpr size_buffer_t max_varint_size = 10;
+    inline constexpr size_buffer_t max_header_size = 1 + max_varint_size + 4;
+
+    struct Header {
+        size_buffer_t original_size{0};
+        byte_t codec{codec_lz4};               ///< codec_stored: the payload is the original data
+        std::optional<std::uint32_t> checksum{};
+        size_buffer_t size{0};                 ///< size of the header itself
+    };
+
+    /// Size of the largest envelope for `src_size` bytes
+    inline size_buffer_t bound(size_buffer_t src_size) noexcept {
+        auto const block = compress_bound(src_size);
+        return block == 0 ? 0 : max_header_size + std::max(block, src_size);
+    }
+
+    inline size_buffer_t varint_size(std::uint64_t value) noexcept {
+        size_buffer_t size = 1;
+        for (; value >= 0x80; value >>= 7) {
+            ++size;
+        }
+        return size;
+    }
+
+    /// Write the header at the beginning of `dst` (which must hold header.size bytes)
+    inline void write_header(Header const& header, span_t dst) noexcept {
+        auto* p = reinterpret_cast<byte_t*>(dst.data());
+        *p++ = static_cast<byte_t>((version << version_shift)
+                                   | (header.codec & codec_mask)
+                                   | (header.checksum ? flag_checksum : 0));
+        std::uint64_t value = header.original_size;
+        for (; value >= 0x80; value >>= 7) {
+            *p++ = static_cast<byte_t>(value | 0x80);
+        }
+        *p++ = static_cast<byte_t>(value);
+        if (header.checksum) {
+            for (int shift = 0; shift < 32; shift += 8) {
+                *p++ = static_cast<byte_t>(*header.checksum >> shift);
+            }
+        }
+    }
+
+    /* Parse the header of the envelope `src`; returns the size of the header.
+     * The original size of a zstd payload is not checked against it here:
+     * its decoder compares it with the content size of the frame.
+     */
+    inline Result read_header(rospan_t src, Header& header) noexcept {
+        auto const* p = reinterpret_cast<byte_t const*>(src.data());
+        auto const* const end = p + src.size();
+        if (p == end) {
+            return Result::failure(Error::header_invalid);
+        }
+        auto const flags = *p++;
+        if ((flags >> version_shift) != version || (flags & reserved_mask) != 0
+                || (flags & codec_mask) > codec_zstd) {
+            return Result::failure(Error::header_invalid);
+        }
+
+        std::uint64_t value = 0;
+        for (int shift = 0;; shift += 7) {
+            if (p == end || shift >= 64) {
+                return Result::failure(Error::header_invalid);
+            }
+            auto const byte = *p++;
+            value |= std::uint64_t(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0) {
+                break;
+            }
+        }
+        header.original_size = static_cast<size_buffer_t>(value);
+        header.codec = static_cast<byte_t>(flags & codec_mask);
+        header.checksum.reset();
+        if (flags & flag_checksum) {
+            if (end - p < 4) {
+                return Result::failure(Error::header_invalid);
+            }
+            header.checksum = std::uint32_t(p[0]) | (std::uint32_t(p[1]) << 8)
+                            | (std::uint32_t(p[2]) << 16) | (std::uint32_t(p[3]) << 24);
+            p += 4;
+        }
+        header.size = static_cast<size_buffer_t>(p - reinterpret_cast<byte_t const*>(src.data()));
+
+        // Reject sizes the payload cannot produce before anything is allocated for them
+        auto const payload_size = static_cast<size_buffer_t>(end - p);
+        if ((header.codec == codec_stored && value != payload_size)
+                || (header.codec == codec_lz4 && (value > LZ4_MAX_INPUT_SIZE || value > payload_size * 255 + 16))) {
+            return Result::failure(Error::src_corrupted);
+        }
+        return Result(header.size);
+    }
+
+    /// Original size stored in an envelope
+    inline Result original_size(rospan_t src) noexcept {
+        Header header{};
+        auto const result = read_header(src, header);
+        return result ? Result(header.original_size) : result;
+    }
+
+} // namespace envelope
+
+    /* Non-allocating functions (`dst` holds envelope::bound(src.size()) bytes) */
+
+    inline Result compress_framed_into(
+        rospan_t src,
+        span_t dst,
+        compress_level_t compress_level = default_level,
+        bool checksum = true
+    ) {
+        if (src.size() > LZ4_MAX_INPUT_SIZE) {
+            return Result::failure(Error::src_too_large);
+        }
+        envelope::Header header{};
+        header.original_size = src.size();
+        if (checksum) {
+            header.checksum = xxh32(src);
+        }
+        header.size = 1 + envelope::varint_size(src.size()) + (checksum ? 4 : 0);
+        if (dst.size() < header.size) {
+            return Result::failure(Error::dst_too_small);
+        }
+
+        // A block which does not save space is replaced by the data itself
+        auto const payload = dst.subspan(header.size);
+        auto const block = compress_into(src, payload.first(std::min(payload.size(), src.size())), compress_level);
+        size_buffer_t payload_size = *block;
+        if (!block) {
+            if (payload.size() < src.size()) {
+                return Result::failure(Error::dst_too_small);
+            }
+            header.codec = envelope::codec_stored;
+            std::memcpy(payload.data(), src.data(), src.size());
+            payload_size = src.size();
+        }
+        envelope::write_header(header, dst);
+        return Result(header.size + payload_size);
+    }
+
+    /// `dst` holds at least the original size (see envelope::original_size())
+    inline Result decompress_framed_into(rospan_t src, span_t dst, bool verify_checksum = true) noexcept {
+        envelope::Header header{};
+        if (auto const result = envelope::read_header(src, header); !result) {
+            return result;
+        }
+        if (header.codec == envelope::codec_zstd) {
+            return Result::failure(Error::header_invalid);
+        }
+        if (dst.size() < header.original_size) {
+            return Result::failure(Error::dst_too_small);
+        }
+        auto const payload = src.subspan(header.size);
+        auto const out = dst.first(header.original_size);
+        if (header.codec == envelope::codec_stored) {
+            std::memcpy(out.data(), payload.data(), payload.size());
+        } else {
+            auto const result = decompress_into(payload, out);
+            if (!result || *result != header.original_size) {
+                return Result::failure(Error::src_corrupted);
+            }
+        }
+        if (verify_checksum && header.checksum && xxh32(out) != *header.checksum) {
+            return Result::failure(Error::checksum_mismatch);
+        }
+        return Result(header.original_size);
+    }
+
+    /* Vector functions: `dst` is sized once, and cleared on error */
+
+    inline Result compress_framed(
+        rospan_t src,
+        buffer_t& dst,
+        compress_level_t compress_level = default_level,
+        bool checksum = true
+    ) {
+        dst.resize(envelope::bound(src.size()));
+        auto const result = compress_framed_into(src, utils::as_writable_bytes(dst), compress_level, checksum);
+        dst.resize(result ? *result : 0); // keeps the capacity for reuse
+        return result;
+    }
+
+    inline Result compress_framed(
+        buffer_t const& src,
+        buffer_t& dst,
+        compress_level_t compress_level = default_level,
+        bool checksum = true
+    ) {
+        return compress_framed(utils::as_bytes(src), dst, compress_level, checksum);
+    }
+
+    inline Result decompress_framed(rospan_t src, buffer_t& dst, bool verify_checksum = true) {
+        envelope::Header header{};
+        auto const size = envelope::read_header(src, header);
+        if (!size || header.codec == envelope::codec_zstd) {
+            dst.clear();
+            return size ? Result::failure(Error::header_invalid) : size;
+        }
+        dst.resize(header.original_size);
+        auto const result = decompress_framed_into(src, utils::as_writable_bytes(dst), verify_checksum);
+        if (!result) {
+            dst.clear();
+        }
+        return result;
+    }
+
+    inline Result decompress_framed(buffer_t const& src, buffer_t& dst, bool verify_checksum = true) {
+        return decompress_framed(utils::as_bytes(src), dst, verify_checksum);
+    }
+
+} // namespace lz4
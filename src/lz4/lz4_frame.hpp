@@ -0,0 +1,190 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#include "lz4frame.h"
+
+#include "lz4_api.hpp"
+
+/* LZ4 frame format (streaming)
+ *
+ * Unlike the block API, a frame is self-describing (end mark, optional
+ * content size and checksums), so data of any size can be streamed through
+ * it without knowing the original size.
+ */
+namespace lz4 {
+
+    /// Frame parameters (see LZ4F_preferences_t)
+    struct FrameParams {
+        LZ4F_blockSizeID_t block_size = LZ4F_max64KB; ///< LZ4F_max64KB .. LZ4F_max4MB
+        bool block_linked = true;       ///< blocks may reference the previous 64 KiB (better ratio)
+        bool content_checksum = true;   ///< XXH32 of the whole content at the end of the frame
+        bool block_checksum = false;    ///< XXH32 of each block
+        std::uint64_t content_size = 0; ///< stored in the header when non-zero, checked when decoding
+        int compression_level = 0;      ///< 0: fast, 3..12: high compression (LZ4HC)
+    };
+
+    namespace stream {
+
+        inline void check(size_t code, char const* what){
+            if (LZ4F_isError(code)) {
+                throw std::runtime_error(std::string(what) + " failed: " + LZ4F_getErrorName(code));
+            }
+        }
+
+        inline size_buffer_t block_bytes(LZ4F_blockSizeID_t id){
+            switch (id) {
+                case LZ4F_max256KB: return size_buffer_t{256} << 10;
+                case LZ4F_max1MB: return size_buffer_t{1} << 20;
+                case LZ4F_max4MB: return size_buffer_t{4} << 20;
+                default: return size_buffer_t{64} << 10;
+            }
+        }
+
+        /* Context: LZ4F contexts and I/O buffers, created on first use and reused */
+        class Context {
+          public:
+            Context() = default;
+            Context(Context const&) = delete;
+            Context& operator=(Context const&) = delete;
+
+            ~Context(){
+                if (cctx_ != nullptr) {
+                    LZ4F_freeCompressionContext(cctx_);
+                }
+                if (dctx_ != nullptr) {
+                    LZ4F_freeDecompressionContext(dctx_);
+                }
+            }
+
+            LZ4F_cctx* cctx(){
+                if (cctx_ == nullptr) {
+                    check(LZ4F_createCompressionContext(&cctx_, LZ4F_VERSION), "LZ4F_createCompressionContext()");
+                }
+                return cctx_;
+            }
+
+            LZ4F_dctx* dctx(){
+                if (dctx_ == nullptr) {
+                    check(LZ4F_createDecompressionContext(&dctx_, LZ4F_VERSION), "LZ4F_createDecompressionContext()");
+                }
+                return dctx_;
+            }
+
+            buffer_t buffIn{};
+            buffer_t buffOut{};
+
+          private:
+            LZ4F_cctx* cctx_{nullptr};
+            LZ4F_dctx* dctx_{nullptr};
+        };
+
+        inline LZ4F_preferences_t to_preferences(FrameParams const& params){
+            LZ4F_preferences_t prefs{};
+            prefs.frameInfo.blockSizeID = params.block_size;
+            prefs.frameInfo.blockMode = params.block_linked ? LZ4F_blockLinked : LZ4F_blockIndependent;
+            prefs.frameInfo.contentChecksumFlag = params.content_checksum ? LZ4F_contentChecksumEnabled : LZ4F_noContentChecksum;
+            prefs.frameInfo.blockChecksumFlag = params.block_checksum ? LZ4F_blockChecksumEnabled : LZ4F_noBlockChecksum;
+            prefs.frameInfo.contentSize = params.content_size;
+            prefs.compressionLevel = params.compression_level;
+            return prefs;
+        }
+
+        inline void write(std::ostream& out, buffer_t const& buffer, size_t size){
+            out.write(reinterpret_cast<char const*>(buffer.data()), static_cast<std::streamsize>(size));
+        }
+
+        inline void compress(Context& ctx, std::istream& in, std::ostream& out, FrameParams const& params = {}){
+            auto const prefs = to_preferences(params);
+            auto const toRead = block_bytes(params.block_size);
+            ctx.buffIn.resize(toRead);
+            ctx.buffOut.resize(std::max<size_t>(LZ4F_compressBound(toRead, &prefs), LZ4F_HEADER_SIZE_MAX));
+
+            size_t const header = LZ4F_compressBegin(ctx.cctx(), ctx.buffOut.data(), ctx.buffOut.size(), &prefs);
+            check(header, "LZ4F_compressBegin()");
+            write(out, ctx.buffOut, header);
+
+            while (in) {
+                in.read(reinterpret_cast<char*>(ctx.buffIn.data()), static_cast<std::streamsize>(toRead));
+                auto const read = static_cast<size_t>(in.gcount());
+                if (read == 0) {
+                    break;
+                }
+                size_t const written = LZ4F_compressUpdate(ctx.cctx(), ctx.buffOut.data(), ctx.buffOut.size(),
+                                                           ctx.buffIn.data(), read, nullptr);
+                check(written, "LZ4F_compressUpdate()");
+                write(out, ctx.buffOut, written);
+            }
+
+            size_t const end = LZ4F_compressEnd(ctx.cctx(), ctx.buffOut.data(), ctx.buffOut.size(), nullptr);
+            check(end, "LZ4F_compressEnd()");
+            write(out, ctx.buffOut, end);
+        }
+
+        inline void compress(std::istream& in, std::ostream& out, FrameParams const& params = {}){
+            Context ctx{};
+            compress(ctx, in, out, params);
+        }
+
+        /// Decompress one or more concatenated frames
+        inline void decompress(Context& ctx, std::istream& in, std::ostream& out){
+            size_t const toRead = size_t{64} << 10;
+            ctx.buffIn.resize(toRead);
+            ctx.buffOut.resize(size_t{4} << 20); // largest block size
+            LZ4F_resetDecompressionContext(ctx.dctx());
+
+            size_t ret = 1; // 0 once a frame is complete
+            bool started = false;
+            while (in) {
+                in.read(reinterpret_cast<char*>(ctx.buffIn.data()), static_cast<std::streamsize>(toRead));
+                auto const read = static_cast<size_t>(in.gcount());
+                size_t pos = 0;
+                while (pos < read) {
+                    size_t srcSize = read - pos;
+                    size_t dstSize = ctx.buffOut.size();
+                    ret = LZ4F_decompress(ctx.dctx(), ctx.buffOut.data(), &dstSize,
+                                          ctx.buffIn.data() + pos, &srcSize, nullptr);
+                    check(ret, "LZ4F_decompress()");
+                    write(out, ctx.buffOut, dstSize);
+                    pos += srcSize;
+                    started = true;
+                }
+            }
+
+            if (started && ret != 0) {
+                throw std::runtime_error("Error: lz4 frame is truncated!");
+            }
+        }
+
+        inline void decompress(std::istream& in, std::ostream& out){
+            Context ctx{};
+            decompress(ctx, in, out);
+        }
+
+    } // namespace stream
+
+    /* Streaming Functions */
+
+    /// Compress a file; the content size is stored in the frame header.
+    inline void stream_compress(string_t const& in, string_t const& out, FrameParams params = {}){
+        std::ifstream in_file(in, std::ios::binary);
+        std::ofstream out_file(out, std::ios::binary);
+        if (params.content_size == 0) {
+            params.content_size = std::filesystem::file_size(in);
+        }
+        stream::compress(in_file, out_file, params);
+    }
+
+    inline void stream_decompress(string_t const& in, string_t const& out){
+        std::ifstream in_file(in, std::ios::binary);
+        std::ofstream out_file(out, std::ios::binary);
+        stream::decompress(in_file, out_file);
+    }
+
+} // namespace lz4
@@ -0,0 +1,217 @@
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string_view>
+
+#include "lz4.h"
+
+#include "lz4_api.hpp"
+
+/* Streaming mode for small, correlated messages
+ *
+ * Each message is compressed as one LZ4 block against the history of the
+ * previous messages of the stream (up to 64 KiB), instead of on its own:
+ * on small payloads most of the content is then found in the history.
+ *
+ *   producer                                   consumer
+ *   lz4::MessageStream enc{};                  lz4::MessageStreamDecoder dec{};
+ *   auto block = enc.compress(msg);   ---->    auto msg = dec.decompress(block);
+ *
+ * Blocks must be decoded in the order they were produced, by a decoder
+ * created with the same max_message_size and dictionary. Blocks carry no
+ * size nor framing: the transport delimits them. After an error, or to
+ * start over (e.g. on reconnection), reset() both sides.
+ *
+ * Messages are copied into a ring buffer of LZ4_decoderRingBufferSize(max_message_size)
+ * bytes; both sides move to the beginning of the ring once less than
+ * max_message_size bytes remain, so the decoder can decode in place.
+ */
+namespace lz4 {
+
+    inline constexpr size_buffer_t default_max_message_size = size_buffer_t{64} << 10;
+    inline constexpr size_buffer_t max_dictionary_size = size_buffer_t{64} << 10;
+
+    namespace detail {
+        inline size_buffer_t ring_size(size_buffer_t max_message_size){
+            if (max_message_size == 0 || max_message_size > LZ4_MAX_INPUT_SIZE) {
+                throw std::invalid_argument("lz4: max_message_size must be in (0, LZ4_MAX_INPUT_SIZE]");
+            }
+            return (size_buffer_t)LZ4_decoderRingBufferSize((int)max_message_size);
+        }
+
+        /// Only the last 64 KiB of a dictionary can be referenced
+        inline buffer_t dictionary_tail(rospan_t dictionary){
+            auto const tail = dictionary.last(std::min(dictionary.size(), max_dictionary_size));
+            auto const* p = reinterpret_cast<byte_t const*>(tail.data());
+            return buffer_t(p, p + tail.size());
+        }
+    } // namespace detail
+
+    /* Producer side */
+    class MessageStream {
+      public:
+        /// - dictionary   : optional preset dictionary (e.g. typical messages), also given to the decoder
+        /// - acceleration : as LZ4_compress_fast(), 1 is the default speed
+        explicit MessageStream(
+            size_buffer_t max_message_size = default_max_message_size,
+            rospan_t dictionary = {},
+            int acceleration = 1
+        )
+        : max_message_size_(max_message_size), acceleration_(std::max(acceleration, 1)),
+          dictionary_(detail::dictionary_tail(dictionary)) {
+            ring_.resize(detail::ring_size(max_message_size_));
+            LZ4_initStream(&stream_, sizeof(stream_));
+            LZ4_initStream(&dict_stream_, sizeof(dict_stream_));
+            LZ4_loadDict(&dict_stream_, (const char*)dictionary_.data(), (int)dictionary_.size());
+            reset();
+        }
+
+        MessageStream(MessageStream const&) = delete;
+        MessageStream& operator=(MessageStream const&) = delete;
+
+        size_buffer_t max_message_size() const noexcept { return max_message_size_; }
+
+        /// Forget the history (the dictionary is kept)
+        void reset(){
+            // The dictionary is digested once: restarting is a copy of the loaded state
+            std::memcpy(&stream_, &dict_stream_, sizeof(stream_));
+            offset_ = 0;
+        }
+
+        /// `dst` should hold compress_bound(message.size()) bytes
+        Result compress_into(rospan_t message, span_t dst){
+            if (message.size() > max_message_size_) {
+                return Result::failure(Error::src_too_large);
+            }
+            if (ring_.size() - offset_ < max_message_size_) {
+                offset_ = 0;
+            }
+            auto* in = ring_.data() + offset_;
+            std::memcpy(in, message.data(), message.size());
+            const int compress_size = LZ4_compress_fast_continue(
+                &stream_,
+                (const char*)in,
+                (char*)dst.data(),
+                (int)message.size(),
+                (int)std::min<size_buffer_t>(dst.size(), LZ4_MAX_INPUT_SIZE),
+                acceleration_
+            );
+            if (compress_size <= 0) {
+                reset(); // the stream state is undefined after a failure
+                return Result::failure(Error::dst_too_small);
+            }
+            offset_ += message.size();
+            return Result((size_buffer_t)compress_size);
+        }
+
+        buffer_t compress(rospan_t message){
+            buffer_t block{};
+            block.resize(compress_bound(message.size()));
+            block.resize(compress_into(message, utils::as_writable_bytes(block)).value());
+            block.shrink_to_fit();
+            return block;
+        }
+
+        buffer_t compress(std::string_view message){
+            return compress(utils::as_bytes(message));
+        }
+
+        buffer_t compress(buffer_t const& message){
+            return compress(utils::as_bytes(message));
+        }
+
+      private:
+        size_buffer_t const max_message_size_;
+        int const acceleration_;
+        buffer_t const dictionary_;
+        buffer_t ring_{};
+        size_buffer_t offset_{0};
+        LZ4_stream_t stream_;
+        LZ4_stream_t dict_stream_;
+    };
+
+    /* Consumer side */
+    class MessageStreamDecoder {
+      public:
+        explicit MessageStreamDecoder(
+            size_buffer_t max_message_size = default_max_message_size,
+            rospan_t dictionary = {}
+        )
+        : max_message_size_(max_message_size), dictionary_(detail::dictionary_tail(dictionary)) {
+            ring_.resize(detail::ring_size(max_message_size_));
+            reset();
+        }
+
+        MessageStreamDecoder(MessageStreamDecoder const&) = delete;
+        MessageStreamDecoder& operator=(MessageStreamDecoder const&) = delete;
+
+        size_buffer_t max_message_size() const noexcept { return max_message_size_; }
+
+        void reset(){
+            LZ4_setStreamDecode(&stream_, (const char*)dictionary_.data(), (int)dictionary_.size());
+            offset_ = 0;
+        }
+
+        /// Decode the next block in place: the view is valid until the next call
+        rospan_t decompress_view(rospan_t block){
+            auto const message = decode(block);
+            if (!message) {
+                throw std::runtime_error("lz4::MessageStreamDecoder: corrupted block (or out of sequence)!");
+            }
+            return { reinterpret_cast<std::byte const*>(ring_.data() + offset_ - *message), *message };
+        }
+
+        /// Decode the next block into `dst`
+        Result decompress_into(rospan_t block, span_t dst){
+            auto const message = decode(block);
+            if (!message) {
+                return message;
+            }
+            if (*message > dst.size()) {
+                return Result::failure(Error::dst_too_small);
+            }
+            std::memcpy(dst.data(), ring_.data() + offset_ - *message, *message);
+            return message;
+        }
+
+        buffer_t decompress(rospan_t block){
+            auto const message = decompress_view(block);
+            auto const* p = reinterpret_cast<byte_t const*>(message.data());
+            return buffer_t(p, p + message.size());
+        }
+
+        buffer_t decompress(buffer_t const& block){
+            return decompress(utils::as_bytes(block));
+        }
+
+      private:
+        /// Decode into the ring, which then ends with the message at offset_
+        Result decode(rospan_t block){
+            if (ring_.size() - offset_ < max_message_size_) {
+                offset_ = 0;
+            }
+            const int decomp_size = LZ4_decompress_safe_continue(
+                &stream_,
+                (const char*)block.data(),
+                (char*)ring_.data() + offset_,
+                (int)std::min<size_buffer_t>(block.size(), LZ4_MAX_INPUT_SIZE),
+                (int)max_message_size_
+            );
+            if (decomp_size < 0) {
+                reset(); // later blocks cannot be decoded anyway
+                return Result::failure(Error::src_corrupted);
+            }
+            offset_ += (size_buffer_t)decomp_size;
+            return Result((size_buffer_t)decomp_size);
+        }
+
+        size_buffer_t const max_message_size_;
+        buffer_t const dictionary_;
+        buffer_t ring_{};
+        size_buffer_t offset_{0};
+        LZ4_streamDecode_t stream_;
+    };
+
+} // namespace lz4
@@ -0,0 +1,345 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "lz4frame.h"
+
+#include "../thread_pool.hpp"
+#include "lz4_frame.hpp"
+
+/* Parallel LZ4 for large inputs
+ *
+ * LZ4 itself is single-threaded. Here the input is cut into chunks of
+ * `chunk_size` bytes, each chunk is compressed as an independent LZ4 frame
+ * on a thread pool, and the frames are written in order:
+ *
+ *   [frame: chunk 0][frame: chunk 1]...[frame: chunk N-1]
+ *
+ * Concatenated frames are a valid LZ4 stream (`lz4 -d`, lz4::stream_decompress).
+ * Every frame stores its content size, so decompression finds the frame
+ * boundaries by walking the block headers (without decoding) and
+ * decompresses the frames in parallel, straight to their final offset.
+ *
+ * Inputs made of one large frame (e.g. from `lz4` without this engine)
+ * cannot be split: decode them with lz4::stream instead. Content sizes come
+ * from untrusted headers: above max_frame_content, or more than the frame
+ * can produce, they are errors before anything is allocated for them.
+ */
+namespace lz4 {
+namespace parallel {
+
+    /// Largest frame content decoded here (larger chunks are cut to it)
+    inline constexpr size_buffer_t max_frame_content = size_buffer_t{1} << 30;
+
+    struct Params {
+        size_buffer_t chunk_size = size_buffer_t{4} << 20; ///< uncompressed bytes per frame
+        FrameParams frame{};                               ///< content_size is set per frame
+    };
+
+    namespace detail {
+        inline std::uint32_t read_le32(byte_t const* p){
+            return std::uint32_t{p[0]} | (std::uint32_t{p[1]} << 8)
+                 | (std::uint32_t{p[2]} << 16) | (std::uint32_t{p[3]} << 24);
+        }
+
+        struct FrameExtent {
+            size_buffer_t size{0};                     ///< 0: the frame is not complete
+            std::optional<std::uint64_t> content_size{}; ///< nullopt: unknown, 0 for skippable frames
+        };
+
+        /// Extent of the frame at the beginning of `data`, from its headers only
+        inline FrameExtent frame_extent(rospan_t data){
+            auto const* p = reinterpret_cast<byte_t const*>(data.data());
+            auto const n = data.size();
+            if (n < 4) {
+                return {};
+            }
+            auto const magic = read_le32(p);
+            if ((magic & 0xFFFFFFF0U) == LZ4F_MAGIC_SKIPPABLE_START) {
+                if (n < 8) {
+                    return {};
+                }
+                auto const size = size_buffer_t{8} + read_le32(p + 4);
+                return size <= n ? FrameExtent{size, 0} : FrameExtent{};
+            }
+            if (magic != LZ4F_MAGICNUMBER) {
+                throw std::runtime_error("lz4::parallel: not an lz4 frame!");
+            }
+            if (n < 5) {
+                return {};
+            }
+            auto const header_size = LZ4F_headerSize(p, n);
+            stream::check(header_size, "LZ4F_headerSize()");
+            if (header_size > n) {
+                return {};
+            }
+
+            auto const flags = p[4];
+            bool const block_checksum = (flags & 0x10) != 0;
+            bool const content_checksum = (flags & 0x04) != 0;
+            FrameExtent extent{};
+            if (flags & 0x08) {
+                extent.content_size = std::uint64_t{read_le32(p + 6)} | (std::uint64_t{read_le32(p + 10)} << 32);
+            }
+
+            auto pos = header_size;
+            bool has_blocks = false;
+            for (;;) {
+                if (pos + 4 > n) {
+                    return {};
+                }
+                auto const block = read_le32(p + pos);
+                pos += 4;
+                if (block == 0) { // end mark
+                    pos += content_checksum ? 4 : 0;
+                    break;
+                }
+                pos += (block & 0x7FFFFFFFU) + (block_checksum ? 4 : 0);
+                has_blocks = true;
+            }
+            if (pos > n) {
+                return {};
+            }
+            if (!has_blocks) {
+                extent.content_size = 0; // empty frames do not store their (zero) size
+            }
+            extent.size = pos;
+            return extent;
+        }
+
+        /// Per-worker LZ4F contexts
+        inline stream::Context& thread_context(){
+            thread_local stream::Context ctx{};
+            return ctx;
+        }
+
+        inline buffer_t compress_chunk(rospan_t chunk, FrameParams params){
+            params.content_size = chunk.size();
+            auto const prefs = stream::to_preferences(params);
+            auto* cctx = thread_context().cctx();
+
+            buffer_t frame{};
+            frame.resize(LZ4F_compressFrameBound(chunk.size(), &prefs));
+            auto* out = frame.data();
+            auto const end = frame.data() + frame.size();
+            size_t ret = LZ4F_compressBegin(cctx, out, frame.size(), &prefs);
+            stream::check(ret, "LZ4F_compressBegin()");
+            out += ret;
+            ret = LZ4F_compressUpdate(cctx, out, static_cast<size_t>(end - out), chunk.data(), chunk.size(), nullptr);
+            stream::check(ret, "LZ4F_compressUpdate()");
+            out += ret;
+            ret = LZ4F_compressEnd(cctx, out, static_cast<size_t>(end - out), nullptr);
+            stream::check(ret, "LZ4F_compressEnd()");
+            out += ret;
+            frame.resize(static_cast<size_buffer_t>(out - frame.data()));
+            return frame;
+        }
+
+        /// Decompress one frame into `dst`, which holds exactly its content
+        inline void decompress_frame(rospan_t frame, span_t dst){
+            auto* dctx = thread_context().dctx();
+            LZ4F_resetDecompressionContext(dctx);
+            size_t in_pos = 0;
+            size_t out_pos = 0;
+            size_t ret = 1; // 0 once the frame is complete
+            while (ret != 0) {
+                size_t src_size = frame.size() - in_pos;
+                size_t dst_size = dst.size() - out_pos;
+                ret = LZ4F_decompress(dctx, dst.data() + out_pos, &dst_size, frame.data() + in_pos, &src_size, nullptr);
+                stream::check(ret, "LZ4F_decompress()");
+                if (src_size == 0 && dst_size == 0) {
+                    break; // no progress
+                }
+                in_pos += src_size;
+                out_pos += dst_size;
+            }
+            if (ret != 0 || out_pos != dst.size() || in_pos != frame.size()) {
+                throw std::runtime_error("lz4::parallel: frame content size mismatch!");
+            }
+        }
+
+        inline buffer_t decompress_frame(rospan_t frame, std::uint64_t content_size){
+            buffer_t out{};
+            if (content_size > 0) { // 0 for skippable frames (or empty frames)
+                out.resize(static_cast<size_buffer_t>(content_size));
+                decompress_frame(frame, utils::as_writable_bytes(out));
+            }
+            return out;
+        }
+
+        inline std::uint64_t require_content_size(FrameExtent const& extent){
+            if (!extent.content_size) {
+                throw std::runtime_error("lz4::parallel: frame without content size, use lz4::stream instead!");
+            }
+            // LZ4 blocks expand 255 times at most
+            if (*extent.content_size > max_frame_content || *extent.content_size > std::uint64_t{extent.size} * 255 + 16) {
+                throw std::runtime_error("lz4::parallel: frame content size larger than the frame can produce!");
+            }
+            return *extent.content_size;
+        }
+
+        /// Wait for every task before any result is read: if one of them
+        /// failed, the others must not outlive the caller's buffers.
+        template <typename T>
+        inline void wait_all(std::vector<std::future<T>> const& tasks){
+            for (auto const& task : tasks) {
+                task.wait();
+            }
+        }
+    } // namespace detail
+
+    /* In-memory functions */
+
+    inline buffer_t compress(rospan_t src, Params const& params = {}, ::utils::ThreadPool& pool = ::utils::ThreadPool::global()){
+        auto const chunk_size = std::clamp<size_buffer_t>(params.chunk_size, 1, max_frame_content);
+        std::vector<std::future<buffer_t>> frames{};
+        frames.reserve(src.size() / chunk_size + 1);
+        for (size_buffer_t pos = 0; pos < src.size() || pos == 0; pos += chunk_size) {
+            auto const chunk = src.subspan(pos, std::min(chunk_size, src.size() - pos));
+            frames.push_back(pool.submit([chunk, frame = params.frame]{ return detail::compress_chunk(chunk, frame); }));
+        }
+        detail::wait_all(frames);
+
+        std::vector<buffer_t> results{};
+        results.reserve(frames.size());
+        size_buffer_t total = 0;
+        for (auto& frame : frames) {
+            results.push_back(frame.get());
+            total += results.back().size();
+        }
+        buffer_t out{};
+        out.resize(total);
+        auto* p = out.data();
+        for (auto const& frame : results) {
+            p = std::copy(frame.begin(), frame.end(), p);
+        }
+        return out;
+    }
+
+    inline buffer_t decompress(rospan_t src, ::utils::ThreadPool& pool = ::utils::ThreadPool::global()){
+        // Frame boundaries and output offsets, from the headers
+        std::vector<std::pair<rospan_t, size_buffer_t>> frames{};
+        size_buffer_t total = 0;
+        for (size_buffer_t pos = 0; pos < src.size();) {
+            auto const extent = detail::frame_extent(src.subspan(pos));
+            if (extent.size == 0) {
+                throw std::runtime_error("Error: lz4 frame is truncated!");
+            }
+            frames.emplace_back(src.subspan(pos, extent.size), total);
+            auto const content_size = static_cast<size_buffer_t>(detail::require_content_size(extent));
+            if (content_size > std::numeric_limits<size_buffer_t>::max() - total) {
+                throw std::runtime_error("lz4::parallel: output size overflow!");
+            }
+            total += content_size;
+            pos += extent.size;
+        }
+
+        buffer_t out{};
+        out.resize(total);
+        std::vector<std::future<void>> done{};
+        done.reserve(frames.size());
+        for (size_buffer_t i = 0; i < frames.size(); ++i) {
+            auto const end = i + 1 < frames.size() ? frames[i + 1].second : total;
+            auto const dst = utils::as_writable_bytes(out).subspan(frames[i].second, end - frames[i].second);
+            if (!dst.empty()) {
+                done.push_back(pool.submit([frame = frames[i].first, dst]{ detail::decompress_frame(frame, dst); }));
+            }
+        }
+        detail::wait_all(done);
+        for (auto& d : done) {
+            d.get();
+        }
+        return out;
+    }
+
+    inline buffer_t compress(buffer_t const& src, Params const& params = {}, ::utils::ThreadPool& pool = ::utils::ThreadPool::global()){
+        return compress(utils::as_bytes(src), params, pool);
+    }
+
+    inline buffer_t decompress(buffer_t const& src, ::utils::ThreadPool& pool = ::utils::ThreadPool::global()){
+        return decompress(utils::as_bytes(src), pool);
+    }
+
+    /* Streaming functions (bounded memory: about 2 chunks per worker) */
+
+    inline void compress(std::istream& in, std::ostream& out, Params const& params = {}, ::utils::ThreadPool& pool = ::utils::ThreadPool::global()){
+        auto const chunk_size = std::clamp<size_buffer_t>(params.chunk_size, 1, max_frame_content);
+        ::utils::OrderedWriter writer(out, 2 * pool.size());
+        bool empty = true;
+        while (in) {
+            buffer_t chunk{};
+            chunk.resize(chunk_size);
+            in.read(reinterpret_cast<char*>(chunk.data()), static_cast<std::streamsize>(chunk.size()));
+            chunk.resize(static_cast<size_buffer_t>(in.gcount()));
+            if (chunk.empty() && !empty) {
+                break;
+            }
+            empty = false;
+            writer.push(pool.submit([chunk = std::move(chunk), frame = params.frame]{
+                return detail::compress_chunk(utils::as_bytes(chunk), frame);
+            }));
+        }
+        writer.finish();
+    }
+
+    inline void decompress(std::istream& in, std::ostream& out, ::utils::ThreadPool& pool = ::utils::ThreadPool::global()){
+        ::utils::OrderedWriter writer(out, 2 * pool.size());
+        buffer_t window{};
+        size_buffer_t begin = 0; // first byte not yet submitted
+        for (;;) {
+            // Keep the incomplete frame, and read more after it
+            window.erase(window.begin(), window.begin() + static_cast<std::ptrdiff_t>(begin));
+            begin = 0;
+            auto const filled = window.size();
+            window.resize(std::max<size_buffer_t>(2 * filled, size_buffer_t{8} << 20));
+            in.read(reinterpret_cast<char*>(window.data() + filled), static_cast<std::streamsize>(window.size() - filled));
+            auto const read = static_cast<size_buffer_t>(in.gcount());
+            window.resize(filled + read);
+            if (read == 0) {
+                if (!window.empty()) {
+                    throw std::runtime_error("Error: lz4 frame is truncated!");
+                }
+                break;
+            }
+
+            for (;;) {
+                auto const extent = detail::frame_extent(utils::as_bytes(window).subspan(begin));
+                if (extent.size == 0) {
+                    break;
+                }
+                auto const content_size = detail::require_content_size(extent);
+                auto const* frame = window.data() + begin;
+                writer.push(pool.submit([frame = buffer_t(frame, frame + extent.size), content_size]{
+                    return detail::decompress_frame(utils::as_bytes(frame), content_size);
+                }));
+                begin += extent.size;
+            }
+        }
+        writer.finish();
+    }
+
+    /// Compress a file with all the workers of `pool`
+    inline void stream_compress(string_t const& in, string_t const& out, Params const& params = {}, ::utils::ThreadPool& pool = ::utils::ThreadPool::global()){
+        std::ifstream in_file(in, std::ios::binary);
+        std::ofstream out_file(out, std::ios::binary);
+        compress(in_file, out_file, params, pool);
+    }
+
+    inline void stream_decompress(string_t const& in, string_t const& out, ::utils::ThreadPool& pool = ::utils::ThreadPool::global()){
+        std::ifstream in_file(in, std::ios::binary);
+        std::ofstream out_file(out, std::ios::binary);
+        decompress(in_file, out_file, pool);
+    }
+
+} // namespace parallel
+} // namespace lz4
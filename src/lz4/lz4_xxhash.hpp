@@ -0,0 +1,72 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+/* XXH32 (https://github.com/Cyan4973/xxHash), as used by the LZ4 frame format
+ *
+ * liblz4 does not export its copy of xxhash, so it is reimplemented here
+ * (header-only, no extra dependency). Output is identical to XXH32().
+ */
+namespace lz4 {
+
+    namespace detail {
+        inline constexpr std::uint32_t xxh_prime32_1 = 2654435761U;
+        inline constexpr std::uint32_t xxh_prime32_2 = 2246822519U;
+        inline constexpr std::uint32_t xxh_prime32_3 = 3266489917U;
+        inline constexpr std::uint32_t xxh_prime32_4 = 668265263U;
+        inline constexpr std::uint32_t xxh_prime32_5 = 374761393U;
+
+        inline std::uint32_t xxh_read32(std::byte const* p) noexcept {
+            return std::uint32_t(p[0]) | (std::uint32_t(p[1]) << 8)
+                 | (std::uint32_t(p[2]) << 16) | (std::uint32_t(p[3]) << 24);
+        }
+
+        inline std::uint32_t xxh_round(std::uint32_t acc, std::uint32_t input) noexcept {
+            return std::rotl(acc + input * xxh_prime32_2, 13) * xxh_prime32_1;
+        }
+    } // namespace detail
+
+    inline std::uint32_t xxh32(std::span<const std::byte> data, std::uint32_t seed = 0) noexcept {
+        using namespace detail;
+        auto const* p = data.data();
+        auto const* const end = p + data.size();
+        std::uint32_t h{};
+
+        if (data.size() >= 16) {
+            std::uint32_t v1 = seed + xxh_prime32_1 + xxh_prime32_2;
+            std::uint32_t v2 = seed + xxh_prime32_2;
+            std::uint32_t v3 = seed;
+            std::uint32_t v4 = seed - xxh_prime32_1;
+            for (auto const* const limit = end - 16; p <= limit; p += 16) {
+                v1 = xxh_round(v1, xxh_read32(p));
+                v2 = xxh_round(v2, xxh_read32(p + 4));
+                v3 = xxh_round(v3, xxh_read32(p + 8));
+                v4 = xxh_round(v4, xxh_read32(p + 12));
+            }
+            h = std::rotl(v1, 1) + std::rotl(v2, 7) + std::rotl(v3, 12) + std::rotl(v4, 18);
+        } else {
+            h = seed + xxh_prime32_5;
+        }
+        h += static_cast<std::uint32_t>(data.size());
+
+        for (; end - p >= 4; p += 4) {
+            h += xxh_read32(p) * xxh_prime32_3;
+            h = std::rotl(h, 17) * xxh_prime32_4;
+        }
+        for (; p < end; ++p) {
+            h += std::uint32_t(*p) * xxh_prime32_5;
+            h = std::rotl(h, 11) * xxh_prime32_1;
+        }
+
+        h ^= h >> 15;
+        h *= xxh_prime32_2;
+        h ^= h >> 13;
+        h *= xxh_prime32_3;
+        h ^= h >> 16;
+        return h;
+    }
+
+} // namespace lz4
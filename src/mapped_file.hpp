@@ -0,0 +1,227 @@
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <system_error>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>     // open, posix_fallocate
+#include <sys/mman.h>  // mmap, madvise
+#include <sys/stat.h>  // fstat
+#include <unistd.h>    // close, ftruncate, unlink
+#define UTILS_HAS_MMAP 1
+#else
+#include <fstream>
+
+#include "byte_buffer.hpp"
+#endif
+
+namespace utils {
+
+/* Read-only memory mapping of a whole file.
+ *
+ * The pages are read by the kernel on first access (no copy into a user
+ * buffer), e.g. a compressor reads its input straight from the page cache.
+ * Where mmap is not available, the file is read into memory instead.
+ */
+class MappedFile {
+ public:
+  enum class Access {
+    normal,
+    sequential,  ///< aggressive readahead, pages freed after use (MADV_SEQUENTIAL)
+    random,      ///< no readahead (MADV_RANDOM)
+  };
+
+  explicit MappedFile(std::filesystem::path const &path, Access access = Access::sequential) {
+#if defined(UTILS_HAS_MMAP)
+    int const fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+      throw std::system_error(errno, std::generic_category(), "open " + path.string());
+    }
+    struct stat st {};
+    if (::fstat(fd, &st) != 0) {
+      auto const error = errno;
+      ::close(fd);
+      throw std::system_error(error, std::generic_category(), "fstat " + path.string());
+    }
+    size_ = static_cast<std::size_t>(st.st_size);
+    if (size_ > 0) {  // mmap() of 0 bytes fails
+      void *const p = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (p == MAP_FAILED) {
+        auto const error = errno;
+        ::close(fd);
+        throw std::system_error(error, std::generic_category(), "mmap " + path.string());
+      }
+      data_ = static_cast<std::byte const *>(p);
+    }
+    ::close(fd);  // the mapping keeps the file open
+    advise(access);
+#else
+    (void)access;
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+      throw std::system_error(ENOENT, std::generic_category(), "open " + path.string());
+    }
+    buffer_.resize(static_cast<std::size_t>(std::filesystem::file_size(path)));
+    file.read(reinterpret_cast<char *>(buffer_.data()), static_cast<std::streamsize>(buffer_.size()));
+    data_ = reinterpret_cast<std::byte const *>(buffer_.data());
+    size_ = buffer_.size();
+#endif
+  }
+
+  MappedFile(MappedFile &&other) noexcept
+      : data_(std::exchange(other.data_, nullptr)), size_(std::exchange(other.size_, 0)) {
+#if !defined(UTILS_HAS_MMAP)
+    buffer_ = std::move(other.buffer_);
+#endif
+  }
+  MappedFile(MappedFile const &) = delete;
+  MappedFile &operator=(MappedFile const &) = delete;
+  MappedFile &operator=(MappedFile &&) = delete;
+
+  ~MappedFile() {
+#if defined(UTILS_HAS_MMAP)
+    if (data_ != nullptr) {
+      ::munmap(const_cast<std::byte *>(data_), size_);
+    }
+#endif
+  }
+
+  std::span<std::byte const> bytes() const noexcept { return {data_, size_}; }
+  std::byte const *data() const noexcept { return data_; }
+  std::size_t size() const noexcept { return size_; }
+
+  /// Access pattern hint for the whole mapping (only a hint: errors are ignored)
+  void advise(Access access) const noexcept {
+#if defined(UTILS_HAS_MMAP)
+    if (data_ == nullptr) {
+      return;
+    }
+    int const advice = access == Access::sequential ? MADV_SEQUENTIAL
+                       : access == Access::random   ? MADV_RANDOM
+                                                    : MADV_NORMAL;
+    ::madvise(const_cast<std::byte *>(data_), size_, advice);
+#else
+    (void)access;
+#endif
+  }
+
+  /// Start reading [offset, offset + length) ahead of its use (MADV_WILLNEED)
+  void will_need(std::size_t offset, std::size_t length) const noexcept {
+#if defined(UTILS_HAS_MMAP)
+    if (offset >= size_) {
+      return;
+    }
+    // madvise() wants a page-aligned address
+    static std::size_t const page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+    auto const begin = offset / page * page;
+    auto const end = std::min(size_, offset + length);
+    ::madvise(const_cast<std::byte *>(data_) + begin, end - begin, MADV_WILLNEED);
+#else
+    (void)offset;
+    (void)length;
+#endif
+  }
+
+ private:
+  std::byte const *data_{nullptr};
+  std::size_t size_{0};
+#if !defined(UTILS_HAS_MMAP)
+  byte_buffer buffer_{};
+#endif
+};
+
+#if defined(UTILS_HAS_MMAP)
+/* Writable memory mapping of a new file of known size.
+ *
+ * The file is created (or truncated) and its blocks allocated with
+ * posix_fallocate(), then written through the mapping: a decompressor
+ * writes its output straight into the page cache. A full disk fails here
+ * instead of raising SIGBUS on a write to a sparse page. finish() unmaps
+ * and cuts the file to the bytes actually written; without finish() (an
+ * error), the file is removed.
+ */
+class MappedOutput {
+ public:
+  MappedOutput(std::filesystem::path path, std::size_t size) : path_(std::move(path)), size_(size) {
+    fd_ = ::open(path_.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+      throw std::system_error(errno, std::generic_category(), "open " + path_.string());
+    }
+    if (size_ > 0) {
+#if defined(__APPLE__)
+      if (::ftruncate(fd_, static_cast<off_t>(size_)) != 0) {  // no posix_fallocate
+        fail("ftruncate");
+      }
+#else
+      if (int const error = ::posix_fallocate(fd_, 0, static_cast<off_t>(size_)); error != 0) {
+        errno = error;  // returned, not set
+        fail("posix_fallocate");
+      }
+#endif
+      void *const p = ::mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+      if (p == MAP_FAILED) {
+        fail("mmap");
+      }
+      data_ = static_cast<std::byte *>(p);
+      ::madvise(data_, size_, MADV_SEQUENTIAL);
+    }
+  }
+
+  MappedOutput(MappedOutput const &) = delete;
+  MappedOutput &operator=(MappedOutput const &) = delete;
+
+  /// Removes the file if finish() was not called: no partial output is left
+  ~MappedOutput() {
+    if (data_ != nullptr) {
+      ::munmap(data_, size_);
+    }
+    if (fd_ >= 0) {
+      ::close(fd_);
+      ::unlink(path_.c_str());
+    }
+  }
+
+  std::span<std::byte> bytes() const noexcept { return {data_, size_}; }
+  std::size_t size() const noexcept { return size_; }
+
+  /// Unmap, and truncate the file to `written` bytes
+  void finish(std::size_t written) {
+    if (data_ != nullptr) {
+      ::munmap(data_, size_);
+      data_ = nullptr;
+    }
+    if (written != size_ && ::ftruncate(fd_, static_cast<off_t>(written)) != 0) {
+      fail("ftruncate");
+    }
+    ::close(fd_);
+    fd_ = -1;
+  }
+
+ private:
+  [[noreturn]] void fail(char const *what) {
+    auto const error = errno;
+    if (data_ != nullptr) {
+      ::munmap(data_, size_);
+      data_ = nullptr;
+    }
+    ::close(fd_);
+    fd_ = -1;
+    ::unlink(path_.c_str());
+    throw std::system_error(error, std::generic_category(), what);
+  }
+
+  std::filesystem::path path_;
+  std::byte *data_{nullptr};
+  std::size_t size_;
+  int fd_{-1};
+};
+#endif
+
+}  // namespace utils
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace utils {
+
+/* Bounded single-producer / single-consumer queue.
+ *
+ * Lock-free ring buffer: the producer only writes `tail_`, the consumer
+ * only writes `head_`. A full (or empty) queue blocks the producer (or
+ * consumer) in std::atomic::wait, i.e. a futex on Linux, instead of
+ * spinning; wake-ups are cheap when nobody waits.
+ *
+ * close() wakes both sides: push() then fails, and pop() fails once the
+ * queue is drained. It is how a pipeline stage tells the others to stop.
+ */
+template <typename T>
+class SpscQueue {
+ public:
+  explicit SpscQueue(std::size_t capacity) : slots_(capacity + 1) {}
+
+  SpscQueue(SpscQueue const &) = delete;
+  SpscQueue &operator=(SpscQueue const &) = delete;
+
+  std::size_t capacity() const noexcept { return slots_.size() - 1; }
+
+  /// Blocks while the queue is full; false if the queue is closed
+  bool push(T value) {
+    auto const tail = tail_.load(std::memory_order_relaxed);
+    auto const next = increment(tail);
+    for (;;) {
+      if (closed_.load(std::memory_order_acquire)) {
+        return false;
+      }
+      if (next != head_.load(std::memory_order_acquire)) {
+        break;
+      }
+      wait_for([&] { return next != head_.load(std::memory_order_acquire); });
+    }
+    slots_[tail] = std::move(value);
+    tail_.store(next, std::memory_order_release);
+    wake();
+    return true;
+  }
+
+  /// Blocks while the queue is empty; false once the queue is closed and drained
+  bool pop(T &value) {
+    auto const head = head_.load(std::memory_order_relaxed);
+    for (;;) {
+      if (head != tail_.load(std::memory_order_acquire)) {
+        break;
+      }
+      if (closed_.load(std::memory_order_acquire)) {
+        return false;
+      }
+      wait_for([&] { return head != tail_.load(std::memory_order_acquire); });
+    }
+    value = std::move(slots_[head]);
+    head_.store(increment(head), std::memory_order_release);
+    wake();
+    return true;
+  }
+
+  void close() noexcept {
+    closed_.store(true, std::memory_order_release);
+    wake();
+  }
+
+  bool closed() const noexcept { return closed_.load(std::memory_order_acquire); }
+
+ private:
+  std::size_t increment(std::size_t index) const noexcept {
+    return index + 1 == slots_.size() ? 0 : index + 1;
+  }
+
+  /// Sleep until `ready()` or close(); the signal changes after every push/pop/close
+  template <typename Ready>
+  void wait_for(Ready &&ready) {
+    auto const signal = signal_.load(std::memory_order_acquire);
+    if (ready() || closed_.load(std::memory_order_acquire)) {
+      return;
+    }
+    signal_.wait(signal, std::memory_order_acquire);
+  }
+
+  void wake() noexcept {
+    signal_.fetch_add(1, std::memory_order_release);
+    signal_.notify_all();
+  }
+
+  std::vector<T> slots_;
+  alignas(64) std::atomic<std::size_t> head_{0};
+  alignas(64) std::atomic<std::size_t> tail_{0};
+  alignas(64) std::atomic<std::uint32_t> signal_{0};
+  std::atomic<bool> closed_{false};
+};
+
+}  // namespace utils
@@ -0,0 +1,181 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <span>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "byte_buffer.hpp"
+
+namespace utils {
+
+/* Fixed-size pool of worker threads.
+ *
+ *   utils::ThreadPool pool{8};
+ *   auto result = pool.submit([] { return compress(chunk); });
+ *   use(result.get());  // rethrows the task's exception, if any
+ *
+ * Tasks run in submission order (FIFO). The destructor runs the pending
+ * tasks, then joins the workers.
+ */
+class ThreadPool {
+ public:
+  explicit ThreadPool(std::size_t threads = default_threads()) {
+    threads = std::max<std::size_t>(threads, 1);
+    workers_.reserve(threads);
+    for (std::size_t i = 0; i < threads; ++i) {
+      workers_.emplace_back([this] { run(); });
+    }
+  }
+
+  ThreadPool(ThreadPool const &) = delete;
+  ThreadPool &operator=(ThreadPool const &) = delete;
+
+  ~ThreadPool() {
+    {
+      std::lock_guard lock(mutex_);
+      stopping_ = true;
+    }
+    ready_.notify_all();
+    for (auto &worker : workers_) {
+      worker.join();
+    }
+  }
+
+  std::size_t size() const noexcept { return workers_.size(); }
+
+  template <typename F>
+  auto submit(F &&task) -> std::future<std::invoke_result_t<std::decay_t<F>>> {
+    using result_t = std::invoke_result_t<std::decay_t<F>>;
+    // std::function needs a copyable target: the (move-only) task is shared
+    auto packaged = std::make_shared<std::packaged_task<result_t()>>(std::forward<F>(task));
+    auto future = packaged->get_future();
+    {
+      std::lock_guard lock(mutex_);
+      tasks_.emplace_back([packaged] { (*packaged)(); });
+    }
+    ready_.notify_one();
+    return future;
+  }
+
+  static std::size_t default_threads() noexcept {
+    return std::max(1U, std::thread::hardware_concurrency());
+  }
+
+  /// Process-wide pool with one worker per hardware thread
+  static ThreadPool &global() {
+    static ThreadPool pool{};
+    return pool;
+  }
+
+ private:
+  void run() {
+    for (;;) {
+      std::function<void()> task{};
+      {
+        std::unique_lock lock(mutex_);
+        ready_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+        if (tasks_.empty()) {
+          return;  // stopping, and nothing left to run
+        }
+        task = std::move(tasks_.front());
+        tasks_.pop_front();
+      }
+      task();
+    }
+  }
+
+  std::mutex mutex_{};
+  std::condition_variable ready_{};
+  std::deque<std::function<void()>> tasks_{};
+  bool stopping_{false};
+  std::vector<std::thread> workers_{};
+};
+
+/* Buffers produced by pool tasks, written to a stream in submission order.
+ *
+ * At most `max_in_flight` tasks are pending, and their buffers (as announced
+ * to push()) add up to at most `max_bytes_in_flight` unless one task alone
+ * is larger: push() writes the oldest ones (waiting for them) beyond that.
+ * The destructor waits for the pending
+ * tasks without writing them: after an error, they must not outlive the
+ * caller's buffers.
+ */
+class OrderedWriter {
+ public:
+  OrderedWriter(std::ostream &out, std::size_t max_in_flight,
+                std::size_t max_bytes_in_flight = std::numeric_limits<std::size_t>::max())
+      : out_(out), max_in_flight_(std::max<std::size_t>(max_in_flight, 1)), max_bytes_in_flight_(max_bytes_in_flight) {}
+
+  OrderedWriter(OrderedWriter const &) = delete;
+  OrderedWriter &operator=(OrderedWriter const &) = delete;
+
+  ~OrderedWriter() {
+    for (auto const &pending : pending_) {
+      pending.buffer.wait();
+    }
+  }
+
+  /// `bytes`: size of the buffer the task will return
+  void push(std::future<byte_buffer> pending, std::size_t bytes = 0) {
+    while (!pending_.empty() &&
+           (bytes_in_flight_ > max_bytes_in_flight_ || bytes > max_bytes_in_flight_ - bytes_in_flight_)) {
+      write_front();
+    }
+    pending_.push_back({std::move(pending), bytes});
+    bytes_in_flight_ += bytes;
+    while (pending_.size() >= max_in_flight_) {
+      write_front();
+    }
+  }
+
+  /// Write all the pending buffers, and flush
+  void finish() {
+    while (!pending_.empty()) {
+      write_front();
+    }
+    out_.flush();
+  }
+
+  /// Write `data` directly: call finish() first to keep the order
+  void write(std::span<std::byte const> data) {
+    out_.write(reinterpret_cast<char const *>(data.data()), static_cast<std::streamsize>(data.size()));
+    if (!out_) {
+      throw std::runtime_error("OrderedWriter: write failed!");
+    }
+  }
+
+ private:
+  void write_front() {
+    auto pending = std::move(pending_.front());
+    pending_.pop_front();
+    bytes_in_flight_ -= pending.bytes;
+    auto const buffer = pending.buffer.get();
+    write(as_bytes(buffer));
+  }
+
+  struct Pending {
+    std::future<byte_buffer> buffer;
+    std::size_t bytes;
+  };
+
+  std::ostream &out_;
+  std::size_t const max_in_flight_;
+  std::size_t const max_bytes_in_flight_;
+  std::size_t bytes_in_flight_{0};
+  std::deque<Pending> pending_{};
+};
+
+}  // namespace utils
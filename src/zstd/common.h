@@ -25,6 +25,9 @@
 #else
   #define _FILE_OFFSET_BITS 64
   #include <sys/stat.h>
+  #include <sys/mman.h>  // mmap, madvise
+  #include <fcntl.h>     // open
+  #include <unistd.h>    // close
   typedef struct stat stat_t;
   #define stat_func stat
 #endif
@@ -54,6 +57,7 @@ typedef enum {
     ERROR_saveFile = 7,
     ERROR_malloc = 8,
     ERROR_largeFile = 9,
+    ERROR_mmap = 10,
 } COMMON_ErrorCode;
 
 /*! CHECK
@@ -241,6 +245,54 @@ HEADER_FUNCTION void* mallocAndLoadFile_orDie(const char* fileName, size_t* buff
     return buffer;
 }
 
+/*! mapFile_orDie() :
+ * map a file into memory (read-only), instead of copying it into a buffer.
+ * The pages are read on first access, with sequential readahead.
+ * Release with unmapFile(). (Without mmap, same as mallocAndLoadFile_orDie().)
+ *
+ * Note: This function will send an error to stderr and exit if it
+ * cannot map the given file path.
+ *
+ * @return If successful this function will return the mapping and
+ * bufferSize(=fileSize), otherwise it will printout an error to stderr and exit.
+ */
+HEADER_FUNCTION const void* mapFile_orDie(const char* fileName, size_t* bufferSize)
+{
+#ifdef _WIN32
+    return mallocAndLoadFile_orDie(fileName, bufferSize);
+#else
+    size_t const fileSize = fsize_orDie(fileName);
+    *bufferSize = fileSize;
+    if (fileSize == 0) return NULL;   /* nothing to map */
+    int const fd = open(fileName, O_RDONLY);
+    if (fd < 0) {
+        perror(fileName);
+        exit(ERROR_fopen);
+    }
+    void* const buffer = mmap(NULL, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);   /* the mapping keeps the file open */
+    if (buffer == MAP_FAILED) {
+        perror(fileName);
+        exit(ERROR_mmap);
+    }
+    madvise(buffer, fileSize, MADV_SEQUENTIAL);   /* only a hint */
+    return buffer;
+#endif
+}
+
+/*! unmapFile() :
+ * release a buffer returned by mapFile_orDie().
+ */
+HEADER_FUNCTION void unmapFile(const void* buffer, size_t bufferSize)
+{
+#ifdef _WIN32
+    (void)bufferSize;
+    free((void*)buffer);
+#else
+    if (buffer != NULL) munmap((void*)buffer, bufferSize);
+#endif
+}
+
 /*! saveFile_orDie() :
  *
  * Save buffSize bytes to a given file path, obtaining them from a location pointed
@@ -17,7 +17,7 @@
 static void compress_orDie(const char* fname, const char* oname)
 {
     size_t fSize;
-    void* const fBuff = mallocAndLoadFile_orDie(fname, &fSize);
+    const void* const fBuff = mapFile_orDie(fname, &fSize);
     size_t const cBuffSize = ZSTD_compressBound(fSize);
     void* const cBuff = malloc_orDie(cBuffSize);
 
@@ -33,7 +33,7 @@ static void compress_orDie(const char* fname, const char* oname)
     /* success */
     printf("%25s : %6u -> %7u - %s \n", fname, (unsigned)fSize, (unsigned)cSize, oname);
 
-    free(fBuff);
+    unmapFile(fBuff, fSize);
     free(cBuff);
 }
 
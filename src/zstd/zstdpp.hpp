@@ -1,44 +1,88 @@
 #pragma once
 
+#include <algorithm>
 #include <cstddef>
 #include <iostream>
 #include <string>
 #include <vector>
 #include <cstdint>
+#include <cstdio>
 #include <fstream>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
 
-#include <zstd.h>
+#include <zstd_errors.h>
+
+#include "../byte_buffer.hpp"
+#include "../mapped_file.hpp"
+#include "zstdpp_params.hpp"
+#include "zstdpp_pool.hpp"
 
 namespace zstdpp {
 
 using byte_t = std::uint8_t;
-using compress_level_t = std::uint8_t;
+using compress_level_t = int; // ZSTD_minCLevel() (negative: fast) .. ZSTD_maxCLevel()
 using threads_number_t = std::uint8_t;
-using buffer_t = std::vector<byte_t>;
+using buffer_t = ::utils::byte_buffer; // std::vector without zero-fill on resize()
 using string_t = std::string;
 using size_buffer_t = std::size_t;
+using rospan_t = std::span<const std::byte>;
+using span_t = std::span<std::byte>;
+using Error = ZSTD_ErrorCode;
 
-namespace utils{
+/* Result of the non-allocating functions: a size, or an error.
+ * (subset of C++23 `std::expected<size_buffer_t, Error>`)
+ */
+class Result {
+  public:
+    Result(size_buffer_t size) noexcept : size_(size) {}
     
-    inline buffer_t to_bytes(std::string const& str){
-        buffer_t bytes{};
-        bytes.reserve(str.size());
+    /// Wrap a size_t returned by libzstd, which may encode an error.
+    static Result from_zstd(size_t code) noexcept {
+        return ZSTD_isError(code) ? failure(ZSTD_getErrorCode(code)) : Result(code);
+    }
+    static Result failure(Error error) noexcept {
+        Result r{0};
+        r.error_ = error;
+        return r;
+    }
+    
+    bool has_value() const noexcept { return error_ == ZSTD_error_no_error; }
+    explicit operator bool() const noexcept { return has_value(); }
+    size_buffer_t operator*() const noexcept { return size_; }
+    Error error() const noexcept { return error_; }
+    char const* message() const noexcept { return ZSTD_getErrorString(error_); }
     
-        for (auto const& c : str) {
-            bytes.push_back(c);
+    /// The size, or throws std::runtime_error on error.
+    size_buffer_t value() const {
+        if (!has_value()) {
+            throw std::runtime_error(message());
         }
-        return bytes;
+        return size_;
+    }
+    
+  private:
+    size_buffer_t size_;
+    Error error_{ZSTD_error_no_error};
+};
+
+namespace utils{
+    
+    inline buffer_t to_bytes(std::string const& str){
+        return buffer_t(str.begin(), str.end());
     }
     
     inline string_t to_string(buffer_t const& bytes){
-        string_t str{};
-        str.reserve(bytes.size());
-        for (auto const& byte : bytes) {
-            str.push_back(byte);
-        }
-        return str;
+        return string_t(bytes.begin(), bytes.end());
     }
     
+    /* Views on bytes (no copy) */
+    
+    using ::utils::as_bytes;
+    using ::utils::as_writable_bytes;
+    
 } // namespace utils
 
 namespace stream{
@@ -75,39 +119,64 @@ namespace stream{
     struct Context{
         
         /// Default is decompression
-        Context(): compress_ctx(NULL), decompress_ctx(ZSTD_createDCtx()) {
-            if (decompress_ctx == NULL) {
-                throw std::runtime_error("ZSTD_createCCtx() failed!");
-            }
-        }
+        Context(): Context(ContextPool::DCtxLease(ZSTD_createDCtx())) {}
+        
+        /// Decompression with a context drawn from `pool`
+        explicit Context(ContextPool& pool): Context(pool.acquire_dctx()) {}
         
         /// Compression with specified level
         Context(compress_level_t compress_level, threads_number_t nThreads)
-        : compress_ctx(ZSTD_createCCtx()), decompress_ctx(NULL) {
-            if (compress_ctx == NULL) {
-                throw std::runtime_error("ZSTD_createCCtx() failed!");
-            }
-            
-            /* Set the compression level, and enable the checksum. */
-            ZSTD_CCtx_setParameter(compress_ctx, ZSTD_c_compressionLevel, 3);
-            ZSTD_CCtx_setParameter(compress_ctx, ZSTD_c_checksumFlag, 1);
-            
-            /* Config if required workers */
-            size_t const r = ZSTD_CCtx_setParameter(compress_ctx, ZSTD_c_nbWorkers, nThreads);
-            if (ZSTD_isError(r)) {
-                std::cerr << "Note: the linked libzstd library doesn't support multithreading. \n"
-                          << "\tReverting to single-thread mode. \n" << std::endl;
-            }
+        : Context(default_params(compress_level, nThreads)) {}
+        
+        /// Compression with specified level, with a context drawn from `pool`
+        Context(ContextPool& pool, compress_level_t compress_level, threads_number_t nThreads)
+        : Context(pool, default_params(compress_level, nThreads)) {}
+        
+        /// Compression with full parameters
+        explicit Context(Params const& params)
+        : Context(ContextPool::CCtxLease(ZSTD_createCCtx()), params) {}
+        
+        /// Compression with full parameters, with a context drawn from `pool`
+        Context(ContextPool& pool, Params const& params)
+        : Context(pool.acquire_cctx(), params) {}
+        
+        /// Raise the decompression limits (window size) to accept frames made with `params`
+        Context& with_limits(Params const& params){
+            params.apply(decompress_ctx.get());
+            return *this;
         }
         
-        ~Context(){
-            // Free the context
-            if (compress_ctx != NULL){
-                ZSTD_freeCCtx(compress_ctx);
+        /// Parameters used by the streaming functions when only a level is given
+        static Params default_params(compress_level_t compress_level, threads_number_t nThreads){
+            return Params{}.level(compress_level).checksum().workers(nThreads);
+        }
+        
+        /// Change the compression level mid-stream: applied from the next job with
+        /// workers, from the next frame without (see adaptive::compress)
+        void set_level(compress_level_t compress_level){
+            auto const ret = ZSTD_CCtx_setParameter(compress_ctx.get(), ZSTD_c_compressionLevel, compress_level);
+            if (ZSTD_isError(ret)) {
+                throw std::runtime_error(ZSTD_getErrorName(ret));
             }
-            
-            if (decompress_ctx != NULL) {
-                ZSTD_freeDCtx(decompress_ctx);
+        }
+        
+        /// Whether compression runs on worker threads (ZSTD_c_nbWorkers >= 1)
+        bool multithreaded() const {
+            int workers = 0;
+            ZSTD_CCtx_getParameter(compress_ctx.get(), ZSTD_c_nbWorkers, &workers);
+            return workers > 0;
+        }
+        
+        /// Progress of the current frame (input ingested, consumed by the workers, output produced...)
+        ZSTD_frameProgression progression() const {
+            return ZSTD_getFrameProgression(compress_ctx.get());
+        }
+        
+        /// Announce the total input size (stored in the frame header) before compressing
+        void pledge_size(unsigned long long size){
+            auto const ret = ZSTD_CCtx_setPledgedSrcSize(compress_ctx.get(), size);
+            if (ZSTD_isError(ret)) {
+                throw std::runtime_error(ZSTD_getErrorName(ret));
             }
         }
         
@@ -117,7 +186,7 @@ namespace stream{
             ZSTD_EndDirective const& mode
         ){
             return ZSTD_compressStream2(
-                compress_ctx, 
+                compress_ctx.get(), 
                 &out, 
                 &in, 
                 mode
@@ -127,22 +196,31 @@ namespace stream{
         size_t operator()(
             ZSTD_inBuffer& in,
             ZSTD_outBuffer& out
-        ){ return ZSTD_decompressStream(decompress_ctx, &out , &in); }
+        ){ return ZSTD_decompressStream(decompress_ctx.get(), &out , &in); }
         
         private:
-            ZSTD_CCtx* const compress_ctx;
-            ZSTD_DCtx* const decompress_ctx;
+            explicit Context(ContextPool::DCtxLease dctx): decompress_ctx(std::move(dctx)) {
+                if (!decompress_ctx) {
+                    throw std::runtime_error("ZSTD_createDCtx() failed!");
+                }
+            }
+            
+            Context(ContextPool::CCtxLease cctx, Params const& params)
+            : compress_ctx(std::move(cctx)) {
+                if (!compress_ctx) {
+                    throw std::runtime_error("ZSTD_createCCtx() failed!");
+                }
+                params.apply(compress_ctx.get());
+            }
+            
+            ContextPool::CCtxLease compress_ctx{};
+            ContextPool::DCtxLease decompress_ctx{};
     };
     
-    inline void compress(
-        std::istream& in, 
-        std::ostream& out, 
-        threads_number_t nThreads = 1,
-        compress_level_t compress_level = 3
-    ){
+    /// Compress `in` to `out` with an already configured compression context
+    inline void compress(Context& ctx, std::istream& in, std::ostream& out){
         
         Resources res{};
-        Context ctx(compress_level, nThreads);
         
         /* Loop for read chunks & write to output */
         size_t const toRead = res.getToRead();
@@ -160,6 +238,9 @@ namespace stream{
             do{
                 ZSTD_outBuffer output = { res.getRawOutData(), res.getToWrite(), 0 };
                 size_t const remaining = ctx(input,output,mode); // perform compression
+                if (ZSTD_isError(remaining)) {
+                    throw std::runtime_error(ZSTD_getErrorName(remaining));
+                }
                 
                 res.writeTo(out, output.pos);
                 
@@ -179,13 +260,88 @@ namespace stream{
         
     }
     
-    inline void decompress(
+    namespace detail {
+        /// Slice of input handed to zstd per call, so that readahead can be requested ahead of it
+        inline constexpr size_buffer_t in_place_slice = size_buffer_t{4} << 20;
+        
+        template <typename Prefetch>
+        inline void compress_in_place(Context& ctx, rospan_t in, std::ostream& out, Prefetch&& prefetch){
+            buffer_t buffOut{};
+            buffOut.resize(ZSTD_CStreamOutSize());
+            ctx.pledge_size(in.size());
+            
+            size_buffer_t pos = 0;
+            bool finished = false;
+            while (!finished) {
+                auto const slice = std::min(in_place_slice, in.size() - pos);
+                prefetch(pos + slice, in_place_slice);
+                bool const isLastSlice = pos + slice == in.size();
+                ZSTD_EndDirective const mode = isLastSlice ? ZSTD_e_end : ZSTD_e_continue;
+                
+                /* zstd reads the slice where it is: no copy into an input buffer */
+                ZSTD_inBuffer input = { in.data() + pos, slice, 0 };
+                do{
+                    ZSTD_outBuffer output = { buffOut.data(), buffOut.size(), 0 };
+                    size_t const remaining = ctx(input, output, mode);
+                    if (ZSTD_isError(remaining)) {
+                        throw std::runtime_error(ZSTD_getErrorName(remaining));
+                    }
+                    out.write((char*)buffOut.data(), output.pos);
+                    finished = isLastSlice && remaining == 0;
+                }while(input.pos != input.size || (isLastSlice && !finished));
+                pos += slice;
+            }
+        }
+    } // namespace detail
+    
+    /// Compress an in-memory input with a compression context; zstd reads it in place
+    inline void compress(Context& ctx, rospan_t in, std::ostream& out){
+        detail::compress_in_place(ctx, in, out, [](size_buffer_t, size_buffer_t){});
+    }
+    
+    /// Compress a memory-mapped file, asking for the readahead of the next slice
+    inline void compress(Context& ctx, ::utils::MappedFile const& in, std::ostream& out){
+        detail::compress_in_place(ctx, in.bytes(), out, [&in](size_buffer_t offset, size_buffer_t length){
+            in.will_need(offset, length);
+        });
+    }
+    
+    inline void compress(
         std::istream& in, 
         std::ostream& out, 
-        threads_number_t nThreads = 1
+        threads_number_t nThreads = 1,
+        compress_level_t compress_level = 3
     ){
+        Context ctx(compress_level, nThreads);
+        compress(ctx, in, out);
+    }
+    
+    /// Same as above, drawing the compression context from `pool`
+    inline void compress(
+        ContextPool& pool,
+        std::istream& in, 
+        std::ostream& out, 
+        threads_number_t nThreads = 1,
+        compress_level_t compress_level = 3
+    ){
+        Context ctx(pool, compress_level, nThreads);
+        compress(ctx, in, out);
+    }
+    
+    /// Compress with full parameters (level, window, long-distance matching, workers...)
+    inline void compress(std::istream& in, std::ostream& out, Params const& params){
+        Context ctx(params);
+        compress(ctx, in, out);
+    }
+    
+    inline void compress(ContextPool& pool, std::istream& in, std::ostream& out, Params const& params){
+        Context ctx(pool, params);
+        compress(ctx, in, out);
+    }
+    
+    /// Decompress `in` to `out` with a decompression context
+    inline void decompress(Context& ctx, std::istream& in, std::ostream& out){
         Resources res{};
-        Context ctx{};
         
         size_t const toRead = res.getToRead();
         size_t read;
@@ -206,6 +362,9 @@ namespace stream{
             while (input.pos < input.size) {
                 ZSTD_outBuffer output = { res.getRawOutData(), res.getToWrite(), 0 };
                 size_t const ret = ctx(input, output); // perform decompression
+                if (ZSTD_isError(ret)) {
+                    throw std::runtime_error(ZSTD_getErrorName(ret));
+                }
                 
                 res.writeTo(out, output.pos);
                 lastRet = ret;
@@ -218,43 +377,247 @@ namespace stream{
         
     }
     
+    /// Decompress an in-memory input with a decompression context
+    inline void decompress(Context& ctx, rospan_t in, std::ostream& out){
+        buffer_t buffOut{};
+        buffOut.resize(ZSTD_DStreamOutSize());
+        ZSTD_inBuffer input = { in.data(), in.size(), 0 };
+        size_t lastRet = 0;
+        while (input.pos < input.size) {
+            ZSTD_outBuffer output = { buffOut.data(), buffOut.size(), 0 };
+            lastRet = ctx(input, output);
+            if (ZSTD_isError(lastRet)) {
+                throw std::runtime_error(ZSTD_getErrorName(lastRet));
+            }
+            out.write((char*)buffOut.data(), output.pos);
+        }
+        if (lastRet != 0) {
+            throw std::runtime_error("Error: zstd only returns 0 when the input is completely consumed!");
+        }
+    }
+    
+    /// `nThreads` is unused: libzstd decodes on one thread (see zstdpp_parallel.hpp for multi-frame inputs)
+    inline void decompress(
+        std::istream& in, 
+        std::ostream& out, 
+        threads_number_t nThreads = 1
+    ){
+        Context ctx{};
+        decompress(ctx, in, out);
+    }
+    
+    /// Same as above, drawing the decompression context from `pool`
+    inline void decompress(ContextPool& pool, std::istream& in, std::ostream& out){
+        Context ctx(pool);
+        decompress(ctx, in, out);
+    }
+    
+    /// Decompress frames produced with `params` (e.g. with a window larger than 128 MiB)
+    inline void decompress(std::istream& in, std::ostream& out, Params const& params){
+        Context ctx{};
+        decompress(ctx.with_limits(params), in, out);
+    }
+    
+    /* File functions
+     *
+     * The input file is memory-mapped and read in place by zstd. When the
+     * decompressed size is known from the frame headers, the output file is
+     * sized up front and decompressed into its mapping (no iostream nor
+     * intermediate buffer). That size is only trusted when the input could
+     * hold it: at most ZSTD_decompressBound(), and at most one full block per
+     * 4 input bytes (the smallest RLE block). The output file is removed when
+     * decompression fails.
+     */
     
+    inline void compress_file(Context& ctx, string_t const& in, string_t const& out){
+        ::utils::MappedFile const in_file(in, ::utils::MappedFile::Access::sequential);
+        std::ofstream out_file(out, std::ios::binary);
+        compress(ctx, in_file, out_file);
+    }
+    
+    namespace detail {
+        /// Content size from the frame headers if the input can hold it, else ZSTD_CONTENTSIZE_UNKNOWN
+        inline unsigned long long bounded_content_size(rospan_t in) noexcept {
+            auto const size = ZSTD_findDecompressedSize(in.data(), in.size());
+            if (size == ZSTD_CONTENTSIZE_UNKNOWN || size == ZSTD_CONTENTSIZE_ERROR) {
+                return ZSTD_CONTENTSIZE_UNKNOWN;
+            }
+            auto const bound = ZSTD_decompressBound(in.data(), in.size());
+            auto const blocks = static_cast<unsigned long long>(in.size() / 4 + 1);
+            if (bound == ZSTD_CONTENTSIZE_ERROR || size > bound || size / ZSTD_BLOCKSIZE_MAX >= blocks) {
+                return ZSTD_CONTENTSIZE_UNKNOWN;
+            }
+            return size;
+        }
+    } // namespace detail
+
+    inline void decompress_file(Context& ctx, string_t const& in, string_t const& out){
+        ::utils::MappedFile const in_file(in, ::utils::MappedFile::Access::sequential);
+#if defined(UTILS_HAS_MMAP)
+        auto const size = detail::bounded_content_size(in_file.bytes());
+        if (size != ZSTD_CONTENTSIZE_UNKNOWN) {
+            ::utils::MappedOutput out_file(out, static_cast<size_buffer_t>(size));
+            ZSTD_inBuffer input = { in_file.data(), in_file.size(), 0 };
+            ZSTD_outBuffer output = { out_file.bytes().data(), out_file.size(), 0 };
+            size_t lastRet = 0;
+            while (input.pos < input.size) {
+                lastRet = ctx(input, output);
+                if (ZSTD_isError(lastRet)) {
+                    throw std::runtime_error(ZSTD_getErrorName(lastRet));
+                }
+                if (output.pos == output.size && input.pos < input.size && lastRet != 0) {
+                    throw std::runtime_error("Error: zstd frames are larger than their content size!");
+                }
+            }
+            if (lastRet != 0 || output.pos != output.size) {
+                throw std::runtime_error("Error: zstd only returns 0 when the input is completely consumed!");
+            }
+            out_file.finish(output.pos);
+            return;
+        }
+#endif
+        std::ofstream out_file(out, std::ios::binary);
+        try {
+            decompress(ctx, in_file.bytes(), out_file);
+        } catch (...) {
+            out_file.close();
+            std::remove(out.c_str());
+            throw;
+        }
+    }
     
 } // namespace stream
 
-/* In-place compression */
+/* Non-allocating functions on caller-owned buffers
+ *
+ * `dst` must be large enough: compress_bound(src.size()) for compression,
+ * the frame content size (see decompressed_size()) for decompression.
+ * Contexts are taken from ContextPool::global() unless given explicitly.
+ */
+
+inline size_buffer_t compress_bound(size_buffer_t src_size) noexcept {
+    return ZSTD_compressBound(src_size);
+}
+
+/// Content size stored in the frame header (error if absent or invalid).
+inline Result decompressed_size(rospan_t src) noexcept {
+    auto const size = ZSTD_getFrameContentSize(src.data(), src.size());
+    if (size == ZSTD_CONTENTSIZE_ERROR) {
+        return Result::failure(ZSTD_error_prefix_unknown);
+    }
+    if (size == ZSTD_CONTENTSIZE_UNKNOWN) {
+        return Result::failure(ZSTD_error_frameParameter_unsupported);
+    }
+    return Result(static_cast<size_buffer_t>(size));
+}
+
+/// Invalid parameters are returned as errors too (Params::try_apply)
+inline Result compress_into(ZSTD_CCtx* cctx, rospan_t src, span_t dst, Params const& params) noexcept {
+    if (auto const r = params.try_apply(cctx); ZSTD_isError(r)) {
+        return Result::from_zstd(r);
+    }
+    return Result::from_zstd(ZSTD_compress2(cctx, dst.data(), dst.size(), src.data(), src.size()));
+}
+
+inline Result compress_into(ContextPool& pool, rospan_t src, span_t dst, Params const& params) {
+    auto const cctx = pool.acquire_cctx();
+    return compress_into(cctx.get(), src, dst, params);
+}
+
+inline Result compress_into(rospan_t src, span_t dst, Params const& params) {
+    return compress_into(ContextPool::global(), src, dst, params);
+}
+
+inline Result compress_into(rospan_t src, span_t dst, compress_level_t compress_level = 3) {
+    return compress_into(src, dst, Params{}.level(compress_level));
+}
+
+inline Result compress_into(std::string_view src, span_t dst, compress_level_t compress_level = 3) {
+    return compress_into(utils::as_bytes(src), dst, compress_level);
+}
+
+inline Result decompress_into(ZSTD_DCtx* dctx, rospan_t src, span_t dst) noexcept {
+    return Result::from_zstd(ZSTD_decompressDCtx(dctx, dst.data(), dst.size(), src.data(), src.size()));
+}
+
+inline Result decompress_into(ContextPool& pool, rospan_t src, span_t dst) {
+    auto const dctx = pool.acquire_dctx();
+    return decompress_into(dctx.get(), src, dst);
+}
+
+inline Result decompress_into(rospan_t src, span_t dst) {
+    return decompress_into(ContextPool::global(), src, dst);
+}
+
+/* In-place compression (on top of the non-allocating functions)
+ *
+ * The output buffer keeps its capacity (worst-case bound), so reusing it for
+ * the next call does not allocate. The by-value functions below return
+ * buffers shrunk to their size instead.
+ */
 namespace inplace{
     
+    /// Compress `data` into `buffer`, resized to the compressed size
     inline size_buffer_t compress(
-        buffer_t const& data,
+        ContextPool& pool,
+        rospan_t data,
         buffer_t& buffer,
-        compress_level_t compress_level = 3
+        Params const& params
     ) {
-      size_t est_compress_size = ZSTD_compressBound(data.size());
+      buffer.resize(compress_bound(data.size()));
     
-      buffer.resize(est_compress_size);
+      auto const compress_size =
+          compress_into(pool, data, utils::as_writable_bytes(buffer), params).value();
     
-      auto compress_size = ZSTD_compress((void*)buffer.data(), est_compress_size,
-                                         data.data(), data.size(), compress_level);
+      buffer.resize(compress_size); // keeps the capacity for reuse
     
-      buffer.resize(compress_size);
-      buffer.shrink_to_fit();
+      return compress_size;
+    }
     
-      return buffer.size();
+    inline size_buffer_t compress(
+        ContextPool& pool,
+        buffer_t const& data,
+        buffer_t& buffer,
+        compress_level_t compress_level = 3
+    ) {
+      return compress(pool, utils::as_bytes(data), buffer, Params{}.level(compress_level));
     }
     
-    inline size_buffer_t decompress(buffer_t &data, buffer_t& out_buffer) {
-      auto const est_decomp_size =
-          ZSTD_getFrameContentSize(data.data(), data.size());
+    inline size_buffer_t compress(
+        buffer_t const& data,
+        buffer_t& buffer,
+        Params const& params
+    ) {
+      return compress(ContextPool::global(), utils::as_bytes(data), buffer, params);
+    }
+    
+    inline size_buffer_t compress(
+        buffer_t const& data,
+        buffer_t& buffer,
+        compress_level_t compress_level = 3
+    ) {
+      return compress(data, buffer, Params{}.level(compress_level));
+    }
+    
+    /// Decompress a frame which stores its content size into `out_buffer`
+    inline size_buffer_t decompress(ContextPool& pool, rospan_t data, buffer_t& out_buffer) {
+      auto const est_decomp_size = decompressed_size(data).value();
       out_buffer.resize(est_decomp_size);
     
-      size_t const decomp_size = ZSTD_decompress(
-          (void*)out_buffer.data(), est_decomp_size, data.data(), data.size());
+      auto const decomp_size =
+          decompress_into(pool, data, utils::as_writable_bytes(out_buffer)).value();
     
       out_buffer.resize(decomp_size);
-      out_buffer.shrink_to_fit();
       return decomp_size;
     }
+    
+    inline size_buffer_t decompress(ContextPool& pool, buffer_t const& data, buffer_t& out_buffer) {
+      return decompress(pool, utils::as_bytes(data), out_buffer);
+    }
+    
+    inline size_buffer_t decompress(buffer_t const& data, buffer_t& out_buffer) {
+      return decompress(ContextPool::global(), utils::as_bytes(data), out_buffer);
+    }
 }
 
 /* Streaming Functions */
@@ -265,44 +628,83 @@ inline void stream_compress(
     threads_number_t nThreads = 1,
     compress_level_t compress_level = 3
 ){
-    std::ifstream in_file(in, std::ios::binary);
-    std::ofstream out_file(out, std::ios::binary);
-    stream::compress(in_file, out_file, nThreads, compress_level);
+    stream::Context ctx(compress_level, nThreads);
+    stream::compress_file(ctx, in, out);
+}
+
+inline void stream_compress(string_t const& in, string_t const& out, Params const& params){
+    stream::Context ctx(params);
+    stream::compress_file(ctx, in, out);
 }
 
 inline void stream_decompress(
     string_t const& in, 
     string_t const& out
 ){
-    std::ifstream in_file(in, std::ios::binary);
-    std::ofstream out_file(out, std::ios::binary);
-    stream::decompress(in_file, out_file);
+    stream::Context ctx{};
+    stream::decompress_file(ctx, in, out);
+}
+
+inline void stream_decompress(string_t const& in, string_t const& out, Params const& params){
+    stream::Context ctx{};
+    stream::decompress_file(ctx.with_limits(params), in, out);
 }
 
 /* Principal functions using inplace functions */
 
 inline buffer_t compress( buffer_t const& data, compress_level_t compress_level = 3 ){
     buffer_t comp_buffer{};
-    size_t est_compress_size = inplace::compress(data, comp_buffer);
+    inplace::compress(data, comp_buffer, compress_level);
+    comp_buffer.shrink_to_fit();
     return comp_buffer;
 }
 
-inline buffer_t decompress(buffer_t &data) {
+inline buffer_t compress( buffer_t const& data, Params const& params ){
+    buffer_t comp_buffer{};
+    inplace::compress(data, comp_buffer, params);
+    comp_buffer.shrink_to_fit();
+    return comp_buffer;
+}
+
+inline buffer_t decompress(buffer_t const& data) {
   buffer_t decomp_buffer{};
-  auto const est_decomp_size = inplace::decompress(data, decomp_buffer);
+  inplace::decompress(data, decomp_buffer);
   return decomp_buffer;
 }
 
-/* Re-Using compress/decompress functions with buffer_t for receive strings like data */
+inline buffer_t compress( ContextPool& pool, buffer_t const& data, compress_level_t compress_level = 3 ){
+    buffer_t comp_buffer{};
+    inplace::compress(pool, data, comp_buffer, compress_level);
+    comp_buffer.shrink_to_fit();
+    return comp_buffer;
+}
+
+inline buffer_t compress( ContextPool& pool, buffer_t const& data, Params const& params ){
+    buffer_t comp_buffer{};
+    inplace::compress(pool, utils::as_bytes(data), comp_buffer, params);
+    comp_buffer.shrink_to_fit();
+    return comp_buffer;
+}
 
-inline buffer_t compress(const string_t data, compress_level_t compress_level) {
-    auto comp_buffer = utils::to_bytes(data);
-    return compress(comp_buffer, compress_level);
+inline buffer_t decompress( ContextPool& pool, buffer_t const& data ){
+    buffer_t decomp_buffer{};
+    inplace::decompress(pool, data, decomp_buffer);
+    return decomp_buffer;
+}
+
+/* String-like data is viewed as bytes, without an intermediate copy */
+
+inline buffer_t compress(std::string_view data, compress_level_t compress_level) {
+    buffer_t comp_buffer{};
+    inplace::compress(ContextPool::global(), utils::as_bytes(data), comp_buffer, Params{}.level(compress_level));
+    comp_buffer.shrink_to_fit();
+    return comp_buffer;
 }
 
-inline buffer_t decompress(string_t data) {
-    auto buffer = utils::to_bytes(data);
-    return decompress(buffer);
+inline buffer_t decompress(std::string_view data) {
+    buffer_t decomp_buffer{};
+    inplace::decompress(ContextPool::global(), utils::as_bytes(data), decomp_buffer);
+    return decomp_buffer;
 }
 
 
@@ -0,0 +1,194 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+#include "zstdpp.hpp"
+
+/* Adaptive compression level (like `zstd --adaptive`)
+ *
+ * stream::compress with a fixed level either starves a fast destination
+ * (the level is too high) or wastes CPU on a slow one (too low). Here the
+ * time spent reading the input, compressing and writing the output is
+ * measured over every `window` bytes of input:
+ *
+ * - compression takes longer than the I/O: the level is lowered;
+ * - the I/O (a slow destination, or source) takes longer: the level is
+ *   raised, since the CPU would be waiting anyway.
+ *
+ * The level stays within [min_level, max_level]. With workers (the default:
+ * ZSTD_c_nbWorkers >= 1) a new level applies from the next job of the same
+ * frame, so after a change the next decision waits until the workers have
+ * consumed the input up to it (ZSTD_getFrameProgression): the output of
+ * older jobs would say nothing about the new level. Without workers the
+ * current frame is ended first, so the output may be several frames (still
+ * a valid zstd stream).
+ */
+namespace zstdpp {
+namespace adaptive {
+
+    struct Options {
+        compress_level_t min_level = 1;
+        compress_level_t max_level = 19;
+        size_buffer_t window = size_buffer_t{4} << 20; ///< input bytes between two decisions
+        double hysteresis = 0.25;                      ///< required imbalance, e.g. 25% slower
+    };
+
+    struct LevelChange {
+        std::uint64_t input_offset;      ///< input bytes consumed before the change
+        compress_level_t level;
+    };
+
+    struct Stats {
+        std::vector<LevelChange> levels{}; ///< the initial level at offset 0, then every change
+        std::uint64_t bytes_in{0};
+        std::uint64_t bytes_out{0};
+        double read_seconds{0};
+        double compress_seconds{0};
+        double write_seconds{0};
+
+        compress_level_t final_level() const { return levels.empty() ? 0 : levels.back().level; }
+    };
+
+    namespace detail {
+
+        template <typename Clock>
+        inline double seconds_since(typename Clock::time_point start){
+            return std::chrono::duration<double>(Clock::now() - start).count();
+        }
+
+        /// Times of the current window
+        struct Window {
+            size_buffer_t bytes{0};
+            size_buffer_t bytes_out{0};
+            double io_seconds{0};
+            double compress_seconds{0};
+        };
+
+        /// The next level after `window`, from which of the I/O or the compression was slower
+        inline compress_level_t next_level(compress_level_t level, Window const& window, Options const& options){
+            if (window.compress_seconds > window.io_seconds * (1 + options.hysteresis)) {
+                return std::max(level - 1, options.min_level);
+            }
+            if (window.io_seconds > window.compress_seconds * (1 + options.hysteresis)) {
+                return std::min(level + 1, options.max_level);
+            }
+            return level;
+        }
+
+    } // namespace detail
+
+    /// Compress `in` to `out` with a compression context, starting at `start_level`.
+    /// `Clock` times the I/O and the compression (tests may pass a simulated one).
+    template <typename Clock = std::chrono::steady_clock>
+    inline Stats compress(stream::Context& ctx, std::istream& in, std::ostream& out,
+                          compress_level_t start_level, Options const& options = {}){
+        if (options.min_level > options.max_level) {
+            throw std::invalid_argument("zstdpp::adaptive: min_level > max_level");
+        }
+        Stats stats{};
+        auto level = std::clamp(start_level, options.min_level, options.max_level);
+        ctx.set_level(level);
+        stats.levels.push_back({0, level});
+        bool const multithreaded = ctx.multithreaded();
+
+        buffer_t buffIn{};
+        buffIn.resize(ZSTD_CStreamInSize());
+        buffer_t buffOut{};
+        buffOut.resize(ZSTD_CStreamOutSize());
+        detail::Window window{};
+        std::uint64_t settled_at = 0; // frame input offset from which the last change shows in the output
+
+        // run `mode` over `input` until it is consumed (and flushed, for ZSTD_e_end)
+        auto const run = [&](ZSTD_inBuffer& input, ZSTD_EndDirective mode){
+            bool finished = false;
+            do {
+                ZSTD_outBuffer output = { buffOut.data(), buffOut.size(), 0 };
+                auto start = Clock::now();
+                size_t const remaining = ctx(input, output, mode);
+                if (ZSTD_isError(remaining)) {
+                    throw std::runtime_error(ZSTD_getErrorName(remaining));
+                }
+                auto const compress_seconds = detail::seconds_since<Clock>(start);
+
+                start = Clock::now();
+                out.write(reinterpret_cast<char const*>(buffOut.data()), static_cast<std::streamsize>(output.pos));
+                if (!out) {
+                    throw std::runtime_error("zstdpp::adaptive: write failed!");
+                }
+                auto const write_seconds = detail::seconds_since<Clock>(start);
+
+                stats.bytes_out += output.pos;
+                stats.compress_seconds += compress_seconds;
+                stats.write_seconds += write_seconds;
+                window.compress_seconds += compress_seconds;
+                window.io_seconds += write_seconds;
+                window.bytes_out += output.pos;
+                finished = mode == ZSTD_e_end ? remaining == 0 : input.pos == input.size;
+            } while (!finished);
+        };
+
+        for (bool last = false; !last;) {
+            auto const start = Clock::now();
+            in.read(reinterpret_cast<char*>(buffIn.data()), static_cast<std::streamsize>(buffIn.size()));
+            if (in.bad()) {
+                throw std::runtime_error("zstdpp::adaptive: read failed!");
+            }
+            auto const read = static_cast<size_buffer_t>(in.gcount());
+            auto const read_seconds = detail::seconds_since<Clock>(start);
+            stats.read_seconds += read_seconds;
+            window.io_seconds += read_seconds;
+            last = read < buffIn.size();
+
+            ZSTD_inBuffer input = { buffIn.data(), read, 0 };
+            run(input, last ? ZSTD_e_end : ZSTD_e_continue);
+            stats.bytes_in += read;
+            window.bytes += read;
+
+            if (last || window.bytes < options.window) {
+                continue;
+            }
+            if (multithreaded && ctx.progression().consumed < settled_at) {
+                window = {}; // still the jobs compressed at the previous level
+                continue;
+            }
+            // with workers, the first output comes jobs later: no write time to compare with until then
+            if (window.bytes_out == 0) {
+                continue;
+            }
+            auto const next = detail::next_level(level, window, options);
+            if (next != level) {
+                if (multithreaded) {
+                    settled_at = ctx.progression().ingested;
+                } else { // single-threaded: the level only changes between frames
+                    ZSTD_inBuffer none = { nullptr, 0, 0 };
+                    run(none, ZSTD_e_end);
+                }
+                level = next;
+                ctx.set_level(level);
+                stats.levels.push_back({stats.bytes_in, level});
+            }
+            window = {};
+        }
+        return stats;
+    }
+
+    /// `params` sets everything but the level, which starts at params.level() (3 by default)
+    inline Stats compress(std::istream& in, std::ostream& out, Params const& params = Params{}.checksum().workers(1),
+                          Options const& options = {}){
+        stream::Context ctx(params);
+        return compress(ctx, in, out, params.level().value_or(3), options);
+    }
+
+    inline Stats compress(std::istream& in, std::ostream& out, compress_level_t start_level,
+                          threads_number_t nThreads = 1, Options const& options = {}){
+        stream::Context ctx(start_level, nThreads);
+        return compress(ctx, in, out, start_level, options);
+    }
+
+} // namespace adaptive
+} // namespace zstdpp
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <stdexcept>
+
+#ifndef ZSTD_STATIC_LINKING_ONLY
+#define ZSTD_STATIC_LINKING_ONLY // ZSTD_decompressBound
+#endif
+#include <zstd.h>
+
+#include "../batch.hpp"
+#include "../thread_pool.hpp"
+#include "zstdpp.hpp"
+
+/* Batches of small records
+ *
+ * compress() per record allocates one output vector per record and
+ * acquires a context per call: for 10k records, 10k allocations and as
+ * many scattered writes. compress_batch writes one frame per record (with
+ * its content size) back to back into a single utils::Batch arena, with one
+ * context per sub-batch:
+ *
+ *   std::vector<zstdpp::rospan_t> records = ...;
+ *   zstdpp::Batch packed{}, unpacked{};
+ *   zstdpp::compress_batch(records, packed);
+ *   zstdpp::decompress_batch(packed, unpacked);     // unpacked[i] == records[i]
+ *
+ * Reusing the output Batch across calls keeps its capacity: in steady
+ * state nothing is allocated. With a thread pool, sub-batches of at least
+ * `min_records` records are compressed concurrently (see utils::batch).
+ * Errors throw std::runtime_error and leave the output empty. Content sizes
+ * come from untrusted frame headers: above max_batch_record_size or what
+ * the frame can produce, or adding up to more than max_batch_total_size,
+ * they are errors, before the arena is sized.
+ */
+namespace zstdpp {
+
+    using Batch = ::utils::Batch;
+
+    /// Largest record decompress_batch accepts
+    inline constexpr size_buffer_t max_batch_record_size = size_buffer_t{1} << 30;
+
+    /// Largest sum of the records decompress_batch accepts
+    inline constexpr size_buffer_t max_batch_total_size = size_buffer_t{1} << 32;
+
+    inline void compress_batch(
+        std::span<rospan_t const> inputs,
+        Batch& out,
+        compress_level_t compress_level = 3,
+        ::utils::ThreadPool* threads = nullptr,
+        ContextPool& pool = ContextPool::global(),
+        size_buffer_t min_records = ::utils::batch::default_min_records
+    ){
+        ::utils::batch::transform(inputs.size(), out,
+            [&](size_buffer_t i){ return compress_bound(inputs[i].size()); },
+            [&](size_buffer_t first, size_buffer_t last, span_t region, size_buffer_t* sizes){
+                auto const cctx = pool.acquire_cctx();
+                size_buffer_t used = 0;
+                for (auto i = first; i < last; ++i) {
+                    auto const& input = inputs[i];
+                    auto const size = Result::from_zstd(ZSTD_compressCCtx(
+                        cctx.get(), region.data() + used, region.size() - used,
+                        input.data(), input.size(), compress_level)).value();
+                    sizes[i - first] = size;
+                    used += size;
+                }
+                return used;
+            },
+            threads, min_records);
+    }
+
+    /// `inputs`: frames storing their content size (compress_batch output, compress()...)
+    inline void decompress_batch(
+        std::span<rospan_t const> inputs,
+        Batch& out,
+        ::utils::ThreadPool* threads = nullptr,
+        ContextPool& pool = ContextPool::global(),
+        size_buffer_t min_records = ::utils::batch::default_min_records
+    ){
+        size_buffer_t total = 0; // bound() is called in order, on this thread
+        ::utils::batch::transform(inputs.size(), out,
+            [&](size_buffer_t i){
+                auto const& input = inputs[i];
+                auto const size = decompressed_size(input).value();
+                if (size > max_batch_record_size || stream::detail::bounded_content_size(input) != size) {
+                    throw std::runtime_error("zstdpp::decompress_batch: content size larger than the frame can produce!");
+                }
+                total += size;
+                if (total > max_batch_total_size) {
+                    throw std::runtime_error("zstdpp::decompress_batch: batch larger than max_batch_total_size!");
+                }
+                return size;
+            },
+            [&](size_buffer_t first, size_buffer_t last, span_t region, size_buffer_t* sizes){
+                auto const dctx = pool.acquire_dctx();
+                size_buffer_t used = 0;
+                for (auto i = first; i < last; ++i) {
+                    auto const& input = inputs[i];
+                    auto const expected = sizes[i - first];
+                    auto const size = Result::from_zstd(ZSTD_decompressDCtx(
+                        dctx.get(), region.data() + used, region.size() - used, input.data(), input.size())).value();
+                    if (size != expected) {
+                        throw std::runtime_error("zstdpp::decompress_batch: frame content size mismatch!");
+                    }
+                    sizes[i - first] = size;
+                    used += size;
+                }
+                return used;
+            },
+            threads, min_records);
+    }
+
+    inline void decompress_batch(
+        Batch const& in,
+        Batch& out,
+        ::utils::ThreadPool* threads = nullptr,
+        ContextPool& pool = ContextPool::global()
+    ){
+        auto const records = in.records();
+        decompress_batch(records, out, threads, pool);
+    }
+
+} // namespace zstdpp
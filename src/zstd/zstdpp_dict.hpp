@@ -0,0 +1,296 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <zdict.h>
+
+#include "zstdpp.hpp"
+
+/* Dictionary compression
+ *
+ * Small records (a few hundred bytes) compress poorly on their own: a
+ * dictionary trained on samples of the traffic primes the compressor with
+ * the common content. Frames compressed with a dictionary store its ID, so
+ * decompression picks the dictionary by itself.
+ *
+ *   auto dict = zstdpp::Dictionary::train(samples);
+ *   zstdpp::DictionaryCache cache{};
+ *   cache.add(dict);
+ *   auto compressed = zstdpp::compress_using_dict(cache, dict.id(), record);
+ *   auto decompressed = zstdpp::decompress(cache, compressed);
+ */
+namespace zstdpp {
+
+class Dictionary {
+  public:
+    using id_t = std::uint32_t;
+    static constexpr size_buffer_t default_capacity = 110 * 1024; // as the zstd CLI
+
+    /// Takes an existing dictionary content (e.g. produced by `zstd --train`)
+    explicit Dictionary(buffer_t content)
+    : content_(std::move(content)), id_(ZDICT_getDictID(content_.data(), content_.size())) {
+        if (id_ == 0) {
+            throw std::invalid_argument("Dictionary: not a zstd dictionary (no dictionary ID)!");
+        }
+    }
+
+    /// Train a dictionary from representative samples (ZDICT)
+    static Dictionary train(std::span<rospan_t const> samples, size_buffer_t capacity = default_capacity){
+        buffer_t concatenated{};
+        std::vector<size_t> sizes{};
+        sizes.reserve(samples.size());
+        for (auto const& sample : samples) {
+            auto const* p = reinterpret_cast<byte_t const*>(sample.data());
+            concatenated.insert(concatenated.end(), p, p + sample.size());
+            sizes.push_back(sample.size());
+        }
+
+        buffer_t content{};
+        content.resize(capacity);
+        auto const size = ZDICT_trainFromBuffer(content.data(), content.size(), concatenated.data(),
+                                                sizes.data(), static_cast<unsigned>(sizes.size()));
+        if (ZDICT_isError(size)) {
+            throw std::runtime_error(std::string("ZDICT_trainFromBuffer() failed: ") + ZDICT_getErrorName(size));
+        }
+        content.resize(size);
+        return Dictionary(std::move(content));
+    }
+
+    template <typename Container>
+    static Dictionary train(std::vector<Container> const& samples, size_buffer_t capacity = default_capacity){
+        std::vector<rospan_t> views{};
+        views.reserve(samples.size());
+        for (auto const& sample : samples) {
+            views.emplace_back(reinterpret_cast<std::byte const*>(sample.data()), sample.size());
+        }
+        return train(std::span<rospan_t const>(views), capacity);
+    }
+
+    id_t id() const noexcept { return id_; }
+    buffer_t const& content() const noexcept { return content_; }
+
+    /* Persistence: one `<id>.zdict` file per dictionary in a directory */
+
+    static std::filesystem::path path_for(std::filesystem::path const& dir, id_t id){
+        return dir / (std::to_string(id) + ".zdict");
+    }
+
+    void save(std::filesystem::path const& dir) const {
+        std::ofstream file(path_for(dir, id_), std::ios::binary);
+        file.write(reinterpret_cast<char const*>(content_.data()), static_cast<std::streamsize>(content_.size()));
+        if (!file) {
+            throw std::runtime_error("Dictionary: failed to write " + path_for(dir, id_).string());
+        }
+    }
+
+    static Dictionary load(std::filesystem::path const& dir, id_t id){
+        auto const path = path_for(dir, id);
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            throw std::runtime_error("Dictionary: failed to open " + path.string());
+        }
+        buffer_t content{};
+        content.resize(static_cast<size_buffer_t>(std::filesystem::file_size(path)));
+        file.read(reinterpret_cast<char*>(content.data()), static_cast<std::streamsize>(content.size()));
+        if (!file || static_cast<size_buffer_t>(file.gcount()) != content.size()) {
+            throw std::runtime_error("Dictionary: failed to read " + path.string());
+        }
+        Dictionary dict(std::move(content));
+        if (dict.id() != id) {
+            throw std::runtime_error("Dictionary: ID mismatch in " + path.string());
+        }
+        return dict;
+    }
+
+  private:
+    buffer_t content_;
+    id_t id_;
+};
+
+/* Cache of digested dictionaries, shared across threads.
+ *
+ * ZSTD_CDict (per dictionary ID and level) and ZSTD_DDict (per ID) are
+ * created on first use and kept until the cache is destroyed; they are
+ * read-only and used concurrently by any number of contexts. When a
+ * directory is set, unknown IDs are loaded from it on demand.
+ */
+class DictionaryCache {
+  public:
+    DictionaryCache() = default;
+    explicit DictionaryCache(std::filesystem::path directory) : directory_(std::move(directory)) {}
+
+    DictionaryCache(DictionaryCache const&) = delete;
+    DictionaryCache& operator=(DictionaryCache const&) = delete;
+
+    /// Adding an ID again is a no-op with the same content and throws with another one:
+    /// the digested dictionaries already handed out for that ID cannot be replaced.
+    void add(Dictionary dict){
+        std::unique_lock lock(mutex_);
+        auto const id = dict.id();
+        if (auto it = dicts_.find(id); it != dicts_.end()) {
+            if (it->second->content() != dict.content()) {
+                throw std::invalid_argument("DictionaryCache: dictionary ID " + std::to_string(id) + " already added with another content!");
+            }
+            return;
+        }
+        dicts_.emplace(id, std::make_shared<Dictionary const>(std::move(dict)));
+    }
+
+    bool contains(Dictionary::id_t id){
+        return find(id) != nullptr;
+    }
+
+    ZSTD_CDict const* cdict(Dictionary::id_t id, compress_level_t compress_level = 3){
+        auto const key = std::make_pair(id, compress_level);
+        {
+            std::shared_lock lock(mutex_);
+            if (auto it = cdicts_.find(key); it != cdicts_.end()) {
+                return it->second.get();
+            }
+        }
+        auto const dict = require(id);
+        std::unique_lock lock(mutex_);
+        auto& cdict = cdicts_[key];
+        if (!cdict) {
+            cdict.reset(ZSTD_createCDict(dict->content().data(), dict->content().size(), compress_level));
+            if (!cdict) {
+                throw std::runtime_error("ZSTD_createCDict() failed!");
+            }
+        }
+        return cdict.get();
+    }
+
+    ZSTD_DDict const* ddict(Dictionary::id_t id){
+        {
+            std::shared_lock lock(mutex_);
+            if (auto it = ddicts_.find(id); it != ddicts_.end()) {
+                return it->second.get();
+            }
+        }
+        auto const dict = require(id);
+        std::unique_lock lock(mutex_);
+        auto& ddict = ddicts_[id];
+        if (!ddict) {
+            ddict.reset(ZSTD_createDDict(dict->content().data(), dict->content().size()));
+            if (!ddict) {
+                throw std::runtime_error("ZSTD_createDDict() failed!");
+            }
+        }
+        return ddict.get();
+    }
+
+  private:
+    struct CDictDeleter { void operator()(ZSTD_CDict* p) const noexcept { ZSTD_freeCDict(p); } };
+    struct DDictDeleter { void operator()(ZSTD_DDict* p) const noexcept { ZSTD_freeDDict(p); } };
+
+    std::shared_ptr<Dictionary const> find(Dictionary::id_t id){
+        {
+            std::shared_lock lock(mutex_);
+            if (auto it = dicts_.find(id); it != dicts_.end()) {
+                return it->second;
+            }
+        }
+        if (directory_.empty() || !std::filesystem::exists(Dictionary::path_for(directory_, id))) {
+            return nullptr;
+        }
+        auto loaded = std::make_shared<Dictionary const>(Dictionary::load(directory_, id));
+        std::unique_lock lock(mutex_);
+        return dicts_.try_emplace(id, std::move(loaded)).first->second;
+    }
+
+    std::shared_ptr<Dictionary const> require(Dictionary::id_t id){
+        auto dict = find(id);
+        if (!dict) {
+            throw std::runtime_error("DictionaryCache: unknown dictionary ID " + std::to_string(id));
+        }
+        return dict;
+    }
+
+    std::filesystem::path const directory_{};
+    std::shared_mutex mutex_{};
+    std::map<Dictionary::id_t, std::shared_ptr<Dictionary const>> dicts_{};
+    std::map<std::pair<Dictionary::id_t, compress_level_t>, std::unique_ptr<ZSTD_CDict, CDictDeleter>> cdicts_{};
+    std::map<Dictionary::id_t, std::unique_ptr<ZSTD_DDict, DDictDeleter>> ddicts_{};
+};
+
+/* Non-allocating functions (see compress_into / decompress_into) */
+
+inline Result compress_into(
+    DictionaryCache& cache,
+    Dictionary::id_t dict_id,
+    rospan_t src,
+    span_t dst,
+    compress_level_t compress_level = 3,
+    ContextPool& pool = ContextPool::global()
+) {
+    auto const* cdict = cache.cdict(dict_id, compress_level);
+    auto const cctx = pool.acquire_cctx();
+    return Result::from_zstd(ZSTD_compress_usingCDict(cctx.get(), dst.data(), dst.size(),
+                                                      src.data(), src.size(), cdict));
+}
+
+/// Decompress a frame, with the dictionary named by its header (if any)
+inline Result decompress_into(
+    DictionaryCache& cache,
+    rospan_t src,
+    span_t dst,
+    ContextPool& pool = ContextPool::global()
+) {
+    auto const dict_id = ZSTD_getDictID_fromFrame(src.data(), src.size());
+    if (dict_id == 0) {
+        return decompress_into(pool, src, dst);
+    }
+    auto const* ddict = cache.ddict(dict_id);
+    auto const dctx = pool.acquire_dctx();
+    return Result::from_zstd(ZSTD_decompress_usingDDict(dctx.get(), dst.data(), dst.size(),
+                                                        src.data(), src.size(), ddict));
+}
+
+/* Vector functions */
+
+inline buffer_t compress_using_dict(
+    DictionaryCache& cache,
+    Dictionary::id_t dict_id,
+    rospan_t data,
+    compress_level_t compress_level = 3
+) {
+    buffer_t comp_buffer{};
+    comp_buffer.resize(compress_bound(data.size()));
+    auto const size = compress_into(cache, dict_id, data, utils::as_writable_bytes(comp_buffer), compress_level).value();
+    comp_buffer.resize(size);
+    return comp_buffer;
+}
+
+inline buffer_t compress_using_dict(
+    DictionaryCache& cache,
+    Dictionary::id_t dict_id,
+    buffer_t const& data,
+    compress_level_t compress_level = 3
+) {
+    return compress_using_dict(cache, dict_id, utils::as_bytes(data), compress_level);
+}
+
+inline buffer_t decompress(DictionaryCache& cache, rospan_t data) {
+    buffer_t decomp_buffer{};
+    decomp_buffer.resize(decompressed_size(data).value());
+    auto const size = decompress_into(cache, data, utils::as_writable_bytes(decomp_buffer)).value();
+    decomp_buffer.resize(size);
+    return decomp_buffer;
+}
+
+inline buffer_t decompress(DictionaryCache& cache, buffer_t const& data) {
+    return decompress(cache, utils::as_bytes(data));
+}
+
+} // namespace zstdpp
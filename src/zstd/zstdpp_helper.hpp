@@ -37,6 +37,11 @@ namespace fs{
         return buffer;
     }
     
+    /// Read-only view of a file, without copying it (mmap)
+    inline utils::MappedFile map_file(std::string const& filename){
+        return utils::MappedFile(filename);
+    }
+    
     inline void write_file(std::string const& filename, buffer_t const& buffer){
         std::ofstream file(filename, std::ios::binary);
         file.write((char*)buffer.data(), buffer.size());
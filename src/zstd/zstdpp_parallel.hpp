@@ -0,0 +1,209 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "../thread_pool.hpp"
+#include "zstdpp.hpp"
+
+/* Parallel zstd for large inputs
+ *
+ * libzstd has no multi-threaded decoder: a stream made of one frame is
+ * decompressed at single-core speed, whatever ZSTD_c_nbWorkers was used to
+ * write it. Here the input is cut into chunks of `chunk_size` bytes, each
+ * chunk is compressed as an independent frame (storing its content size) on
+ * a thread pool, and the frames are written in order:
+ *
+ *   [frame: chunk 0][frame: chunk 1]...[frame: chunk N-1]
+ *
+ * Concatenated frames are a valid zstd stream (`zstd -d`, stream::decompress).
+ * Decompression finds the frame boundaries with ZSTD_findFrameCompressedSize
+ * and their sizes with ZSTD_getFrameContentSize (headers only, no decoding),
+ * and decompresses the frames in parallel, each one straight into its own
+ * output buffer; the buffers are written in order.
+ *
+ * From the first frame whose content size is unknown, too large to be held
+ * in memory (e.g. a single-frame stream::compress output) or larger than the
+ * frame can produce (a forged header), the rest of the input is decompressed
+ * sequentially, as stream::decompress does. The content of the frames being
+ * decompressed adds up to max_content_in_flight (unless one frame is larger),
+ * however many workers the pool has.
+ */
+namespace zstdpp {
+namespace parallel {
+
+    struct Options {
+        size_buffer_t chunk_size = size_buffer_t{4} << 20;   ///< uncompressed bytes per frame
+        Params frame = Params{}.level(3).checksum();        ///< parameters of every frame
+    };
+
+    /// Larger frames are decompressed sequentially (see above)
+    inline constexpr size_buffer_t max_frame_content = size_buffer_t{1} << 30;
+
+    /// Content of the frames decompressed at the same time (see above)
+    inline constexpr size_buffer_t max_content_in_flight = size_buffer_t{256} << 20;
+
+    namespace detail {
+
+        /// Size of the frame at the beginning of `data`; 0 when it is not complete yet
+        inline size_buffer_t frame_size(rospan_t data){
+            auto const size = ZSTD_findFrameCompressedSize(data.data(), data.size());
+            if (ZSTD_isError(size)) {
+                if (ZSTD_getErrorCode(size) == ZSTD_error_srcSize_wrong) {
+                    return 0;
+                }
+                throw std::runtime_error(ZSTD_getErrorName(size));
+            }
+            return size;
+        }
+
+        /// Whether a frame starting `data` can be decompressed on its own into memory.
+        /// `content_size` is set from its header (0 for skippable frames);
+        /// false also when the header is not complete yet.
+        inline bool splittable(rospan_t data, unsigned long long& content_size){
+            content_size = ZSTD_getFrameContentSize(data.data(), data.size());
+            return content_size != ZSTD_CONTENTSIZE_ERROR && content_size != ZSTD_CONTENTSIZE_UNKNOWN
+                && content_size <= max_frame_content;
+        }
+
+        inline buffer_t compress_chunk(rospan_t chunk, Params const& params){
+            buffer_t frame{};
+            frame.resize(compress_bound(chunk.size()));
+            frame.resize(compress_into(chunk, utils::as_writable_bytes(frame), params).value());
+            return frame;
+        }
+
+        inline buffer_t decompress_frame(rospan_t frame, size_buffer_t content_size){
+            buffer_t out{};
+            if (content_size > 0) { // 0 for skippable frames (or empty frames)
+                out.resize(content_size);
+                if (decompress_into(frame, utils::as_writable_bytes(out)).value() != content_size) {
+                    throw std::runtime_error("zstdpp::parallel: frame content size mismatch!");
+                }
+            }
+            return out;
+        }
+
+        /// Sequential decompression of `window` then of the rest of `in`, once no frame can be split
+        inline void decompress_rest(rospan_t window, std::istream& in, ::utils::OrderedWriter& writer){
+            stream::Context ctx{};
+            buffer_t buffIn{};
+            buffIn.resize(ZSTD_DStreamInSize());
+            buffer_t buffOut{};
+            buffOut.resize(ZSTD_DStreamOutSize());
+            size_t lastRet = 0;
+            for (;;) {
+                ZSTD_inBuffer input = { window.data(), window.size(), 0 };
+                while (input.pos < input.size) {
+                    ZSTD_outBuffer output = { buffOut.data(), buffOut.size(), 0 };
+                    lastRet = ctx(input, output);
+                    if (ZSTD_isError(lastRet)) {
+                        throw std::runtime_error(ZSTD_getErrorName(lastRet));
+                    }
+                    writer.write(utils::as_bytes(buffOut).first(output.pos));
+                }
+                in.read(reinterpret_cast<char*>(buffIn.data()), static_cast<std::streamsize>(buffIn.size()));
+                auto const read = static_cast<size_buffer_t>(in.gcount());
+                if (read == 0) {
+                    break;
+                }
+                window = utils::as_bytes(buffIn).first(read);
+            }
+            if (lastRet != 0) {
+                throw std::runtime_error("Error: zstd only returns 0 when the input is completely consumed!");
+            }
+        }
+
+    } // namespace detail
+
+    /* Streaming functions (bounded memory: about 2 chunks per worker) */
+
+    inline void compress(std::istream& in, std::ostream& out, Options const& options = {}, ::utils::ThreadPool& pool = ::utils::ThreadPool::global()){
+        auto const chunk_size = std::max<size_buffer_t>(options.chunk_size, 1);
+        ::utils::OrderedWriter writer(out, 2 * pool.size());
+        bool empty = true;
+        while (in) {
+            buffer_t chunk{};
+            chunk.resize(chunk_size);
+            in.read(reinterpret_cast<char*>(chunk.data()), static_cast<std::streamsize>(chunk.size()));
+            chunk.resize(static_cast<size_buffer_t>(in.gcount()));
+            if (chunk.empty() && !empty) {
+                break;
+            }
+            empty = false;
+            writer.push(pool.submit([chunk = std::move(chunk), &params = options.frame]{
+                return detail::compress_chunk(utils::as_bytes(chunk), params);
+            }));
+        }
+        writer.finish();
+    }
+
+    inline void decompress(std::istream& in, std::ostream& out, ::utils::ThreadPool& pool = ::utils::ThreadPool::global()){
+        ::utils::OrderedWriter writer(out, 2 * pool.size(), max_content_in_flight);
+        buffer_t window{};
+        size_buffer_t begin = 0; // first byte not yet submitted
+        for (;;) {
+            // Keep the incomplete frame, and read more after it
+            window.erase(window.begin(), window.begin() + static_cast<std::ptrdiff_t>(begin));
+            begin = 0;
+            auto const filled = window.size();
+            window.resize(std::max<size_buffer_t>(2 * filled, size_buffer_t{8} << 20));
+            in.read(reinterpret_cast<char*>(window.data() + filled), static_cast<std::streamsize>(window.size() - filled));
+            auto const read = static_cast<size_buffer_t>(in.gcount());
+            window.resize(filled + read);
+            if (read == 0) {
+                if (!window.empty()) {
+                    throw std::runtime_error("Error: zstd frame is truncated!");
+                }
+                break;
+            }
+
+            for (;;) {
+                auto const rest = utils::as_bytes(window).subspan(begin);
+                auto const size = detail::frame_size(rest);
+                unsigned long long content_size = 0;
+                bool const splittable = detail::splittable(rest, content_size);
+                if (size == 0) {
+                    // incomplete: read more, unless its header already rules splitting out
+                    if (splittable || content_size == ZSTD_CONTENTSIZE_ERROR) {
+                        break;
+                    }
+                } else if (splittable && stream::detail::bounded_content_size(rest.first(size)) == content_size) {
+                    auto const* frame = window.data() + begin;
+                    writer.push(pool.submit([frame = buffer_t(frame, frame + size), content_size]{
+                        return detail::decompress_frame(utils::as_bytes(frame), static_cast<size_buffer_t>(content_size));
+                    }), static_cast<size_buffer_t>(content_size));
+                    begin += size;
+                    continue;
+                }
+                // not splittable: the frames written so far, then everything else in order
+                writer.finish();
+                detail::decompress_rest(rest, in, writer);
+                writer.finish();
+                return;
+            }
+        }
+        writer.finish();
+    }
+
+    /// Compress a file with all the workers of `pool`
+    inline void stream_compress(string_t const& in, string_t const& out, Options const& options = {}, ::utils::ThreadPool& pool = ::utils::ThreadPool::global()){
+        std::ifstream in_file(in, std::ios::binary);
+        std::ofstream out_file(out, std::ios::binary);
+        compress(in_file, out_file, options, pool);
+    }
+
+    inline void stream_decompress(string_t const& in, string_t const& out, ::utils::ThreadPool& pool = ::utils::ThreadPool::global()){
+        std::ifstream in_file(in, std::ios::binary);
+        std::ofstream out_file(out, std::ios::binary);
+        decompress(in_file, out_file, pool);
+    }
+
+} // namespace parallel
+} // namespace zstdpp
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+#ifndef ZSTD_STATIC_LINKING_ONLY
+#define ZSTD_STATIC_LINKING_ONLY // ZSTD_WINDOWLOG_LIMIT_DEFAULT
+#endif
+#include <zstd.h>
+
+namespace zstdpp {
+
+/* Compression Parameters
+ *
+ * Builder for the advanced compression API. Only the parameters which were
+ * set are forwarded to ZSTD_CCtx_setParameter(), all the others keep the
+ * zstd defaults. The same object is used by the one-shot and the streaming
+ * functions, e.g.
+ *
+ *   auto const params = zstdpp::Params{}.level(19).window_log(27).long_distance_matching();
+ *   zstdpp::stream::compress(in, out, params);
+ *
+ * Note: frames using a window larger than 128 MiB (window_log > 27) can only
+ * be decompressed by a stream whose `window_log_max` is raised accordingly,
+ * see stream::decompress(in, out, params).
+ */
+class Params {
+  public:
+    /// Negative levels are "fast" levels: faster but with a lower ratio.
+    Params& level(int value){ level_ = value; return *this; }
+    Params& strategy(ZSTD_strategy value){ strategy_ = static_cast<int>(value); return *this; }
+    Params& window_log(int value){ window_log_ = value; return *this; }
+    Params& hash_log(int value){ hash_log_ = value; return *this; }
+    Params& chain_log(int value){ chain_log_ = value; return *this; }
+    Params& long_distance_matching(bool enable = true){ ldm_ = enable ? 1 : 0; return *this; }
+    Params& ldm_hash_log(int value){ ldm_hash_log_ = value; return *this; }
+    Params& checksum(bool enable = true){ checksum_ = enable ? 1 : 0; return *this; }
+    Params& content_size(bool enable = true){ content_size_ = enable ? 1 : 0; return *this; }
+
+    /* Multi-threading (ignored by a libzstd built without it) */
+    Params& workers(int value){ workers_ = value; return *this; }
+    Params& job_size(int bytes){ job_size_ = bytes; return *this; }
+    Params& overlap_log(int value){ overlap_log_ = value; return *this; }
+
+    std::optional<int> level() const { return level_; }
+    std::optional<int> window_log() const { return window_log_; }
+    std::optional<int> workers() const { return workers_; }
+
+    static int min_level(){ return ZSTD_minCLevel(); }
+    static int max_level(){ return ZSTD_maxCLevel(); }
+
+    /// Set all the parameters on `cctx`. Throws on an invalid value.
+    void apply(ZSTD_CCtx* cctx) const {
+        auto const applied = set_all(cctx);
+        if (applied.single_thread) {
+            std::cerr << "Note: the linked libzstd library doesn't support multithreading. \n"
+                      << "\tReverting to single-thread mode. \n" << std::endl;
+        }
+        if (ZSTD_isError(applied.code)) {
+            throw std::runtime_error(std::string("ZSTD_CCtx_setParameter(") + applied.name + ") failed: "
+                                     + ZSTD_getErrorName(applied.code));
+        }
+    }
+
+    /// Same as apply(cctx), without exception nor message: returns 0 or a zstd error code.
+    size_t try_apply(ZSTD_CCtx* cctx) const noexcept {
+        return set_all(cctx).code;
+    }
+
+    /// Set the decompression limits needed by frames produced with these parameters.
+    void apply(ZSTD_DCtx* dctx) const {
+        if (window_log_) {
+            int const window_log_max = std::max(*window_log_, ZSTD_WINDOWLOG_LIMIT_DEFAULT);
+            size_t const r = ZSTD_DCtx_setParameter(dctx, ZSTD_d_windowLogMax, window_log_max);
+            if (ZSTD_isError(r)) {
+                throw std::runtime_error(std::string("ZSTD_DCtx_setParameter(windowLogMax) failed: ")
+                                         + ZSTD_getErrorName(r));
+            }
+        }
+    }
+
+  private:
+    struct Applied {
+        size_t code{0};             ///< first error, if any
+        char const* name{nullptr};  ///< of the parameter in error
+        bool single_thread{false};  ///< workers requested, not supported by libzstd
+    };
+
+    Applied set_all(ZSTD_CCtx* cctx) const noexcept {
+        Applied applied{};
+        auto const set = [&](ZSTD_cParameter param, std::optional<int> const& value, char const* name){
+            if (!value || ZSTD_isError(applied.code)) {
+                return;
+            }
+            size_t const r = ZSTD_CCtx_setParameter(cctx, param, *value);
+            if (ZSTD_isError(r)) {
+                applied.code = r;
+                applied.name = name;
+            }
+        };
+
+        bool multithread = false;
+        if (workers_) {
+            size_t const r = ZSTD_CCtx_setParameter(cctx, ZSTD_c_nbWorkers, *workers_);
+            applied.single_thread = ZSTD_isError(r);
+            multithread = !applied.single_thread && *workers_ > 0;
+        }
+
+        set(ZSTD_c_compressionLevel, level_, "compressionLevel");
+        set(ZSTD_c_strategy, strategy_, "strategy");
+        set(ZSTD_c_windowLog, window_log_, "windowLog");
+        set(ZSTD_c_hashLog, hash_log_, "hashLog");
+        set(ZSTD_c_chainLog, chain_log_, "chainLog");
+        set(ZSTD_c_enableLongDistanceMatching, ldm_, "enableLongDistanceMatching");
+        set(ZSTD_c_ldmHashLog, ldm_hash_log_, "ldmHashLog");
+        set(ZSTD_c_checksumFlag, checksum_, "checksumFlag");
+        set(ZSTD_c_contentSizeFlag, content_size_, "contentSizeFlag");
+
+        if (multithread) {
+            set(ZSTD_c_jobSize, job_size_, "jobSize");
+            set(ZSTD_c_overlapLog, overlap_log_, "overlapLog");
+        }
+        return applied;
+    }
+
+    std::optional<int> level_{};
+    std::optional<int> strategy_{};
+    std::optional<int> window_log_{};
+    std::optional<int> hash_log_{};
+    std::optional<int> chain_log_{};
+    std::optional<int> ldm_{};
+    std::optional<int> ldm_hash_log_{};
+    std::optional<int> checksum_{};
+    std::optional<int> content_size_{};
+    std::optional<int> workers_{};
+    std::optional<int> job_size_{};
+    std::optional<int> overlap_log_{};
+};
+
+} // namespace zstdpp
@@ -0,0 +1,263 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <iostream>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "../spsc_queue.hpp"
+#include "zstdpp.hpp"
+
+/* Pipelined streaming: reading, (de)compression and writing overlap
+ *
+ *   reader thread --[filled input]--> caller thread --[filled output]--> writer thread
+ *        ^------------[free input]-------'   ^-----------[free output]-------'
+ *
+ * The stages exchange indices of reusable buffers through bounded SPSC
+ * queues: nothing is allocated after start-up, and each stage only waits
+ * when the next one is `buffers` chunks behind. While zstd works on chunk
+ * N, chunk N+1 is being read and the output of chunk N-1 written.
+ *
+ * Same formats as stream::compress / stream::decompress.
+ */
+namespace zstdpp {
+namespace pipeline {
+
+    struct Options {
+        size_buffer_t buffers = 4;                        ///< chunks in flight per direction
+        size_buffer_t chunk_size = size_buffer_t{1} << 20; ///< input read / output write size
+    };
+
+    namespace detail {
+
+        inline constexpr size_buffer_t end_of_stream = std::numeric_limits<size_buffer_t>::max();
+
+        class Pipeline {
+          public:
+            Pipeline(std::istream& in, std::ostream& out, Options const& options)
+            : in_(in), out_(out),
+              chunk_size_(std::max<size_buffer_t>(options.chunk_size, 1)),
+              in_chunks_(std::max<size_buffer_t>(options.buffers, 1)),
+              out_chunks_(std::max<size_buffer_t>(options.buffers, 1)),
+              free_in_(in_chunks_.size()), filled_in_(in_chunks_.size()),
+              free_out_(out_chunks_.size()), filled_out_(out_chunks_.size() + 1) {
+                for (size_buffer_t i = 0; i < in_chunks_.size(); ++i) {
+                    in_chunks_[i].data.resize(chunk_size_);
+                    free_in_.push(i);
+                }
+                for (size_buffer_t i = 0; i < out_chunks_.size(); ++i) {
+                    out_chunks_[i].data.resize(chunk_size_);
+                    free_out_.push(i);
+                }
+            }
+
+            Pipeline(Pipeline const&) = delete;
+            Pipeline& operator=(Pipeline const&) = delete;
+
+            ~Pipeline(){
+                stop();
+                join();
+            }
+
+            /// Run the reader and writer threads, and `step` on the calling thread:
+            ///   bool step(ZSTD_inBuffer& input, ZSTD_outBuffer& output, bool last)
+            /// returns true once `input` is done with (`last`: the end of the stream).
+            template <typename Step>
+            void run(Step&& step){
+                reader_ = std::thread([this]{ guarded([this]{ read_loop(); }); });
+                writer_ = std::thread([this]{ guarded([this]{ write_loop(); }); });
+                guarded([&]{ process_loop(step); });
+                join();
+                if (error_) {
+                    std::rethrow_exception(error_);
+                }
+            }
+
+          private:
+            struct Chunk {
+                buffer_t data{};
+                size_buffer_t size{0};
+                bool last{false};
+            };
+
+            template <typename F>
+            void guarded(F&& f) noexcept {
+                try {
+                    f();
+                } catch (...) {
+                    {
+                        std::lock_guard lock(error_mutex_);
+                        if (!error_) {
+                            error_ = std::current_exception();
+                        }
+                    }
+                    stop();
+                }
+            }
+
+            void stop() noexcept {
+                free_in_.close();
+                filled_in_.close();
+                free_out_.close();
+                filled_out_.close();
+            }
+
+            void join(){
+                if (reader_.joinable()) {
+                    reader_.join();
+                }
+                if (writer_.joinable()) {
+                    writer_.join();
+                }
+            }
+
+            static void require(bool ok){
+                if (!ok) {
+                    throw std::runtime_error("zstdpp::pipeline: stopped after an error");
+                }
+            }
+
+            void read_loop(){
+                for (bool last = false; !last;) {
+                    size_buffer_t index{};
+                    if (!free_in_.pop(index)) {
+                        return;
+                    }
+                    auto& chunk = in_chunks_[index];
+                    in_.read(reinterpret_cast<char*>(chunk.data.data()), static_cast<std::streamsize>(chunk_size_));
+                    if (in_.bad()) {
+                        throw std::runtime_error("zstdpp::pipeline: read failed!");
+                    }
+                    chunk.size = static_cast<size_buffer_t>(in_.gcount());
+                    chunk.last = last = chunk.size < chunk_size_;
+                    if (!filled_in_.push(index)) {
+                        return;
+                    }
+                }
+            }
+
+            void write_loop(){
+                for (;;) {
+                    size_buffer_t index{};
+                    if (!filled_out_.pop(index) || index == end_of_stream) {
+                        return;
+                    }
+                    auto& chunk = out_chunks_[index];
+                    out_.write(reinterpret_cast<char const*>(chunk.data.data()), static_cast<std::streamsize>(chunk.size));
+                    if (!out_) {
+                        throw std::runtime_error("zstdpp::pipeline: write failed!");
+                    }
+                    chunk.size = 0;
+                    if (!free_out_.push(index)) {
+                        return;
+                    }
+                }
+            }
+
+            template <typename Step>
+            void process_loop(Step& step){
+                size_buffer_t out_index{};
+                require(free_out_.pop(out_index));
+                for (bool last = false; !last;) {
+                    size_buffer_t in_index{};
+                    require(filled_in_.pop(in_index));
+                    auto& chunk = in_chunks_[in_index];
+                    last = chunk.last;
+
+                    ZSTD_inBuffer input = { chunk.data.data(), chunk.size, 0 };
+                    for (bool done = false; !done;) {
+                        auto& out = out_chunks_[out_index];
+                        ZSTD_outBuffer output = { out.data.data() + out.size, out.data.size() - out.size, 0 };
+                        done = step(input, output, last);
+                        out.size += output.pos;
+                        if (out.size == out.data.size()) { // full: hand over to the writer
+                            require(filled_out_.push(out_index));
+                            require(free_out_.pop(out_index));
+                        }
+                    }
+                    require(free_in_.push(in_index));
+                }
+                if (out_chunks_[out_index].size > 0) {
+                    require(filled_out_.push(out_index));
+                }
+                require(filled_out_.push(end_of_stream));
+            }
+
+            std::istream& in_;
+            std::ostream& out_;
+            size_buffer_t const chunk_size_;
+            std::vector<Chunk> in_chunks_;
+            std::vector<Chunk> out_chunks_;
+            ::utils::SpscQueue<size_buffer_t> free_in_;
+            ::utils::SpscQueue<size_buffer_t> filled_in_;
+            ::utils::SpscQueue<size_buffer_t> free_out_;
+            ::utils::SpscQueue<size_buffer_t> filled_out_; // + the end_of_stream mark
+            std::thread reader_{};
+            std::thread writer_{};
+            std::mutex error_mutex_{};
+            std::exception_ptr error_{};
+        };
+
+    } // namespace detail
+
+    /// Compress `in` to `out` with an already configured compression context
+    inline void compress(stream::Context& ctx, std::istream& in, std::ostream& out, Options const& options = {}){
+        detail::Pipeline pipeline(in, out, options);
+        pipeline.run([&ctx](ZSTD_inBuffer& input, ZSTD_outBuffer& output, bool last){
+            size_t const remaining = ctx(input, output, last ? ZSTD_e_end : ZSTD_e_continue);
+            if (ZSTD_isError(remaining)) {
+                throw std::runtime_error(ZSTD_getErrorName(remaining));
+            }
+            return last ? remaining == 0 : input.pos == input.size;
+        });
+    }
+
+    inline void compress(std::istream& in, std::ostream& out, Params const& params, Options const& options = {}){
+        stream::Context ctx(params);
+        compress(ctx, in, out, options);
+    }
+
+    inline void compress(
+        std::istream& in,
+        std::ostream& out,
+        threads_number_t nThreads = 1,
+        compress_level_t compress_level = 3,
+        Options const& options = {}
+    ){
+        stream::Context ctx(compress_level, nThreads);
+        compress(ctx, in, out, options);
+    }
+
+    /// Decompress `in` to `out` with a decompression context
+    inline void decompress(stream::Context& ctx, std::istream& in, std::ostream& out, Options const& options = {}){
+        detail::Pipeline pipeline(in, out, options);
+        size_t lastRet = 0;
+        pipeline.run([&ctx, &lastRet](ZSTD_inBuffer& input, ZSTD_outBuffer& output, bool last){
+            if (input.pos < input.size) {
+                lastRet = ctx(input, output);
+                if (ZSTD_isError(lastRet)) {
+                    throw std::runtime_error(ZSTD_getErrorName(lastRet));
+                }
+            }
+            if (input.pos < input.size) {
+                return false;
+            }
+            if (last && lastRet != 0) {
+                throw std::runtime_error("Error: zstd only returns 0 when the input is completely consumed!");
+            }
+            return true;
+        });
+    }
+
+    inline void decompress(std::istream& in, std::ostream& out, Options const& options = {}){
+        stream::Context ctx{};
+        decompress(ctx, in, out, options);
+    }
+
+} // namespace pipeline
+} // namespace zstdpp
@@ -0,0 +1,288 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#ifndef ZSTD_STATIC_LINKING_ONLY
+#define ZSTD_STATIC_LINKING_ONLY // ZSTD_customMem, ZSTD_create?Ctx_advanced
+#endif
+#include <zstd.h>
+
+namespace zstdpp {
+
+namespace detail {
+
+    template <typename Ctx>
+    struct ctx_traits;
+
+    template <>
+    struct ctx_traits<ZSTD_CCtx> {
+        static ZSTD_CCtx* create(ZSTD_customMem mem){ return ZSTD_createCCtx_advanced(mem); }
+        static void reset(ZSTD_CCtx* ctx){ ZSTD_CCtx_reset(ctx, ZSTD_reset_session_and_parameters); }
+        static void destroy(ZSTD_CCtx* ctx){ ZSTD_freeCCtx(ctx); }
+    };
+
+    template <>
+    struct ctx_traits<ZSTD_DCtx> {
+        static ZSTD_DCtx* create(ZSTD_customMem mem){ return ZSTD_createDCtx_advanced(mem); }
+        static void reset(ZSTD_DCtx* ctx){ ZSTD_DCtx_reset(ctx, ZSTD_reset_session_and_parameters); }
+        static void destroy(ZSTD_DCtx* ctx){ ZSTD_freeDCtx(ctx); }
+    };
+
+} // namespace detail
+
+/* Context Pool
+ *
+ * Hands out ZSTD_CCtx / ZSTD_DCtx objects which are reset (session and
+ * parameters) but keep their allocated workspace, so that repeated calls
+ * with similar parameters do not allocate at all.
+ *
+ * - Fast path: each thread caches one CCtx and one DCtx per pool.
+ * - Slow path: a mutex-protected free list shared by all threads, bounded
+ *   by `max_cached`. Contexts released beyond that bound are freed.
+ *
+ * All memory used by the pooled contexts is requested through a counting
+ * allocator, see `stats()`. The pool must outlive the leases it hands out.
+ */
+class ContextPool {
+    struct State;
+
+  public:
+    struct Stats {
+        std::size_t allocations; ///< heap allocations requested by zstd
+        std::size_t created;     ///< contexts created by the pool
+        std::size_t reused;      ///< acquisitions served by a cached context
+    };
+
+    /// RAII handle: gives the context back to its pool (or frees it) on destruction.
+    template <typename Ctx>
+    class Lease {
+      public:
+        Lease() = default;
+
+        /// Takes ownership of a context which does not belong to any pool.
+        explicit Lease(Ctx* ctx) noexcept : ctx_(ctx) {}
+
+        Lease(Lease&& other) noexcept
+        : state_(std::exchange(other.state_, nullptr)), ctx_(std::exchange(other.ctx_, nullptr)) {}
+
+        Lease& operator=(Lease&& other) noexcept {
+            if (this != &other) {
+                release();
+                state_ = std::exchange(other.state_, nullptr);
+                ctx_ = std::exchange(other.ctx_, nullptr);
+            }
+            return *this;
+        }
+
+        Lease(Lease const&) = delete;
+        Lease& operator=(Lease const&) = delete;
+
+        ~Lease(){ release(); }
+
+        Ctx* get() const noexcept { return ctx_; }
+        explicit operator bool() const noexcept { return ctx_ != nullptr; }
+
+      private:
+        friend class ContextPool;
+        Lease(State* state, Ctx* ctx) noexcept : state_(state), ctx_(ctx) {}
+
+        void release() noexcept {
+            if (ctx_ == nullptr) {
+                return;
+            }
+            if (state_ != nullptr) {
+                state_->give_back(ctx_);
+            } else {
+                detail::ctx_traits<Ctx>::destroy(ctx_);
+            }
+            ctx_ = nullptr;
+            state_ = nullptr;
+        }
+
+        State* state_{nullptr};
+        Ctx* ctx_{nullptr};
+    };
+
+    using CCtxLease = Lease<ZSTD_CCtx>;
+    using DCtxLease = Lease<ZSTD_DCtx>;
+
+    explicit ContextPool(std::size_t max_cached = default_max_cached())
+    : state_(std::make_shared<State>(max_cached)) {}
+
+    ContextPool(ContextPool const&) = delete;
+    ContextPool& operator=(ContextPool const&) = delete;
+
+    CCtxLease acquire_cctx(){ return state_->template acquire<ZSTD_CCtx>(); }
+    DCtxLease acquire_dctx(){ return state_->template acquire<ZSTD_DCtx>(); }
+
+    Stats stats() const noexcept {
+        return Stats{
+            state_->allocations.load(std::memory_order_relaxed),
+            state_->created.load(std::memory_order_relaxed),
+            state_->reused.load(std::memory_order_relaxed)
+        };
+    }
+
+    /// Process-wide pool used when the caller does not provide one.
+    static ContextPool& global(){
+        static ContextPool pool{};
+        return pool;
+    }
+
+    static std::size_t default_max_cached() noexcept {
+        auto const n = std::thread::hardware_concurrency();
+        return n == 0 ? 4 : n;
+    }
+
+  private:
+    /* Shared part of the pool. Thread-local caches only keep a weak reference,
+     * so a thread exiting after the pool was destroyed just frees its contexts.
+     */
+    struct State : std::enable_shared_from_this<State> {
+        explicit State(std::size_t max) : max_cached(max) {}
+
+        ~State(){
+            for (auto* ctx : cctxs) { detail::ctx_traits<ZSTD_CCtx>::destroy(ctx); }
+            for (auto* ctx : dctxs) { detail::ctx_traits<ZSTD_DCtx>::destroy(ctx); }
+        }
+
+        /* Per-thread cache entry of one pool */
+        struct LocalSlot {
+            State const* key{nullptr};
+            std::weak_ptr<State> owner{};
+            ZSTD_CCtx* cctx{nullptr};
+            ZSTD_DCtx* dctx{nullptr};
+
+            template <typename Ctx>
+            Ctx*& get(){
+                if constexpr (std::is_same_v<Ctx, ZSTD_CCtx>) { return cctx; }
+                else { return dctx; }
+            }
+
+            /// Gives the contexts back to a living pool, or frees them.
+            void flush() noexcept {
+                if (auto state = owner.lock()) {
+                    if (cctx != nullptr) { state->give_back_shared(cctx); }
+                    if (dctx != nullptr) { state->give_back_shared(dctx); }
+                } else {
+                    if (cctx != nullptr) { detail::ctx_traits<ZSTD_CCtx>::destroy(cctx); }
+                    if (dctx != nullptr) { detail::ctx_traits<ZSTD_DCtx>::destroy(dctx); }
+                }
+                cctx = nullptr;
+                dctx = nullptr;
+            }
+        };
+
+        struct LocalCache {
+            std::vector<LocalSlot> slots;
+            ~LocalCache(){
+                for (auto& slot : slots) { slot.flush(); }
+            }
+        };
+
+        LocalSlot& local_slot(){
+            thread_local LocalCache cache{};
+            LocalSlot* reusable = nullptr;
+            for (auto& slot : cache.slots) {
+                if (slot.key == this && !slot.owner.expired()) {
+                    return slot;
+                }
+                if (reusable == nullptr && slot.owner.expired()) {
+                    reusable = &slot;
+                }
+            }
+            if (reusable == nullptr) {
+                reusable = &cache.slots.emplace_back();
+            }
+            reusable->flush(); // frees contexts left by a destroyed pool
+            reusable->key = this;
+            reusable->owner = weak_from_this();
+            return *reusable;
+        }
+
+        template <typename Ctx>
+        std::vector<Ctx*>& free_list(){
+            if constexpr (std::is_same_v<Ctx, ZSTD_CCtx>) { return cctxs; }
+            else { return dctxs; }
+        }
+
+        template <typename Ctx>
+        Lease<Ctx> acquire(){
+            Ctx*& cached = local_slot().template get<Ctx>();
+            if (cached != nullptr) {
+                reused.fetch_add(1, std::memory_order_relaxed);
+                return Lease<Ctx>(this, std::exchange(cached, nullptr));
+            }
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                auto& list = free_list<Ctx>();
+                if (!list.empty()) {
+                    Ctx* ctx = list.back();
+                    list.pop_back();
+                    reused.fetch_add(1, std::memory_order_relaxed);
+                    return Lease<Ctx>(this, ctx);
+                }
+            }
+            Ctx* ctx = detail::ctx_traits<Ctx>::create(ZSTD_customMem{&counted_alloc, &plain_free, this});
+            if (ctx == nullptr) {
+                throw std::runtime_error("ContextPool: context creation failed!");
+            }
+            created.fetch_add(1, std::memory_order_relaxed);
+            return Lease<Ctx>(this, ctx);
+        }
+
+        template <typename Ctx>
+        void give_back(Ctx* ctx) noexcept {
+            detail::ctx_traits<Ctx>::reset(ctx);
+
+            Ctx*& cached = local_slot().template get<Ctx>();
+            if (cached == nullptr) {
+                cached = ctx;
+                return;
+            }
+            give_back_shared(ctx);
+        }
+
+        template <typename Ctx>
+        void give_back_shared(Ctx* ctx) noexcept {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                auto& list = free_list<Ctx>();
+                if (list.size() < max_cached) {
+                    list.push_back(ctx);
+                    return;
+                }
+            }
+            detail::ctx_traits<Ctx>::destroy(ctx);
+        }
+
+        static void* counted_alloc(void* opaque, std::size_t size){
+            static_cast<State*>(opaque)->allocations.fetch_add(1, std::memory_order_relaxed);
+            return std::malloc(size);
+        }
+        // `opaque` is not touched: a context may outlive its pool in a thread-local cache.
+        static void plain_free(void*, void* address){ std::free(address); }
+
+        std::atomic<std::size_t> allocations{0};
+        std::atomic<std::size_t> created{0};
+        std::atomic<std::size_t> reused{0};
+
+        std::mutex mutex;
+        std::vector<ZSTD_CCtx*> cctxs;
+        std::vector<ZSTD_DCtx*> dctxs;
+        std::size_t const max_cached;
+    };
+
+    std::shared_ptr<State> state_;
+};
+
+} // namespace zstdpp
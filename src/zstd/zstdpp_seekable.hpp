@@ -0,0 +1,316 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+#include "zstdpp.hpp"
+
+/* Seekable zstd format
+ *
+ * The input is cut into independent frames of `frame_size` bytes, followed
+ * by a skippable frame holding a seek table, as in the upstream format:
+ * https://github.com/facebook/zstd/blob/dev/contrib/seekable_format/zstd_seekable_compression_format.md
+ *
+ *   [frame 0][frame 1]...[frame N-1][skippable frame: seek table]
+ *
+ *   seek table = Skippable_Magic (4) | Frame_Size (4)
+ *              | N x { Compressed_Size (4) | Decompressed_Size (4) [| Checksum (4)] }
+ *              | Number_Of_Frames (4) | Descriptor (1) | Seekable_Magic (4)
+ *
+ * Since every frame is independent, read_at() only decompresses the frames
+ * covering the requested range. The output is also a valid plain zstd
+ * stream (decoders skip the seek table).
+ */
+namespace zstdpp {
+namespace seekable {
+
+    inline constexpr std::uint32_t skippable_magic = ZSTD_MAGIC_SKIPPABLE_START | 0xE;
+    inline constexpr std::uint32_t seekable_magic = 0x8F92EAB1;
+    inline constexpr size_buffer_t footer_size = 9;
+    inline constexpr size_buffer_t skippable_header_size = 8;
+    /// Upper bound of a frame's decompressed size (as upstream)
+    inline constexpr size_buffer_t max_frame_size = size_buffer_t{1} << 30;
+    inline constexpr size_buffer_t default_frame_size = size_buffer_t{1} << 20;
+
+    namespace detail {
+        inline void write_le32(std::ostream& out, std::uint32_t value){
+            std::array<char, 4> const bytes{
+                static_cast<char>(value & 0xFF), static_cast<char>((value >> 8) & 0xFF),
+                static_cast<char>((value >> 16) & 0xFF), static_cast<char>((value >> 24) & 0xFF)
+            };
+            out.write(bytes.data(), bytes.size());
+        }
+
+        inline std::uint32_t read_le32(byte_t const* p){
+            return std::uint32_t{p[0]} | (std::uint32_t{p[1]} << 8)
+                 | (std::uint32_t{p[2]} << 16) | (std::uint32_t{p[3]} << 24);
+        }
+    } // namespace detail
+
+    struct FrameEntry {
+        std::uint64_t compressed_offset;
+        std::uint64_t decompressed_offset;
+        std::uint32_t compressed_size;
+        std::uint32_t decompressed_size;
+    };
+
+    class SeekTable {
+      public:
+        void add(std::uint32_t compressed_size, std::uint32_t decompressed_size){
+            frames_.push_back(FrameEntry{compressed_size_, decompressed_size_, compressed_size, decompressed_size});
+            compressed_size_ += compressed_size;
+            decompressed_size_ += decompressed_size;
+        }
+
+        std::vector<FrameEntry> const& frames() const noexcept { return frames_; }
+        std::uint64_t compressed_size() const noexcept { return compressed_size_; }
+        std::uint64_t decompressed_size() const noexcept { return decompressed_size_; }
+
+        /// Index of the frame holding the decompressed byte at `offset`
+        size_buffer_t frame_index(std::uint64_t offset) const {
+            auto const it = std::upper_bound(frames_.begin(), frames_.end(), offset,
+                [](std::uint64_t pos, FrameEntry const& frame){ return pos < frame.decompressed_offset; });
+            return static_cast<size_buffer_t>(it - frames_.begin()) - 1;
+        }
+
+        /// Write the table as a skippable frame (without checksums)
+        void write(std::ostream& out) const {
+            auto const content_size = frames_.size() * 8 + footer_size;
+            detail::write_le32(out, skippable_magic);
+            detail::write_le32(out, static_cast<std::uint32_t>(content_size));
+            for (auto const& frame : frames_) {
+                detail::write_le32(out, frame.compressed_size);
+                detail::write_le32(out, frame.decompressed_size);
+            }
+            detail::write_le32(out, static_cast<std::uint32_t>(frames_.size()));
+            out.put(0); // Seek_Table_Descriptor: no checksum
+            detail::write_le32(out, seekable_magic);
+        }
+
+        /// Read the table at the end of a seekable input
+        static SeekTable read(std::istream& in){
+            in.seekg(0, std::ios::end);
+            auto const total_size = static_cast<std::uint64_t>(in.tellg());
+            if (total_size < skippable_header_size + footer_size) {
+                throw std::runtime_error("seekable: input too small for a seek table!");
+            }
+
+            std::array<byte_t, footer_size> footer{};
+            in.seekg(static_cast<std::streamoff>(total_size - footer_size));
+            in.read(reinterpret_cast<char*>(footer.data()), footer.size());
+            if (!in || detail::read_le32(footer.data() + 5) != seekable_magic) {
+                throw std::runtime_error("seekable: seek table not found!");
+            }
+            auto const nb_frames = detail::read_le32(footer.data());
+            auto const descriptor = footer[4];
+            if ((descriptor & 0x7C) != 0) {
+                throw std::runtime_error("seekable: reserved bits set in the seek table descriptor!");
+            }
+            size_buffer_t const entry_size = (descriptor & 0x80) ? 12 : 8;
+
+            auto const table_size = std::uint64_t{nb_frames} * entry_size + footer_size;
+            if (table_size + skippable_header_size > total_size) {
+                throw std::runtime_error("seekable: corrupted seek table!");
+            }
+            buffer_t table(skippable_header_size + table_size);
+            in.seekg(static_cast<std::streamoff>(total_size - table.size()));
+            in.read(reinterpret_cast<char*>(table.data()), static_cast<std::streamsize>(table.size()));
+            if (!in || detail::read_le32(table.data()) != skippable_magic
+                    || detail::read_le32(table.data() + 4) != table_size) {
+                throw std::runtime_error("seekable: corrupted seek table!");
+            }
+
+            SeekTable result{};
+            result.frames_.reserve(nb_frames);
+            for (std::uint32_t i = 0; i < nb_frames; ++i) {
+                auto const* entry = table.data() + skippable_header_size + i * entry_size;
+                auto const decompressed_size = detail::read_le32(entry + 4);
+                if (decompressed_size > max_frame_size) {
+                    throw std::runtime_error("seekable: frame larger than 1 GiB in the seek table!");
+                }
+                result.add(detail::read_le32(entry), decompressed_size);
+            }
+            if (result.compressed_size() + table.size() != total_size) {
+                throw std::runtime_error("seekable: seek table does not match the input size!");
+            }
+            return result;
+        }
+
+      private:
+        std::vector<FrameEntry> frames_{};
+        std::uint64_t compressed_size_{0};
+        std::uint64_t decompressed_size_{0};
+    };
+
+    /* Writer: cuts the data written into independent frames */
+    class Writer {
+      public:
+        explicit Writer(
+            std::ostream& out,
+            size_buffer_t frame_size = default_frame_size,
+            Params params = Params{}.level(3),
+            ContextPool& pool = ContextPool::global()
+        )
+        : out_(out), frame_size_(frame_size), params_(std::move(params)), cctx_(pool.acquire_cctx()) {
+            if (frame_size_ == 0 || frame_size_ > max_frame_size) {
+                throw std::invalid_argument("seekable: frame size must be in (0, 1 GiB]");
+            }
+            frame_.reserve(frame_size_);
+        }
+
+        Writer(Writer const&) = delete;
+        Writer& operator=(Writer const&) = delete;
+
+        /// Finishes the stream if close() was not called (errors are lost, prefer close())
+        ~Writer(){
+            try {
+                close();
+            } catch (...) {
+            }
+        }
+
+        void write(rospan_t data){
+            auto const* p = reinterpret_cast<byte_t const*>(data.data());
+            auto remaining = data.size();
+            while (remaining > 0) {
+                auto const n = std::min(remaining, frame_size_ - frame_.size());
+                frame_.insert(frame_.end(), p, p + n);
+                p += n;
+                remaining -= n;
+                if (frame_.size() == frame_size_) {
+                    flush_frame();
+                }
+            }
+        }
+
+        /// Write the last frame and the seek table
+        void close(){
+            if (closed_) {
+                return;
+            }
+            closed_ = true;
+            if (!frame_.empty()) {
+                flush_frame();
+            }
+            table_.write(out_);
+            out_.flush();
+        }
+
+        SeekTable const& table() const noexcept { return table_; }
+
+      private:
+        void flush_frame(){
+            out_buffer_.resize(compress_bound(frame_.size()));
+            auto const size = compress_into(cctx_.get(), utils::as_bytes(frame_),
+                                            utils::as_writable_bytes(out_buffer_), params_).value();
+            out_.write(reinterpret_cast<char const*>(out_buffer_.data()), static_cast<std::streamsize>(size));
+            table_.add(static_cast<std::uint32_t>(size), static_cast<std::uint32_t>(frame_.size()));
+            frame_.clear();
+        }
+
+        std::ostream& out_;
+        size_buffer_t const frame_size_;
+        Params const params_;
+        ContextPool::CCtxLease cctx_;
+        buffer_t frame_{};
+        buffer_t out_buffer_{};
+        SeekTable table_{};
+        bool closed_{false};
+    };
+
+    /* Reader: random access to the decompressed data of a seekable input */
+    class Reader {
+      public:
+        explicit Reader(std::istream& in, ContextPool& pool = ContextPool::global())
+        : in_(in), table_(SeekTable::read(in)), dctx_(pool.acquire_dctx()) {}
+
+        /// Decompressed size of the whole input
+        std::uint64_t size() const noexcept { return table_.decompressed_size(); }
+        SeekTable const& table() const noexcept { return table_; }
+
+        /// Copy up to dst.size() bytes from `offset`, returns the number of bytes copied
+        size_buffer_t read_at(std::uint64_t offset, span_t dst){
+            size_buffer_t copied = 0;
+            while (copied < dst.size() && offset < size()) {
+                auto const& frame = load_frame(table_.frame_index(offset));
+                auto const in_frame = static_cast<size_buffer_t>(offset - frame.decompressed_offset);
+                auto const n = std::min(dst.size() - copied, frame.decompressed_size - in_frame);
+                std::memcpy(dst.data() + copied, frame_data_.data() + in_frame, n);
+                copied += n;
+                offset += n;
+            }
+            return copied;
+        }
+
+        buffer_t read_at(std::uint64_t offset, size_buffer_t length){
+            buffer_t out{};
+            out.resize(static_cast<size_buffer_t>(std::min<std::uint64_t>(length, offset < size() ? size() - offset : 0)));
+            read_at(offset, utils::as_writable_bytes(out));
+            return out;
+        }
+
+      private:
+        /// Decompress frame `index` into frame_data_ (kept for the next reads)
+        FrameEntry const& load_frame(size_buffer_t index){
+            auto const& frame = table_.frames()[index];
+            if (loaded_ == index) {
+                return frame;
+            }
+            compressed_.resize(frame.compressed_size);
+            in_.clear();
+            in_.seekg(static_cast<std::streamoff>(frame.compressed_offset));
+            in_.read(reinterpret_cast<char*>(compressed_.data()), frame.compressed_size);
+            if (!in_) {
+                throw std::runtime_error("seekable: failed to read a frame!");
+            }
+            // The table is not trusted either: no more than the frame itself can produce
+            auto const bound = ZSTD_decompressBound(compressed_.data(), compressed_.size());
+            if (bound == ZSTD_CONTENTSIZE_ERROR || frame.decompressed_size > bound) {
+                throw std::runtime_error("seekable: frame size does not match the seek table!");
+            }
+            frame_data_.resize(frame.decompressed_size);
+            auto const size = decompress_into(dctx_.get(), utils::as_bytes(compressed_),
+                                              utils::as_writable_bytes(frame_data_)).value();
+            if (size != frame.decompressed_size) {
+                throw std::runtime_error("seekable: frame size does not match the seek table!");
+            }
+            loaded_ = index;
+            return frame;
+        }
+
+        static constexpr size_buffer_t none = static_cast<size_buffer_t>(-1);
+
+        std::istream& in_;
+        SeekTable const table_;
+        ContextPool::DCtxLease dctx_;
+        buffer_t compressed_{};
+        buffer_t frame_data_{};
+        size_buffer_t loaded_{none};
+    };
+
+    /// Compress `in` to `out` in the seekable format
+    inline void compress(
+        std::istream& in,
+        std::ostream& out,
+        size_buffer_t frame_size = default_frame_size,
+        Params const& params = Params{}.level(3)
+    ){
+        Writer writer(out, frame_size, params);
+        buffer_t chunk{};
+        chunk.resize(std::min(frame_size, ZSTD_CStreamInSize()));
+        while (in) {
+            in.read(reinterpret_cast<char*>(chunk.data()), static_cast<std::streamsize>(chunk.size()));
+            auto const read = static_cast<size_buffer_t>(in.gcount());
+            writer.write(utils::as_bytes(chunk).first(read));
+        }
+        writer.close();
+    }
+
+} // namespace seekable
+} // namespace zstdpp
@@ -0,0 +1,43 @@
+#include "byte_buffer.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <utility>
+
+#include "zstd/zstdpp.hpp"
+
+TEST(ByteBufferTest, KeepsCapacityAcrossReuse) {
+  utils::byte_buffer buffer{};
+  buffer.resize(4096);
+  auto const *storage = buffer.data();
+
+  buffer.clear();
+  buffer.resize(1024);
+  EXPECT_EQ(storage, buffer.data());
+  EXPECT_GE(buffer.capacity(), 4096u);
+
+  // Releasing is a move: no copy of the storage
+  auto released = std::move(buffer);
+  EXPECT_EQ(storage, released.data());
+  EXPECT_EQ(utils::to_vector(released).size(), 1024u);
+}
+
+TEST(ByteBufferTest, AlignedStorage) {
+  utils::aligned_byte_buffer<4096> aligned(100);
+  EXPECT_EQ(reinterpret_cast<std::uintptr_t>(aligned.data()) % 4096, 0u);
+
+  utils::huge_byte_buffer huge(utils::huge_page_size);
+  EXPECT_EQ(reinterpret_cast<std::uintptr_t>(huge.data()) % utils::huge_page_size, 0u);
+}
+
+TEST(ByteBufferTest, CompressionOutputIsReused) {
+  std::string const text(64 * 1024, 'x');
+  zstdpp::buffer_t compressed{};
+  zstdpp::inplace::compress(zstdpp::utils::to_bytes(text), compressed);
+  auto const *storage = compressed.data();
+
+  zstdpp::inplace::compress(zstdpp::utils::to_bytes(text), compressed);
+  EXPECT_EQ(storage, compressed.data());
+  EXPECT_EQ(text, zstdpp::utils::to_string(zstdpp::decompress(compressed)));
+}
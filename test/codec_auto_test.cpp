@@ -0,0 +1,121 @@
+#include "codec_auto.hpp"
+
+#include <gtest/gtest.h>
+
+#include "corpus.hpp"
+
+namespace {
+
+using utils::corpus::Kind;
+
+}  // namespace
+
+TEST(CodecAutoTest, RoundTrip) {
+  for (auto kind : utils::corpus::all_kinds) {
+    for (std::size_t size : {0, 1, 1000, 70000, 1000000}) {
+      SCOPED_TRACE(std::string(utils::corpus::name(kind)) + " " + std::to_string(size));
+      auto const data = utils::corpus::generate(kind, size);
+      auto const packed = codec::auto_compress(codec::as_bytes(data));
+      EXPECT_LE(packed.size(), codec::auto_bound(size));
+      EXPECT_LE(packed.size(), size + 11);  // never much larger than the input
+      EXPECT_EQ(data, codec::auto_decompress(codec::as_bytes(packed)));
+    }
+  }
+}
+
+TEST(CodecAutoTest, IncompressibleIsStored) {
+  auto const random = utils::corpus::generate(Kind::random, 300000);
+  EXPECT_EQ(codec::Method::stored, codec::choose(codec::as_bytes(random)).method);
+  auto const packed = codec::auto_compress(codec::as_bytes(random));
+  EXPECT_EQ(random.size() + 4, packed.size());  // flags + 3-byte varint
+
+  codec::AutoHeader header{};
+  ASSERT_TRUE(codec::read_auto_header(codec::as_bytes(packed), header));
+  EXPECT_EQ(codec::Method::stored, header.method);
+  EXPECT_EQ(random.size(), header.original_size);
+
+  // Entropy below the bypass threshold: still stored after the trial
+  auto policy = codec::Policy{};
+  policy.max_entropy = 8.0;
+  EXPECT_EQ(codec::Method::stored, codec::choose(codec::as_bytes(random), policy).method);
+}
+
+TEST(CodecAutoTest, PolicyWeighsCpuAgainstRatio) {
+  auto const logs = utils::corpus::generate(Kind::logs, 500000);
+  auto const fast = codec::choose(codec::as_bytes(logs), codec::Policy::fast());
+  EXPECT_NE(codec::Method::stored, fast.method);
+  EXPECT_LE(fast.level, 1);
+
+  // CPU for free: the best sampled ratio wins, i.e. the strongest zstd level
+  auto policy = codec::Policy{};
+  policy.cpu_weight = 0;
+  auto const text = utils::corpus::generate(Kind::text, 500000);
+  auto const best = codec::choose(codec::as_bytes(text), policy);
+  EXPECT_EQ(codec::Method::zstd, best.method);
+  EXPECT_EQ(3, best.level);
+  EXPECT_EQ(9, codec::choose(codec::as_bytes(text), codec::Policy::ratio()).level);
+
+  // CPU only: the cheapest candidate
+  policy.cpu_weight = 10;
+  EXPECT_EQ(codec::Method::lz4, codec::choose(codec::as_bytes(logs), policy).method);
+
+  // Too small to sample: the `small` codec, once the entropy allows it
+  auto const small = utils::corpus::generate(Kind::logs, 8000);
+  EXPECT_EQ(codec::Method::zstd, codec::choose(codec::as_bytes(small)).method);
+  EXPECT_EQ(codec::Method::lz4, codec::choose(codec::as_bytes(small), codec::Policy::fast()).method);
+}
+
+TEST(CodecAutoTest, CorruptedEnvelope) {
+  auto const data = utils::corpus::generate(Kind::json, 50000);
+  auto packed = codec::auto_compress(codec::as_bytes(data));
+  std::vector<std::byte> out(data.size());
+
+  EXPECT_FALSE(codec::auto_decompress_into({}, out));
+  EXPECT_FALSE(codec::auto_decompress_into(codec::as_bytes(packed).first(2), out));
+  EXPECT_FALSE(codec::auto_decompress_into(codec::as_bytes(packed), std::span(out).first(10)));
+
+  packed[0] = std::uint8_t{0xE3};  // unknown version and codec
+  EXPECT_FALSE(codec::auto_decompress_into(codec::as_bytes(packed), out));
+  EXPECT_THROW(codec::auto_decompress(codec::as_bytes(packed)), std::runtime_error);
+
+  // stored envelope whose size does not match the payload
+  auto const stored = utils::byte_buffer{0x21, 0x05, 1, 2, 3};
+  EXPECT_FALSE(codec::auto_decompress_into(codec::as_bytes(stored), out));
+
+  // zstd envelope whose size is not the content size of the frame
+  auto const text = utils::corpus::generate(Kind::text, 50000);
+  auto zstd = codec::auto_compress(codec::as_bytes(text));
+  ASSERT_EQ(lz4::envelope::codec_zstd, zstd[0] & lz4::envelope::codec_mask);
+  zstd[1] ^= 0x01;
+  EXPECT_FALSE(codec::auto_decompress_into(codec::as_bytes(zstd), out));
+
+  // 24-byte zstd envelope claiming 2^40 bytes, in the envelope and in the frame: rejected before allocating
+  utils::byte_buffer const forged{0x22, 0x80, 0x80, 0x80, 0x80, 0x80, 0x20,  // zstd, varint 2^40
+                                  0x28, 0xB5, 0x2F, 0xFD, 0xE0,              // magic, descriptor
+                                  0, 0, 0, 0, 0, 1, 0, 0,                    // content size 2^40
+                                  0x09, 0, 0, 'x'};                          // one raw block of 1 byte
+  ASSERT_EQ(24u, forged.size());
+  ASSERT_EQ(std::size_t{1} << 40, *zstdpp::decompressed_size(codec::as_bytes(forged).subspan(7)));
+  codec::AutoHeader forged_header{};
+  EXPECT_FALSE(codec::read_auto_header(codec::as_bytes(forged), forged_header));
+  EXPECT_THROW(codec::auto_decompress(codec::as_bytes(forged)), std::runtime_error);
+}
+
+TEST(CodecAutoTest, SameEnvelopeAsLz4) {
+  auto const data = utils::corpus::generate(Kind::logs, 100000);
+  auto const packed = codec::auto_compress(codec::as_bytes(data));
+  ASSERT_EQ(data.size(), *lz4::envelope::original_size(codec::as_bytes(packed)));
+
+  // lz4::compress_framed output (with its checksum) decodes as well
+  lz4::buffer_t framed{};
+  ASSERT_TRUE(lz4::compress_framed(data, framed));
+  EXPECT_EQ(data, codec::auto_decompress(codec::as_bytes(framed)));
+  framed.back() ^= 0x01;
+  std::vector<std::byte> out(data.size());
+  EXPECT_FALSE(codec::auto_decompress_into(codec::as_bytes(framed), out));
+
+  // ... but the lz4 functions do not decode zstd payloads
+  ASSERT_EQ(codec::Method::zstd, codec::choose(codec::as_bytes(data)).method);
+  lz4::buffer_t unpacked{};
+  EXPECT_EQ(lz4::Error::header_invalid, lz4::decompress_framed(packed, unpacked).error());
+}
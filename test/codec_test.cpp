@@ -0,0 +1,80 @@
+#include "codec.hpp"
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <string>
+
+#include "corpus.hpp"
+
+namespace {
+
+template <typename C>
+class CodecTest : public ::testing::Test {};
+
+using Codecs = ::testing::Types<codec::zstd_codec, codec::lz4_codec, codec::lz4hc_codec, codec::passthrough_codec>;
+TYPED_TEST_SUITE(CodecTest, Codecs);
+
+}  // namespace
+
+TYPED_TEST(CodecTest, BlockRoundTrip) {
+  TypeParam const codec{};
+  for (std::size_t size : {0, 1, 4095, 4096, 4097, 100000}) {
+    SCOPED_TRACE(size);
+    auto const data = utils::corpus::generate(utils::corpus::Kind::logs, size);
+    utils::byte_buffer compressed{};
+    auto const written = codec::compress_blocks(codec, codec::as_bytes(data), 4096, compressed);
+    EXPECT_EQ(compressed.size(), written);
+    EXPECT_LE(written, codec::blocks_bound<TypeParam>(size, 4096));
+
+    utils::byte_buffer restored{1, 2, 3};  // appended to
+    EXPECT_EQ(size, codec::decompress_blocks(codec, codec::as_bytes(compressed), restored));
+    ASSERT_EQ(size + 3, restored.size());
+    EXPECT_TRUE(std::equal(data.begin(), data.end(), restored.begin() + 3));
+  }
+}
+
+TYPED_TEST(CodecTest, BlockErrors) {
+  TypeParam const codec{};
+  utils::byte_buffer out{};
+  EXPECT_THROW(codec::compress_blocks(codec, {}, 0, out), std::invalid_argument);
+
+  auto const data = utils::corpus::generate(utils::corpus::Kind::text, 10000);
+  utils::byte_buffer compressed{};
+  codec::compress_blocks(codec, codec::as_bytes(data), 4096, compressed);
+  EXPECT_THROW(codec::decompress_blocks(codec, codec::as_bytes(compressed).first(compressed.size() - 1), out),
+               std::runtime_error);
+  EXPECT_THROW(codec::decompress_blocks(codec, codec::as_bytes(compressed).first(2), out), std::runtime_error);
+}
+
+TYPED_TEST(CodecTest, StreamRoundTrip) {
+  TypeParam const codec{};
+  auto const data = utils::corpus::generate(utils::corpus::Kind::json, 300000);
+  std::string const text(data.begin(), data.end());
+  std::istringstream in(text);
+  std::stringstream compressed;
+  codec::compress(codec, in, compressed, 65536);
+  if constexpr (!TypeParam::supports_streaming) {
+    EXPECT_EQ(text.size() + 5 * 4, compressed.str().size());  // block fallback: one header per chunk
+  }
+  std::ostringstream restored;
+  codec::decompress(codec, compressed, restored);
+  EXPECT_EQ(text, restored.str());
+
+  if constexpr (!TypeParam::supports_streaming) {
+    // A block header claiming 4 GiB: rejected before the block is allocated
+    std::istringstream forged(std::string(8, '\xFF'));
+    std::ostringstream out;
+    EXPECT_THROW(codec::decompress(codec, forged, out), std::runtime_error);
+  }
+}
+
+TEST(CodecTraitsTest, CompileTimeTraits) {
+  static_assert(codec::zstd_codec::supports_streaming && !codec::zstd_codec::needs_size);
+  static_assert(codec::lz4_codec::needs_size && codec::lz4hc_codec::needs_size);
+  static_assert(!codec::passthrough_codec::supports_streaming);
+  static_assert(!codec::Codec<int>);
+  EXPECT_EQ("lz4hc", codec::lz4hc_codec::name);
+  EXPECT_EQ(lz4::hc_min_level, codec::lz4hc_codec{1}.level);  // clamped to the HC range
+  EXPECT_EQ(100, codec::passthrough_codec::compress_bound(100));
+}
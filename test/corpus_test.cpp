@@ -0,0 +1,51 @@
+#include "corpus.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <filesystem>
+
+namespace {
+
+// FNV-1a: pins the generated bytes, so any change to a generator is noticed
+std::uint64_t fnv1a(utils::byte_buffer const &data) {
+  std::uint64_t hash = 0xcbf29ce484222325ULL;
+  for (auto byte : data) {
+    hash = (hash ^ byte) * 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+}  // namespace
+
+TEST(CorpusTest, ReproducibleBySeed) {
+  for (auto kind : utils::corpus::all_kinds) {
+    SCOPED_TRACE(utils::corpus::name(kind));
+    auto const data = utils::corpus::generate(kind, 100000);
+    ASSERT_EQ(100000u, data.size());
+    EXPECT_EQ(data, utils::corpus::generate(kind, 100000));
+    if (kind != utils::corpus::Kind::zeros) {
+      EXPECT_NE(data, utils::corpus::generate(kind, 100000, 7));
+    }
+  }
+  EXPECT_TRUE(utils::corpus::generate(utils::corpus::Kind::logs, 0).empty());
+
+  // Same bytes on every platform and standard library
+  EXPECT_EQ(0xe5dab16a984a1938ULL, fnv1a(utils::corpus::generate(utils::corpus::Kind::text, 4096)));
+  EXPECT_EQ(0x7c466625a1a888ecULL, fnv1a(utils::corpus::generate(utils::corpus::Kind::logs, 4096)));
+  EXPECT_EQ(0x8e2afa04bca29fb4ULL, fnv1a(utils::corpus::generate(utils::corpus::Kind::numeric, 4096)));
+}
+
+TEST(CorpusTest, LoadPrefersWrittenFiles) {
+  auto const dir = std::filesystem::temp_directory_path() / "corpus_test";
+  std::filesystem::remove_all(dir);
+  auto const kind = utils::corpus::Kind::json;
+
+  auto const generated = utils::corpus::load(kind, 5000, 1, dir);  // no file: generated
+  auto const path = utils::corpus::write(dir, kind, 5000, 1);
+  EXPECT_EQ(dir / utils::corpus::file_name(kind, 5000, 1), path);
+  EXPECT_EQ(5000u, std::filesystem::file_size(path));
+  EXPECT_EQ(generated, utils::corpus::load(kind, 5000, 1, dir));
+
+  std::filesystem::remove_all(dir);
+}
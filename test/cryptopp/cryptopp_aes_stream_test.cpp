@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "aes_stream.hpp"
+#include "corpus.hpp"
+
+class CryptoPPStreamTestF : public ::testing::Test {
+protected:
+  void SetUp() override {
+    auto const data = utils::corpus::load(utils::corpus::Kind::text, (1 << 20) + 5);
+    text.assign(data.begin(), data.end());
+  }
+
+public:
+  std::string text{};
+  cryptopp::buffer_t key = to_bytes("BAF7D2A2B1EAF3BE64AA64C3A0938E06");
+  cryptopp::buffer_t iv = to_bytes("000102030405060D");
+
+  static cryptopp::buffer_t to_bytes(std::string const &str) {
+    return cryptopp::buffer_t(str.begin(), str.end());
+  }
+};
+
+TEST_F(CryptoPPStreamTestF, MatchesAesCbc) {
+  // Chunks smaller than a block, not block-aligned, and larger than the input
+  for (size_t size : {size_t{0}, size_t{16}, size_t{1000}, text.size()}) {
+    auto const plain = text.substr(0, size);
+    cryptopp::buffer_t expected;
+    ASSERT_TRUE(cryptopp::AesCbcEncrypt(key, iv, to_bytes(plain), expected));
+
+    for (size_t chunk : {size_t{7}, size_t{4096 + 3}, cryptopp::stream::default_chunk_size, size_t{4} << 20}) {
+      if (chunk == 7 && size > 1000) {
+        continue;
+      }
+      std::stringstream in(plain), cipher;
+      ASSERT_TRUE(cryptopp::stream::encrypt(in, cipher, key, iv, chunk));
+      EXPECT_EQ(expected, to_bytes(cipher.str())) << size << " " << chunk;
+
+      std::stringstream recovered;
+      ASSERT_TRUE(cryptopp::stream::decrypt(cipher, recovered, key, iv, chunk));
+      EXPECT_EQ(plain, recovered.str()) << size << " " << chunk;
+    }
+  }
+
+  // Truncated cipher, bad iv
+  std::stringstream in(text), cipher;
+  ASSERT_TRUE(cryptopp::stream::encrypt(in, cipher, key, iv));
+  std::stringstream truncated(cipher.str().substr(0, cipher.str().size() - 5)), garbage;
+  EXPECT_FALSE(cryptopp::stream::decrypt(truncated, garbage, key, iv));
+  std::stringstream in_copy(text);
+  EXPECT_FALSE(cryptopp::stream::encrypt(in_copy, garbage, key, to_bytes("short")));
+}
+
+TEST_F(CryptoPPStreamTestF, FileRoundTrip) {
+  auto const dir = std::filesystem::temp_directory_path();
+  auto const plain = (dir / "cryptopp_aes_stream_test.txt").string();
+  auto const sealed = plain + ".aes";
+  auto const recovered = plain + ".out";
+  std::ofstream(plain, std::ios::binary) << text;
+
+  ASSERT_TRUE(cryptopp::stream::encrypt_file(plain, sealed, key, iv));
+  EXPECT_EQ(cryptopp::GetCipherLen(text.size()), std::filesystem::file_size(sealed));
+  ASSERT_TRUE(cryptopp::stream::decrypt_file(sealed, recovered, key, iv));
+  std::ifstream recovered_file(recovered, std::ios::binary);
+  std::stringstream recovered_text;
+  recovered_text << recovered_file.rdbuf();
+  EXPECT_EQ(text, recovered_text.str());
+
+  // A missing input leaves the output alone
+  EXPECT_FALSE(cryptopp::stream::encrypt_file(plain + ".missing", sealed, key, iv));
+  EXPECT_EQ(cryptopp::GetCipherLen(text.size()), std::filesystem::file_size(sealed));
+  EXPECT_FALSE(cryptopp::stream::decrypt_file(plain + ".missing", recovered, key, iv));
+  EXPECT_EQ(text.size(), std::filesystem::file_size(recovered));
+
+  // Unopened stream: not an empty input
+  std::ifstream missing(plain + ".missing", std::ios::binary);
+  std::stringstream nothing;
+  EXPECT_FALSE(cryptopp::stream::encrypt(missing, nothing, key, iv));
+  EXPECT_FALSE(cryptopp::stream::decrypt(missing, nothing, key, iv));
+  EXPECT_TRUE(nothing.str().empty());
+  std::filesystem::remove(plain);
+  std::filesystem::remove(sealed);
+  std::filesystem::remove(recovered);
+}
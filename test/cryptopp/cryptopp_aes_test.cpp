@@ -1,6 +1,10 @@
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <string>
+
 #include "aes_api.hpp"
+#include "aes_cipher.hpp"
 
 class CryptoPPTestF : public ::testing::Test {
 protected:
@@ -27,6 +31,13 @@ public:
     }
     return bytes;
   }
+  cryptopp::buffer_t from_hex(std::string const &hex) {
+    cryptopp::buffer_t bytes{};
+    for (size_t i = 0; i + 1 < hex.size(); i += 2) {
+      bytes.push_back(static_cast<cryptopp::byte_t>(std::stoi(hex.substr(i, 2), nullptr, 16)));
+    }
+    return bytes;
+  }
   cryptopp::string_t to_string(cryptopp::buffer_t const &bytes) {
     cryptopp::string_t str{};
     str.reserve(bytes.size());
@@ -55,4 +66,157 @@ TEST_F(CryptoPPTestF, AesCbcRoundTrip) {
   ASSERT_TRUE(cryptopp::AesCbcDecrypt(key, iv, cipher, recovered));
 
   EXPECT_EQ(plain, recovered);
-}
\ No newline at end of file
+
+  // Wrong key or IV sizes: reported, not thrown
+  cryptopp::buffer_t const short_key(16, 0x42), short_iv(8, 0x24);
+  EXPECT_FALSE(cryptopp::AesCbcEncrypt(short_key, iv, plain, cipher));
+  EXPECT_FALSE(cryptopp::AesCbcEncrypt(key, short_iv, plain, cipher));
+  EXPECT_FALSE(cryptopp::AesCbcDecrypt(short_key, iv, cipher, recovered));
+  EXPECT_FALSE(cryptopp::AesCbcDecrypt(key, short_iv, cipher, recovered));
+}
+TEST_F(CryptoPPTestF, AesCtrKnownAnswerAndParallel) {
+  // NIST SP 800-38A, F.5.5 CTR-AES256.Encrypt (the counter carries into byte 14)
+  auto const key = from_hex("603deb1015ca71be2b73aef0857d77811f352c073b6108d72d9810a30914dff4");
+  auto const iv = from_hex("f0f1f2f3f4f5f6f7f8f9fafbfcfdfeff");
+  auto const plain = from_hex("6bc1bee22e409f96e93d7e117393172aae2d8a571e03ac9c9eb76fac45af8e51"
+                              "30c81c46a35ce411e5fbc1191a0a52eff69f2445df4f9b17ad2b417be66c3710");
+  auto const expected = from_hex("601ec313775789a5b7a7f504bbf3d228f443e3ca4d62b59aca84e990cacaf5c5"
+                                 "2b0930daa23de94ce87017ba2d84988ddfc9c58db67aada613c2dd08457941a6");
+  cryptopp::buffer_t cipher, recovered;
+  ASSERT_TRUE(cryptopp::AesCtrEncrypt(key, iv, plain, cipher));
+  EXPECT_EQ(expected, cipher);
+
+  // Segments of 2 blocks: the same cipher, whatever the thread
+  utils::ThreadPool pool{3};
+  cryptopp::buffer_t parallel;
+  ASSERT_TRUE(cryptopp::AesCtrEncryptParallel(key, iv, plain, parallel, pool, 32));
+  EXPECT_EQ(expected, parallel);
+
+  // Larger input with a partial last block; segment size rounded up to whole blocks
+  cryptopp::buffer_t big(3 * 1024 * 1024 + 7);
+  for (size_t i = 0; i < big.size(); ++i) {
+    big[i] = static_cast<cryptopp::byte_t>(i * 31 + (i >> 12));
+  }
+  ASSERT_TRUE(cryptopp::AesCtrEncrypt(key, iv, big, cipher));
+  ASSERT_TRUE(cryptopp::AesCtrEncryptParallel(key, iv, big, parallel, pool, 100000));
+  EXPECT_EQ(cipher, parallel);
+  ASSERT_TRUE(cryptopp::AesCtrDecryptParallel(key, iv, parallel, recovered, pool));
+  EXPECT_EQ(big, recovered);
+
+  EXPECT_FALSE(cryptopp::AesCtrEncrypt(key, from_hex("0001"), plain, cipher));
+}
+
+TEST_F(CryptoPPTestF, AesGcmKnownAnswerAndTampering) {
+  // GCM specification, test case 16 (AES-256, 96-bit IV, with AAD)
+  auto const key = from_hex("feffe9928665731c6d6a8f9467308308feffe9928665731c6d6a8f9467308308");
+  auto const iv = from_hex("cafebabefacedbaddecaf888");
+  auto const aad = from_hex("feedfacedeadbeeffeedfacedeadbeefabaddad2");
+  auto const plain = from_hex("d9313225f88406e5a55909c5aff5269a86a7a9531534f7da2e4c303d8a318a72"
+                              "1c3c0c95956809532fcf0e2449a6b525b16aedf5aa0de657ba637b39");
+  auto const expected = from_hex("522dc1f099567d07f47f37a32a84427d643a8cdcbfe5c0c97598a2bd2555d1aa"
+                                 "8cb08e48590dbb3da7b08b1056828838c5f61e6393ba7a0abcc9f662"
+                                 "76fc6ece0f4e1768cddf8853bb2d551b");  // tag
+  cryptopp::buffer_t cipher, recovered;
+  ASSERT_TRUE(cryptopp::AesGcmEncrypt(key, iv, plain, cipher, aad));
+  EXPECT_EQ(expected, cipher);
+  ASSERT_TRUE(cryptopp::AesGcmDecrypt(key, iv, cipher, recovered, aad));
+  EXPECT_EQ(plain, recovered);
+
+  // Any change is detected
+  auto tampered = cipher;
+  tampered[5] ^= 1;
+  EXPECT_FALSE(cryptopp::AesGcmDecrypt(key, iv, tampered, recovered, aad));
+  EXPECT_TRUE(recovered.empty());
+  EXPECT_FALSE(cryptopp::AesGcmDecrypt(key, iv, cipher, recovered));  // aad missing
+  EXPECT_FALSE(cryptopp::AesGcmDecrypt(key, iv, cryptopp::buffer_t(8), recovered));
+
+  // Empty message: only the tag
+  ASSERT_TRUE(cryptopp::AesGcmEncrypt(key, iv, {}, cipher));
+  EXPECT_EQ(cryptopp::GCM_TAG_LENGTH, cipher.size());
+  ASSERT_TRUE(cryptopp::AesGcmDecrypt(key, iv, cipher, recovered));
+  EXPECT_TRUE(recovered.empty());
+}
+
+TEST_F(CryptoPPTestF, AesCipherMatchesAesCbc) {
+  auto const key = to_bytes("BAF7D2A2B1EAF3BE64AA64C3A0938E06");
+  auto const plain = to_bytes(input);
+  cryptopp::AesCipher cipher_object(key);
+
+  // Every padding length, and a new IV per message on the same object
+  for (size_t size = 0; size <= 40; ++size) {
+    cryptopp::buffer_t const iv(CryptoPP::AES::BLOCKSIZE, static_cast<cryptopp::byte_t>(size));
+    cryptopp::buffer_t const prefix(plain.begin(), plain.begin() + static_cast<std::ptrdiff_t>(size));
+    cryptopp::buffer_t expected, cipher, recovered;
+    ASSERT_TRUE(cryptopp::AesCbcEncrypt(key, iv, prefix, expected));
+
+    cipher_object.encrypt(iv, prefix, cipher);
+    EXPECT_EQ(expected, cipher) << size;
+    cipher_object.decrypt(iv, cipher, recovered);
+    EXPECT_EQ(prefix, recovered) << size;
+  }
+
+  // Batch into one presized buffer
+  cryptopp::buffer_t const ivs = from_hex("000102030405060708090a0b0c0d0e0f"
+                                          "f0f1f2f3f4f5f6f7f8f9fafbfcfdfeff");
+  cryptopp::buffer_t out(2 * cryptopp::GetCipherLen(plain.size()));
+  std::span<cryptopp::byte_t> out_span(out);
+  auto const len = cryptopp::GetCipherLen(plain.size());
+  cryptopp::AesMessage messages[] = {
+      {ivs.data(), plain, out_span.first(len)},
+      {ivs.data() + CryptoPP::AES::BLOCKSIZE, plain, out_span.subspan(len)}};
+  cipher_object.encrypt_batch(messages);
+  for (size_t i = 0; i < 2; ++i) {
+    cryptopp::buffer_t const iv(messages[i].iv, messages[i].iv + CryptoPP::AES::BLOCKSIZE);
+    cryptopp::buffer_t expected;
+    ASSERT_TRUE(cryptopp::AesCbcEncrypt(key, iv, plain, expected));
+    EXPECT_EQ(len, messages[i].size);
+    EXPECT_TRUE(std::equal(expected.begin(), expected.end(), messages[i].output.begin()));
+  }
+
+  // Errors throw
+  cryptopp::buffer_t small(len - 1), recovered;
+  EXPECT_THROW(cipher_object.encrypt(ivs.data(), plain, small), CryptoPP::InvalidArgument);
+  EXPECT_THROW(cipher_object.decrypt(ivs.data(), small, recovered), CryptoPP::InvalidCiphertext);
+  EXPECT_THROW(cipher_object.decrypt(cryptopp::buffer_t(3), out, recovered), CryptoPP::InvalidArgument);
+  EXPECT_THROW(cryptopp::AesCipher{cryptopp::buffer_t(5)}, CryptoPP::InvalidArgument);
+}
+
+TEST_F(CryptoPPTestF, AesCbcDecryptParallel) {
+  auto const key = to_bytes("BAF7D2A2B1EAF3BE64AA64C3A0938E06");
+  cryptopp::buffer_t const iv(CryptoPP::AES::BLOCKSIZE, 0x24);
+  utils::ThreadPool pool{3};
+
+  // Every padding length, segments of 1 to 3 blocks (IV of a segment = previous cipher block)
+  cryptopp::buffer_t big(3 * 1024 * 1024 + 5);
+  for (size_t i = 0; i < big.size(); ++i) {
+    big[i] = static_cast<cryptopp::byte_t>(i * 7 + (i >> 10));
+  }
+  for (size_t size : {size_t{0}, size_t{15}, size_t{16}, size_t{47}, size_t{100}, big.size()}) {
+    cryptopp::buffer_t const plain(big.begin(), big.begin() + static_cast<std::ptrdiff_t>(size));
+    cryptopp::buffer_t cipher, recovered;
+    ASSERT_TRUE(cryptopp::AesCbcEncrypt(key, iv, plain, cipher));
+    for (size_t segment : {size_t{16}, size_t{40}, size_t{0}}) {
+      if (segment == 16 && size > 1000) {
+        continue;  // one task per block: slow on megabytes
+      }
+      ASSERT_TRUE(cryptopp::AesCbcDecryptParallel(key, iv, cipher, recovered, pool, segment));
+      EXPECT_EQ(plain, recovered) << size << " " << segment;
+    }
+  }
+
+  // Corrupted padding, truncated cipher
+  cryptopp::buffer_t cipher, recovered;
+  ASSERT_TRUE(cryptopp::AesCbcEncrypt(key, iv, to_bytes(input), cipher));
+  cipher.back() ^= 1;
+  EXPECT_FALSE(cryptopp::AesCbcDecryptParallel(key, iv, cipher, recovered, pool, 32));
+  EXPECT_TRUE(recovered.empty());
+  cipher.pop_back();
+  EXPECT_FALSE(cryptopp::AesCbcDecryptParallel(key, iv, cipher, recovered, pool, 32));
+
+  // Corrupted padding in a single segment (decrypted by AesCbcDecrypt, whose sink already has the other blocks)
+  ASSERT_TRUE(cryptopp::AesCbcEncrypt(key, iv, cryptopp::buffer_t(big.begin(), big.begin() + 100000), cipher));
+  cipher.back() ^= 1;
+  recovered.assign(3, 0x55);
+  EXPECT_FALSE(cryptopp::AesCbcDecryptParallel(key, iv, cipher, recovered, pool, 0));
+  EXPECT_TRUE(recovered.empty());
+}
@@ -0,0 +1,101 @@
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "aes_zstd.hpp"
+#include "corpus.hpp"
+
+class CryptoPPZstdTestF : public ::testing::Test {
+protected:
+  void SetUp() override {
+    auto const data = utils::corpus::load(utils::corpus::Kind::logs, 3 << 20);
+    text.assign(data.begin(), data.end());
+  }
+
+public:
+  std::string text{};
+  cryptopp::buffer_t key = to_bytes("BAF7D2A2B1EAF3BE64AA64C3A0938E06");
+  cryptopp::buffer_t iv = to_bytes("000102030405060D");
+
+  static cryptopp::buffer_t to_bytes(std::string const &str) {
+    return cryptopp::buffer_t(str.begin(), str.end());
+  }
+};
+
+TEST_F(CryptoPPZstdTestF, FusedMatchesTwoSteps) {
+  std::stringstream in(text), sealed;
+  ASSERT_TRUE(cryptopp::CompressEncrypt(in, sealed, key, iv));
+
+  // Same bytes as compressing, then encrypting the whole compressed data
+  std::stringstream in_copy(text), compressed;
+  zstdpp::stream::compress(in_copy, compressed);
+  auto const compressed_str = compressed.str();
+  cryptopp::buffer_t cipher;
+  ASSERT_TRUE(cryptopp::AesCbcEncrypt(key, iv, to_bytes(compressed_str), cipher));
+  EXPECT_EQ(to_bytes(sealed.str()), cipher);
+
+  std::stringstream recovered;
+  ASSERT_TRUE(cryptopp::DecryptDecompress(sealed, recovered, key, iv));
+  EXPECT_EQ(text, recovered.str());
+
+  // Wrong key: bad padding or a corrupted zstd frame, never silent garbage
+  auto wrong_key = key;
+  wrong_key[0] ^= 1;
+  std::stringstream sealed_copy(sealed.str()), garbage;
+  EXPECT_FALSE(cryptopp::DecryptDecompress(sealed_copy, garbage, wrong_key, iv));
+
+  // Truncated on a block boundary: valid padding is unlikely, a complete frame impossible
+  auto truncated = sealed.str();
+  truncated.resize(truncated.size() - 2 * CryptoPP::AES::BLOCKSIZE);
+  std::stringstream truncated_in(truncated), truncated_out;
+  EXPECT_FALSE(cryptopp::DecryptDecompress(truncated_in, truncated_out, key, iv));
+}
+
+TEST_F(CryptoPPZstdTestF, HighlyCompressibleRoundTrip) {
+  // A few input bytes decompress to more than the sink's buffer: zstd keeps
+  // flushing after the input is consumed, up to the end of the message
+  for (size_t const size : {size_t{1} << 20, (size_t{3} << 20) + 1000}) {
+    SCOPED_TRACE(size);
+    std::string const zeros(size, '\0');
+    std::stringstream in(zeros), sealed, recovered;
+    ASSERT_TRUE(cryptopp::CompressEncrypt(in, sealed, key, iv));
+    ASSERT_TRUE(cryptopp::DecryptDecompress(sealed, recovered, key, iv));
+    EXPECT_EQ(zeros, recovered.str());
+  }
+}
+
+TEST_F(CryptoPPZstdTestF, FileRoundTrip) {
+  auto const dir = std::filesystem::temp_directory_path();
+  auto const plain = (dir / "cryptopp_aes_zstd_test.txt").string();
+  auto const sealed = plain + ".zst.aes";
+  auto const recovered = plain + ".out";
+  {
+    std::ofstream out(plain, std::ios::binary);
+    out << text;
+  }
+
+  ASSERT_TRUE(cryptopp::CompressEncryptFile(plain, sealed, key, iv, 3, 2));
+  EXPECT_LT(std::filesystem::file_size(sealed), text.size() / 4);
+  ASSERT_TRUE(cryptopp::DecryptDecompressFile(sealed, recovered, key, iv));
+
+  std::ifstream in(recovered, std::ios::binary);
+  std::stringstream content;
+  content << in.rdbuf();
+  EXPECT_EQ(text, content.str());
+
+  // A missing input leaves the output alone
+  auto const sealed_size = std::filesystem::file_size(sealed);
+  EXPECT_FALSE(cryptopp::CompressEncryptFile(plain + ".missing", sealed, key, iv));
+  EXPECT_EQ(sealed_size, std::filesystem::file_size(sealed));
+  EXPECT_FALSE(cryptopp::DecryptDecompressFile(plain + ".missing", recovered, key, iv));
+  EXPECT_EQ(text.size(), std::filesystem::file_size(recovered));
+
+  EXPECT_FALSE(cryptopp::CompressEncryptFile(plain, sealed, to_bytes("short key"), iv));
+
+  std::filesystem::remove(plain);
+  std::filesystem::remove(sealed);
+  std::filesystem::remove(recovered);
+}
@@ -0,0 +1,69 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "lz4_batch.hpp"
+
+class Lz4BatchTestF : public ::testing::Test {
+protected:
+  void SetUp() override {
+    for (int i = 0; i < 1000; ++i) {
+      input.push_back(lz4::utils::as_bytes("GET /items/" + std::to_string(i) + " HTTP/1.1 200 OK items items"));
+    }
+    input.push_back({});
+  }
+
+public:
+  utils::Batch input{};  // the records, themselves in one arena
+  utils::ThreadPool pool{3};
+};
+
+TEST_F(Lz4BatchTestF, RoundTripWithCallerSizes) {
+  lz4::Batch packed{}, unpacked{};
+  lz4::compress_batch(input.records(), packed);
+  ASSERT_EQ(input.size(), packed.size());
+  EXPECT_EQ(packed.offsets.back(), packed.arena.size());
+
+  auto const sizes = input.sizes();
+  lz4::decompress_batch(packed, sizes, unpacked);
+  EXPECT_EQ(input.arena, unpacked.arena);
+  EXPECT_EQ(input.offsets, unpacked.offsets);
+
+  // HC levels: same decoder
+  lz4::compress_batch(input.records(), packed, lz4::hc_min_level);
+  lz4::decompress_batch(packed, sizes, unpacked);
+  EXPECT_EQ(input.arena, unpacked.arena);
+}
+
+TEST_F(Lz4BatchTestF, SubBatchesOnThreadsGiveTheSameArena) {
+  lz4::Batch sequential{}, threaded{}, unpacked{};
+  auto const records = input.records();
+  lz4::compress_batch(records, sequential);
+  lz4::compress_batch(records, threaded, lz4::default_level, &pool, 16);
+  EXPECT_EQ(sequential.arena, threaded.arena);
+  EXPECT_EQ(sequential.offsets, threaded.offsets);
+
+  auto const sizes = input.sizes();
+  lz4::decompress_batch(threaded.records(), sizes, unpacked, &pool, 16);
+  EXPECT_EQ(input.arena, unpacked.arena);
+}
+
+TEST_F(Lz4BatchTestF, WrongSizesThrow) {
+  lz4::Batch packed{}, unpacked{};
+  lz4::compress_batch(input.records(), packed);
+  auto sizes = input.sizes();
+  EXPECT_THROW(lz4::decompress_batch(packed, std::span(sizes).first(3), unpacked), std::invalid_argument);
+
+  sizes[10] -= 1;
+  EXPECT_THROW(lz4::decompress_batch(packed, sizes, unpacked, &pool), std::runtime_error);
+  EXPECT_TRUE(unpacked.empty());
+  sizes[10] += 2;
+  EXPECT_THROW(lz4::decompress_batch(packed, sizes, unpacked), std::runtime_error);
+
+  // More than the block can produce: rejected before sizing the arena
+  sizes = input.sizes();
+  sizes[10] = size_t{1} << 40;
+  EXPECT_THROW(lz4::decompress_batch(packed.records(), sizes, unpacked, &pool, 16), std::runtime_error);
+  EXPECT_TRUE(unpacked.empty());
+}
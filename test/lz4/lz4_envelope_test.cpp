@@ -0,0 +1,73 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "lz4_envelope.hpp"
+
+class Lz4EnvelopeTestF : public ::testing::Test {
+public:
+  const std::string input =
+      "this is a string that I want to compress into a smaller\n"
+      "string. Just to make sure there is enough data in the\n"
+      "compression buffer, I'm going to fill this string with a\n"
+      "decent amount of content. Let's hope this works.\n";
+
+  static std::string_view as_string(lz4::buffer_t const &bytes) {
+    return {reinterpret_cast<char const *>(bytes.data()), bytes.size()};
+  }
+};
+
+TEST_F(Lz4EnvelopeTestF, Xxh32ReferenceValues) {
+  EXPECT_EQ(0x02CC5D05u, lz4::xxh32(lz4::utils::as_bytes(std::string_view(""))));
+  EXPECT_EQ(0x32D153FFu, lz4::xxh32(lz4::utils::as_bytes(std::string_view("abc"))));
+  EXPECT_EQ(0xE2293B2Fu, lz4::xxh32(lz4::utils::as_bytes(std::string_view("Nobody inspects the spammish repetition"))));
+}
+
+TEST_F(Lz4EnvelopeTestF, RoundTripWithoutOutOfBandSize) {
+  std::string random(1000, '\0');
+  std::uint32_t seed = 1;
+  for (auto &c : random) {
+    seed = seed * 1103515245u + 12345u;
+    c = static_cast<char>(seed >> 24);
+  }
+
+  for (std::string_view data : {std::string_view(input), std::string_view(random), std::string_view()}) {
+    for (bool checksum : {true, false}) {
+      lz4::buffer_t packed, unpacked;
+      auto const packed_size = lz4::compress_framed(lz4::utils::as_bytes(data), packed, lz4::default_level, checksum);
+      ASSERT_TRUE(packed_size) << packed_size.message();
+      EXPECT_LE(packed.size(), data.size() + lz4::envelope::max_header_size); // incompressible data is stored
+      EXPECT_EQ(data.size(), *lz4::envelope::original_size(lz4::utils::as_bytes(packed)));
+
+      auto const unpacked_size = lz4::decompress_framed(packed, unpacked);
+      ASSERT_TRUE(unpacked_size) << unpacked_size.message();
+      EXPECT_EQ(data, as_string(unpacked));
+    }
+  }
+}
+
+TEST_F(Lz4EnvelopeTestF, ErrorsAreReturned) {
+  lz4::buffer_t packed, unpacked;
+  ASSERT_TRUE(lz4::compress_framed(lz4::utils::as_bytes(input), packed));
+
+  auto corrupted = packed;
+  corrupted.back() ^= 0x01; // last literal: only the checksum can tell
+  EXPECT_EQ(lz4::Error::checksum_mismatch, lz4::decompress_framed(corrupted, unpacked).error());
+  EXPECT_TRUE(unpacked.empty());
+  EXPECT_TRUE(lz4::decompress_framed(corrupted, unpacked, false));
+
+  auto bad_header = packed;
+  bad_header.front() = 0xFF;
+  EXPECT_EQ(lz4::Error::header_invalid, lz4::decompress_framed(bad_header, unpacked).error());
+
+  auto const truncated = lz4::utils::as_bytes(packed).first(packed.size() / 2);
+  EXPECT_FALSE(lz4::decompress_framed(truncated, unpacked));
+
+  std::array<std::byte, 16> small{};
+  EXPECT_EQ(lz4::Error::dst_too_small,
+            lz4::decompress_framed_into(lz4::utils::as_bytes(packed), small).error());
+}
@@ -0,0 +1,65 @@
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "lz4_frame.hpp"
+
+class Lz4FrameTestF : public ::testing::Test {
+protected:
+  void SetUp() override {
+    // A few MiB, so that the input spans many blocks
+    for (int i = 0; text.size() < (3 << 20); ++i) {
+      text += "record " + std::to_string(i) + ": lz4 frame streaming round trip\n";
+    }
+  }
+
+public:
+  std::string text{};
+};
+
+TEST_F(Lz4FrameTestF, StreamRoundTripWithParams) {
+  lz4::stream::Context ctx{};  // reused by every round trip below
+  for (auto const &params :
+       {lz4::FrameParams{},
+        lz4::FrameParams{.block_size = LZ4F_max4MB, .block_linked = false, .block_checksum = true},
+        lz4::FrameParams{.content_size = text.size(), .compression_level = 9}}) {
+    std::stringstream in(text), compressed, decompressed;
+    lz4::stream::compress(ctx, in, compressed, params);
+    EXPECT_LT(compressed.str().size(), text.size());
+
+    lz4::stream::decompress(ctx, compressed, decompressed);
+    EXPECT_EQ(text, decompressed.str());
+  }
+}
+
+TEST_F(Lz4FrameTestF, CorruptedFrameThrows) {
+  std::stringstream in(text), compressed, decompressed;
+  lz4::stream::compress(in, compressed);
+
+  auto damaged = compressed.str();
+  damaged[damaged.size() / 2] ^= 0x5A;
+  std::stringstream damaged_in(damaged);
+  EXPECT_THROW(lz4::stream::decompress(damaged_in, decompressed), std::runtime_error);
+
+  std::stringstream truncated(compressed.str().substr(0, compressed.str().size() - 4));
+  EXPECT_THROW(lz4::stream::decompress(truncated, decompressed), std::runtime_error);
+}
+
+TEST_F(Lz4FrameTestF, FileRoundTrip) {
+  auto const dir = std::filesystem::temp_directory_path();
+  auto const infile = (dir / "lz4_frame_in.txt").string();
+  auto const outfile = (dir / "lz4_frame_out.lz4").string();
+  auto const decompfile = (dir / "lz4_frame_decompressed.txt").string();
+  std::ofstream(infile, std::ios::binary) << text;
+
+  lz4::stream_compress(infile, outfile);
+  lz4::stream_decompress(outfile, decompfile);
+
+  std::ifstream result(decompfile, std::ios::binary);
+  std::stringstream content;
+  content << result.rdbuf();
+  EXPECT_EQ(text, content.str());
+}
@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "lz4_message.hpp"
+
+class Lz4MessageTestF : public ::testing::Test {
+public:
+  // Correlated JSON-like messages of 60 to ~400 bytes
+  static std::vector<std::string> make_messages(std::size_t count) {
+    std::vector<std::string> messages{};
+    std::uint32_t seed = 7;
+    auto next = [&seed] {
+      seed = seed * 1103515245u + 12345u;
+      return seed >> 16;
+    };
+    for (std::size_t i = 0; i < count; ++i) {
+      std::string msg = "{\"seq\":" + std::to_string(i) + ",\"topic\":\"orders." +
+                        std::to_string(next() % 8) + "\",\"status\":\"" +
+                        (next() % 3 ? "accepted" : "rejected") + "\"";
+      for (auto n = next() % 8; n > 0; --n) {
+        msg += ",\"item" + std::to_string(n) + "\":" + std::to_string(next() % 1000);
+      }
+      messages.push_back(msg + "}");
+    }
+    return messages;
+  }
+
+  static std::size_t independent_size(std::vector<std::string> const &messages) {
+    std::size_t size = 0;
+    for (auto const &msg : messages) {
+      lz4::buffer_t compressed;
+      lz4::compress(lz4::buffer_t(msg.begin(), msg.end()), compressed);
+      size += compressed.size();
+    }
+    return size;
+  }
+};
+
+TEST_F(Lz4MessageTestF, RoundTripAcrossRingWrapAndReset) {
+  // Small ring (1 KiB messages): wraps around many times
+  auto const messages = make_messages(5000);
+  lz4::MessageStream encoder(1024);
+  lz4::MessageStreamDecoder decoder(1024);
+
+  std::size_t stream_size = 0;
+  for (std::size_t i = 0; i < messages.size(); ++i) {
+    if (i == messages.size() / 2) {
+      encoder.reset();
+      decoder.reset();
+    }
+    auto const block = encoder.compress(messages[i]);
+    stream_size += block.size();
+    auto const decoded = decoder.decompress_view(lz4::utils::as_bytes(block));
+    ASSERT_EQ(messages[i], std::string_view(reinterpret_cast<char const *>(decoded.data()),
+                                            decoded.size()))
+        << "message " << i;
+  }
+  EXPECT_LT(stream_size * 2, independent_size(messages));
+
+  std::string const too_large(2048, 'x');
+  lz4::buffer_t block(lz4::compress_bound(too_large.size()));
+  EXPECT_EQ(lz4::Error::src_too_large,
+            encoder.compress_into(lz4::utils::as_bytes(too_large), lz4::utils::as_writable_bytes(block))
+                .error());
+}
+
+TEST_F(Lz4MessageTestF, PresetDictionary) {
+  auto const samples = make_messages(200);
+  std::string dictionary{};
+  for (auto const &msg : samples) {
+    dictionary += msg;
+  }
+  auto const messages = make_messages(300);
+
+  lz4::MessageStream with_dict(lz4::default_max_message_size, lz4::utils::as_bytes(dictionary));
+  lz4::MessageStream without_dict{};
+  lz4::MessageStreamDecoder decoder(lz4::default_max_message_size, lz4::utils::as_bytes(dictionary));
+
+  // Every message on a fresh stream: only the dictionary helps
+  std::size_t dict_size = 0, no_dict_size = 0;
+  for (auto const &msg : messages) {
+    with_dict.reset();
+    without_dict.reset();
+    decoder.reset();
+    auto const block = with_dict.compress(msg);
+    dict_size += block.size();
+    no_dict_size += without_dict.compress(msg).size();
+
+    std::string decoded(msg.size(), '\0');
+    auto const size = decoder.decompress_into(
+        lz4::utils::as_bytes(block), std::as_writable_bytes(std::span(decoded.data(), decoded.size())));
+    ASSERT_TRUE(size) << size.message();
+    ASSERT_EQ(msg, decoded);
+  }
+  EXPECT_LT(dict_size * 2, no_dict_size);
+
+  // Corrupted blocks are reported, and the decoder starts over
+  auto const block = with_dict.compress(messages.front());
+  std::string decoded(512, '\0');
+  auto const truncated = decoder.decompress_into(
+      lz4::utils::as_bytes(block).first(block.size() / 2),
+      std::as_writable_bytes(std::span(decoded.data(), decoded.size())));
+  EXPECT_EQ(lz4::Error::src_corrupted, truncated.error());
+}
@@ -0,0 +1,79 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <sstream>
+#include <string>
+
+#include "lz4_parallel.hpp"
+
+class Lz4ParallelTestF : public ::testing::Test {
+protected:
+  void SetUp() override {
+    for (int i = 0; text.size() < (3 << 20); ++i) {
+      text += "record " + std::to_string(i) + ": parallel lz4 round trip\n";
+    }
+  }
+
+public:
+  std::string text{};
+  utils::ThreadPool pool{4};
+  // Small chunks: many frames, decoded out of order by the workers
+  lz4::parallel::Params const params{.chunk_size = 256 << 10};
+};
+
+TEST_F(Lz4ParallelTestF, InMemoryRoundTripIsAPlainLz4Stream) {
+  auto const compressed = lz4::parallel::compress(lz4::utils::as_bytes(text), params, pool);
+  EXPECT_LT(compressed.size(), text.size());
+
+  auto const decompressed = lz4::parallel::decompress(compressed, pool);
+  EXPECT_EQ(text, std::string(decompressed.begin(), decompressed.end()));
+
+  // Readable by the sequential frame decoder (and the lz4 CLI)
+  std::stringstream in(std::string(compressed.begin(), compressed.end())), out;
+  lz4::stream::decompress(in, out);
+  EXPECT_EQ(text, out.str());
+
+  auto const empty = lz4::parallel::compress(lz4::utils::as_bytes(std::string_view()), params, pool);
+  EXPECT_TRUE(lz4::parallel::decompress(empty, pool).empty());
+}
+
+TEST_F(Lz4ParallelTestF, StreamRoundTripAndErrors) {
+  std::stringstream in(text), compressed, decompressed;
+  lz4::parallel::compress(in, compressed, params, pool);
+  lz4::parallel::decompress(compressed, decompressed, pool);
+  EXPECT_EQ(text, decompressed.str());
+
+  // A frame from the sequential encoder has no content size: refused, not misdecoded
+  std::stringstream in2(text), single, out;
+  lz4::stream::compress(in2, single);
+  EXPECT_THROW(lz4::parallel::decompress(single, out, pool), std::runtime_error);
+
+  auto truncated = compressed.str();
+  truncated.resize(truncated.size() - 10);
+  std::stringstream truncated_in(truncated), truncated_out;
+  EXPECT_THROW(lz4::parallel::decompress(truncated_in, truncated_out, pool), std::runtime_error);
+}
+
+TEST_F(Lz4ParallelTestF, ForgedContentSizesAreRejected) {
+  auto const compressed = lz4::parallel::compress(lz4::utils::as_bytes(text), params, pool);
+  auto const second = lz4::parallel::detail::frame_extent(lz4::utils::as_bytes(compressed)).size;
+  // Content_Size (8 bytes, LE) of the frames at offsets 0 and `second`
+  auto const forge = [&](std::uint64_t first_size, std::uint64_t second_size) {
+    auto bytes = compressed;
+    for (int k = 0; k < 8; ++k) {
+      bytes[6 + k] = static_cast<lz4::byte_t>(first_size >> (8 * k));
+      bytes[second + 6 + k] = static_cast<lz4::byte_t>(second_size >> (8 * k));
+    }
+    return bytes;
+  };
+  auto const size = std::uint64_t{256} << 10;
+
+  // Adding up to 16 (mod 2^64), then within the limit but more than the frame holds
+  EXPECT_THROW(lz4::parallel::decompress(forge(std::uint64_t{1} << 63, (std::uint64_t{1} << 63) + 16), pool),
+               std::runtime_error);
+  EXPECT_THROW(lz4::parallel::decompress(forge(size, 512 << 20), pool), std::runtime_error);
+
+  auto const forged = forge(size, 512 << 20);
+  std::stringstream forged_in(std::string(forged.begin(), forged.end())), out;
+  EXPECT_THROW(lz4::parallel::decompress(forged_in, out, pool), std::runtime_error);
+}
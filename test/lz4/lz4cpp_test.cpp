@@ -1,5 +1,12 @@
 #include <gtest/gtest.h>
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "corpus.hpp"
 #include "lz4_api.hpp"
 
 class Lz4TestF : public ::testing::Test {
@@ -53,4 +60,65 @@ TEST_F(Lz4TestF, BlockRoundTrip) {
 
   EXPECT_EQ(src, decompressed);
   EXPECT_EQ(input, decompressed_str);
-}
\ No newline at end of file
+  EXPECT_EQ(compressed.size(), compressed.capacity());
+}
+
+TEST_F(Lz4TestF, SpanRoundTripIntoCallerBuffers) {
+  std::array<std::byte, 1024> compressed{};
+  std::array<std::byte, 1024> decompressed{};
+  ASSERT_LE(lz4::compress_bound(input.size()), compressed.size());
+
+  auto const comp_size = lz4::compress_into(std::string_view(input), compressed);
+  ASSERT_TRUE(comp_size) << comp_size.message();
+
+  auto const block = std::span(compressed).first(*comp_size);
+  auto const decomp_size = lz4::decompress_into(block, std::span(decompressed).first(input.size()));
+  ASSERT_TRUE(decomp_size) << decomp_size.message();
+  EXPECT_EQ(input, std::string_view(reinterpret_cast<char const*>(decompressed.data()), *decomp_size));
+
+  // Errors are reported, not thrown
+  auto const too_small = lz4::compress_into(std::string_view(input), std::span(compressed).first(8));
+  EXPECT_EQ(lz4::Error::dst_too_small, too_small.error());
+  EXPECT_EQ(lz4::Error::src_corrupted,
+            lz4::decompress_into(block, std::span(decompressed).first(8)).error());
+}
+
+TEST_F(Lz4TestF, CompressionLevelSelectsMode) {
+  // Pseudo-random words: compressible, but not trivially
+  std::string text{};
+  std::uint32_t seed = 1;
+  while (text.size() < (64 << 10)) {
+    seed = seed * 1103515245u + 12345u;
+    text += "word" + std::to_string((seed >> 16) % 512) + ' ';
+  }
+  auto const src = to_bytes(text);
+
+  std::size_t fast_size = 0, hc_size = 0;
+  for (int level : {-10, -1, 0, 1, 3, 9, 12, 16}) {
+    lz4::buffer_t compressed;
+    lz4::buffer_t decompressed;
+    ASSERT_NE(0u, lz4::compress(src, compressed, level)) << "level " << level;
+    lz4::decompress(compressed, decompressed, src.size());
+    EXPECT_EQ(src, decompressed) << "level " << level;
+    if (level == lz4::default_level) {
+      fast_size = compressed.size();
+    } else if (level == lz4::max_level) {
+      hc_size = compressed.size();
+    }
+  }
+  EXPECT_LT(hc_size, fast_size);
+}
+
+TEST_F(Lz4TestF, CorpusRoundTrip) {
+  for (auto kind : utils::corpus::all_kinds) {
+    SCOPED_TRACE(utils::corpus::name(kind));
+    auto const data = utils::corpus::load(kind, 3 << 20);
+    for (int level : {-8, lz4::default_level, 9}) {
+      lz4::buffer_t compressed;
+      lz4::buffer_t decompressed;
+      ASSERT_NE(0u, lz4::compress(data, compressed, level)) << "level " << level;
+      lz4::decompress(compressed, decompressed, data.size());
+      EXPECT_EQ(data, decompressed) << "level " << level;
+    }
+  }
+}
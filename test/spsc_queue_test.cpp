@@ -0,0 +1,40 @@
+#include "spsc_queue.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <thread>
+
+TEST(SpscQueueTest, TransfersInOrderAcrossThreads) {
+  utils::SpscQueue<std::uint64_t> queue{8};
+  constexpr std::uint64_t count = 200000;
+
+  std::thread producer([&] {
+    for (std::uint64_t i = 0; i < count; ++i) {
+      ASSERT_TRUE(queue.push(i));
+    }
+    queue.close();
+  });
+
+  std::uint64_t expected = 0, value = 0;
+  while (queue.pop(value)) {
+    ASSERT_EQ(expected, value);
+    ++expected;
+  }
+  producer.join();
+  EXPECT_EQ(count, expected);
+}
+
+TEST(SpscQueueTest, CloseWakesABlockedProducer) {
+  utils::SpscQueue<int> queue{1};
+  ASSERT_TRUE(queue.push(1));  // full from now on
+
+  std::thread producer([&] { EXPECT_FALSE(queue.push(2)); });
+  queue.close();
+  producer.join();
+
+  int value = 0;
+  EXPECT_TRUE(queue.pop(value));  // drained after close
+  EXPECT_EQ(1, value);
+  EXPECT_FALSE(queue.pop(value));
+}
@@ -0,0 +1,89 @@
+#include "thread_pool.hpp"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST(ThreadPoolTest, RunsTasksAndReturnsResults) {
+  utils::ThreadPool pool{4};
+  EXPECT_EQ(4u, pool.size());
+
+  std::vector<std::future<int>> results{};
+  for (int i = 0; i < 100; ++i) {
+    results.push_back(pool.submit([i] { return i * i; }));
+  }
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_EQ(i * i, results[i].get());
+  }
+
+  auto failed = pool.submit([]() -> int { throw std::runtime_error("task failed"); });
+  EXPECT_THROW(failed.get(), std::runtime_error);
+}
+
+TEST(ThreadPoolTest, DestructorRunsPendingTasks) {
+  std::atomic<int> done{0};
+  {
+    utils::ThreadPool pool{2};
+    for (int i = 0; i < 50; ++i) {
+      pool.submit([&done] { done.fetch_add(1); });
+    }
+  }
+  EXPECT_EQ(50, done.load());
+}
+
+TEST(ThreadPoolTest, OrderedWriterKeepsSubmissionOrder) {
+  utils::ThreadPool pool{4};
+  std::stringstream out{};
+  std::string expected{};
+  {
+    utils::OrderedWriter writer(out, 3);
+    for (int i = 0; i < 20; ++i) {
+      auto const c = static_cast<unsigned char>('a' + i);
+      expected += static_cast<char>(c);
+      // the first tasks of each batch finish last
+      writer.push(pool.submit([c, i] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(i % 3 == 0 ? 5 : 0));
+        return utils::byte_buffer(1, c);
+      }));
+    }
+    writer.finish();
+  }
+  EXPECT_EQ(expected, out.str());
+
+  // Byte budget: the oldest buffers are written first, a larger one alone is let through
+  {
+    std::stringstream budgeted{};
+    utils::OrderedWriter writer(budgeted, 10, 2);
+    writer.push(pool.submit([] { return utils::byte_buffer(2, 'a'); }), 2);
+    EXPECT_TRUE(budgeted.str().empty());
+    writer.push(pool.submit([] { return utils::byte_buffer(5, 'b'); }), 5);
+    EXPECT_EQ("aa", budgeted.str());
+    writer.push(pool.submit([] { return utils::byte_buffer(1, 'c'); }), 1);
+    EXPECT_EQ("aabbbbb", budgeted.str());
+    writer.finish();
+    EXPECT_EQ("aabbbbbc", budgeted.str());
+  }
+
+  // A failed task: rethrown in order, the others are waited for
+  std::atomic<int> done{0};
+  {
+    utils::OrderedWriter writer(out, 4);
+    writer.push(pool.submit([]() -> utils::byte_buffer { throw std::runtime_error("task failed"); }));
+    for (int i = 0; i < 2; ++i) {
+      writer.push(pool.submit([&done] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        done.fetch_add(1);
+        return utils::byte_buffer{};
+      }));
+    }
+    EXPECT_THROW(writer.finish(), std::runtime_error);
+  }
+  EXPECT_EQ(2, done.load());
+}
@@ -0,0 +1,96 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <thread>
+
+#include "zstdpp_adaptive.hpp"
+
+class ZstdppAdaptiveTestF : public ::testing::Test {
+  protected:
+    void SetUp() override {
+      for (int i = 0; text.size() < (4 << 20); ++i) {
+        text += "record " + std::to_string(i * 7919 % 100003) + ": adaptive zstd level\n";
+      }
+    }
+
+  public:
+    std::string text{};
+
+    /// Simulated time: only SlowBuf makes it pass, so the timings do not depend on the machine (or on sanitizers)
+    struct SimulatedClock {
+      using duration = std::chrono::steady_clock::duration;
+      using rep = duration::rep;
+      using period = duration::period;
+      using time_point = std::chrono::time_point<SimulatedClock>;
+      static constexpr bool is_steady = true;
+
+      static inline duration elapsed{};
+      static time_point now() noexcept { return time_point{elapsed}; }
+    };
+
+    /// Takes 5 simulated ms on every write: an output much slower than the compression.
+    /// It still sleeps a little for real, so that the workers progress as they would behind a slow device.
+    class SlowBuf : public std::stringbuf {
+      protected:
+        std::streamsize xsputn(char const* s, std::streamsize n) override {
+          SimulatedClock::elapsed += std::chrono::milliseconds(5);
+          std::this_thread::sleep_for(std::chrono::milliseconds(1));
+          return std::stringbuf::xsputn(s, n);
+        }
+    };
+
+    std::string decompress(std::string const& compressed) {
+      std::stringstream in(compressed), out;
+      zstdpp::stream::decompress(in, out);
+      return out.str();
+    }
+};
+
+TEST_F(ZstdppAdaptiveTestF, SlowOutputRaisesTheLevel) {
+  for (zstdpp::threads_number_t const workers : {zstdpp::threads_number_t{1}, zstdpp::threads_number_t{0}}) {
+    SCOPED_TRACE(int{workers});
+    std::stringstream in(text);
+    SlowBuf slow{};
+    std::ostream out(&slow);
+    zstdpp::stream::Context ctx(1, workers);
+    auto const stats = zstdpp::adaptive::compress<SimulatedClock>(ctx, in, out, 1,
+                                                                  {.min_level = 1, .max_level = 5, .window = 256 << 10});
+
+    EXPECT_GT(stats.final_level(), 1);
+    EXPECT_EQ(0.0, stats.compress_seconds);
+    for (auto const& change : stats.levels) {
+      EXPECT_GE(change.level, 1);
+      EXPECT_LE(change.level, 5);
+    }
+    EXPECT_EQ(text.size(), stats.bytes_in);
+    EXPECT_EQ(slow.str().size(), stats.bytes_out);
+    EXPECT_EQ(text, decompress(slow.str()));
+  }
+}
+
+TEST_F(ZstdppAdaptiveTestF, FastOutputLowersTheLevel) {
+  // Without workers: with them, this input would be a single job, and the output come at the end only.
+  // Real time: compressing at level 9 and more takes far longer than writing to memory, with or without sanitizers.
+  std::stringstream in(text), out;
+  auto const stats = zstdpp::adaptive::compress(in, out, 9, 0, {.min_level = 3, .max_level = 19, .window = 256 << 10});
+  ASSERT_GE(stats.levels.size(), 2U);
+  EXPECT_EQ(9, stats.levels.front().level);
+  EXPECT_LT(stats.final_level(), 9);
+  EXPECT_GE(stats.final_level(), 3);
+  EXPECT_EQ(text, decompress(out.str()));
+
+  // Fixed bounds: no change
+  std::stringstream fixed_in(text), fixed_out;
+  auto const fixed = zstdpp::adaptive::compress(fixed_in, fixed_out, 7, 1, {.min_level = 7, .max_level = 7});
+  EXPECT_EQ(1U, fixed.levels.size());
+  EXPECT_EQ(text, decompress(fixed_out.str()));
+
+  std::stringstream empty_in, empty_out;
+  zstdpp::adaptive::compress(empty_in, empty_out);
+  EXPECT_TRUE(decompress(empty_out.str()).empty());
+  EXPECT_THROW(zstdpp::adaptive::compress(empty_in, empty_out, 3, 1, {.min_level = 5, .max_level = 4}),
+               std::invalid_argument);
+}
@@ -0,0 +1,122 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "zstdpp_batch.hpp"
+
+class ZstdppBatchTestF : public ::testing::Test {
+  protected:
+    void SetUp() override {
+      for (int i = 0; i < 1000; ++i) {
+        records.push_back("{\"id\": " + std::to_string(i) + ", \"name\": \"record " + std::to_string(i % 7) + "\"}");
+      }
+      records.push_back("");  // empty records are records too
+      for (auto const& record : records) {
+        inputs.push_back(zstdpp::utils::as_bytes(record));
+      }
+    }
+
+  public:
+    std::vector<std::string> records{};
+    std::vector<zstdpp::rospan_t> inputs{};
+    utils::ThreadPool pool{3};
+
+    void expect_records(zstdpp::Batch const& batch) const {
+      ASSERT_EQ(records.size(), batch.size());
+      for (size_t i = 0; i < records.size(); ++i) {
+        auto const record = batch[i];
+        EXPECT_EQ(records[i], std::string(reinterpret_cast<char const*>(record.data()), record.size()));
+      }
+    }
+};
+
+TEST_F(ZstdppBatchTestF, RoundTripThroughOneArena) {
+    zstdpp::Batch packed{}, unpacked{};
+    zstdpp::compress_batch(inputs, packed);
+    ASSERT_EQ(inputs.size(), packed.size());
+    EXPECT_EQ(packed.offsets.back(), packed.arena.size());
+    // every record is a standalone frame
+    EXPECT_EQ(packed[5].size(), ZSTD_findFrameCompressedSize(packed[5].data(), packed[5].size()));
+    EXPECT_EQ(records[5].size(), zstdpp::decompressed_size(packed[5]).value());
+
+    zstdpp::decompress_batch(packed, unpacked);
+    expect_records(unpacked);
+
+    // reused: same output, capacity kept
+    auto const* arena = unpacked.arena.data();
+    zstdpp::decompress_batch(packed, unpacked);
+    expect_records(unpacked);
+    EXPECT_EQ(arena, unpacked.arena.data());
+}
+
+TEST_F(ZstdppBatchTestF, SubBatchesOnThreadsGiveTheSameArena) {
+    zstdpp::Batch sequential{}, threaded{}, unpacked{};
+    zstdpp::compress_batch(inputs, sequential, 3);
+    zstdpp::compress_batch(inputs, threaded, 3, &pool, zstdpp::ContextPool::global(), 16);
+    EXPECT_EQ(sequential.arena, threaded.arena);
+    EXPECT_EQ(sequential.offsets, threaded.offsets);
+
+    zstdpp::decompress_batch(threaded.records(), unpacked, &pool, zstdpp::ContextPool::global(), 16);
+    expect_records(unpacked);
+}
+
+TEST_F(ZstdppBatchTestF, ErrorsLeaveTheOutputEmpty) {
+    zstdpp::Batch packed{}, unpacked{};
+    zstdpp::compress_batch(inputs, packed);
+    auto truncated = packed.records();
+    truncated[500] = truncated[500].first(truncated[500].size() - 1);
+    EXPECT_THROW(zstdpp::decompress_batch(truncated, unpacked, &pool, zstdpp::ContextPool::global(), 16),
+                 std::runtime_error);
+    EXPECT_TRUE(unpacked.empty());
+    EXPECT_TRUE(unpacked.arena.empty());
+
+    std::vector<zstdpp::rospan_t> garbage{zstdpp::utils::as_bytes(records[0])};
+    EXPECT_THROW(zstdpp::decompress_batch(garbage, unpacked), std::runtime_error);
+
+    zstdpp::compress_batch({}, packed);
+    EXPECT_TRUE(packed.empty());
+}
+
+TEST_F(ZstdppBatchTestF, HeaderSizesAreCheckedBeforeSizingTheArena) {
+    // Frame claiming `content_size` bytes, holding one raw byte
+    auto const frame = [](std::uint64_t content_size) {
+        std::vector<std::byte> bytes{std::byte{0x28}, std::byte{0xB5}, std::byte{0x2F}, std::byte{0xFD},
+                                     std::byte{0xE0}};  // single segment, 8-byte content size
+        for (int shift = 0; shift < 64; shift += 8) {
+            bytes.push_back(static_cast<std::byte>(content_size >> shift));
+        }
+        bytes.insert(bytes.end(), {std::byte{0x09}, std::byte{0x00}, std::byte{0x00}, std::byte{'x'}});
+        return bytes;
+    };
+    zstdpp::Batch unpacked{};
+    auto const one = frame(1);
+    std::vector<zstdpp::rospan_t> batch{one};
+    zstdpp::decompress_batch(batch, unpacked);
+    EXPECT_EQ(1, unpacked.arena.size());
+
+    auto const huge = frame(std::uint64_t{1} << 60);
+    batch = {one, huge};
+    EXPECT_THROW(zstdpp::decompress_batch(batch, unpacked), std::runtime_error);
+    EXPECT_TRUE(unpacked.empty());
+
+    // Lying under the limit: the frame cannot fill it
+    auto const lying = frame(1000);
+    batch = {lying, one};
+    EXPECT_THROW(zstdpp::decompress_batch(batch, unpacked), std::runtime_error);
+
+    // Plausible records adding up past max_batch_total_size: the arena is never sized for them
+    auto const big = frame(std::uint64_t{512} << 10);
+    std::vector<zstdpp::rospan_t> const many(zstdpp::max_batch_total_size / (size_t{512} << 10) + 1, big);
+    EXPECT_THROW(zstdpp::decompress_batch(many, unpacked), std::runtime_error);
+    EXPECT_TRUE(unpacked.empty());
+    EXPECT_LT(unpacked.arena.capacity(), size_t{1} << 20);
+
+    // Bounds adding up past SIZE_MAX
+    auto const half = std::numeric_limits<size_t>::max() / 2 + 1;
+    EXPECT_THROW(utils::batch::transform(2, unpacked, [&](size_t){ return half; }, [](auto...){ return size_t{0}; }),
+                 std::runtime_error);
+    EXPECT_TRUE(unpacked.empty());
+}
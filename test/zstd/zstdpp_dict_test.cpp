@@ -0,0 +1,80 @@
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "zstdpp_dict.hpp"
+
+class ZstdppDictTestF : public ::testing::Test {
+  protected:
+    void SetUp() override {
+      // Small JSON records sharing their structure
+      for (int i = 0; i < 2000; ++i) {
+        records.push_back(
+            "{\"id\":" + std::to_string(i) + ",\"user\":\"user" + std::to_string(i % 97) +
+            "\",\"status\":\"" + (i % 3 ? "active" : "suspended") +
+            "\",\"tags\":[\"alpha\",\"beta\"],\"score\":" + std::to_string(i * 37 % 1000) +
+            ",\"comment\":\"this is a small record compressed on its own\"}");
+      }
+    }
+
+  public:
+    std::vector<std::string> records{};
+};
+
+TEST_F(ZstdppDictTestF, DictionaryImprovesSmallRecordRatio) {
+  auto const dict = zstdpp::Dictionary::train(records, 16 * 1024);
+  zstdpp::DictionaryCache cache{};
+  cache.add(dict);
+
+  std::size_t plain_size = 0, with_dict = 0, without_dict = 0;
+  for (auto const& record : records) {
+    auto const data = zstdpp::utils::as_bytes(record);
+    auto const compressed = zstdpp::compress_using_dict(cache, dict.id(), data);
+    EXPECT_EQ(dict.id(), ZSTD_getDictID_fromFrame(compressed.data(), compressed.size()));
+    EXPECT_EQ(record, zstdpp::utils::to_string(zstdpp::decompress(cache, compressed)));
+
+    plain_size += record.size();
+    with_dict += compressed.size();
+    without_dict += zstdpp::compress(record, 3).size();
+  }
+  EXPECT_LT(with_dict * 2, without_dict);
+  EXPECT_LT(with_dict, plain_size);
+
+  // Frames without dictionary go through the same function
+  auto const plain = zstdpp::compress(records.front(), 3);
+  EXPECT_EQ(records.front(), zstdpp::utils::to_string(zstdpp::decompress(cache, plain)));
+}
+
+TEST_F(ZstdppDictTestF, DictionaryLoadedByIdFromDirectory) {
+  auto const dir = std::filesystem::temp_directory_path() / "zstdpp_dict_test";
+  std::filesystem::create_directories(dir);
+  auto const dict = zstdpp::Dictionary::train(records, 16 * 1024);
+  dict.save(dir);
+
+  zstdpp::DictionaryCache writer{dir}, reader{dir};
+  auto const compressed = zstdpp::compress_using_dict(writer, dict.id(), zstdpp::utils::as_bytes(records[42]));
+  EXPECT_EQ(records[42], zstdpp::utils::to_string(zstdpp::decompress(reader, compressed)));
+
+  zstdpp::DictionaryCache empty{};
+  EXPECT_THROW(zstdpp::decompress(empty, compressed), std::runtime_error);
+  std::filesystem::remove_all(dir);
+}
+
+TEST_F(ZstdppDictTestF, DictionaryIdCannotBeReplaced) {
+  auto const dict = zstdpp::Dictionary::train(records, 16 * 1024);
+  zstdpp::DictionaryCache cache{};
+  cache.add(dict);
+  auto const* ddict = cache.ddict(dict.id());
+  EXPECT_NO_THROW(cache.add(dict));
+
+  // Same header (and ID), other content
+  auto content = dict.content();
+  ASSERT_GT(content.size(), 8u);
+  content.back() ^= 0xFF;
+  zstdpp::Dictionary const forged{content};
+  ASSERT_EQ(dict.id(), forged.id());
+  EXPECT_THROW(cache.add(forged), std::invalid_argument);
+  EXPECT_EQ(ddict, cache.ddict(dict.id()));
+}
@@ -0,0 +1,103 @@
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <string>
+
+#include "zstdpp_parallel.hpp"
+#include "zstdpp_seekable.hpp"
+
+class ZstdppParallelTestF : public ::testing::Test {
+  protected:
+    void SetUp() override {
+      for (int i = 0; text.size() < (5 << 20) + 17; ++i) {
+        text += "record " + std::to_string(i) + ": parallel zstd frames\n";
+      }
+    }
+
+  public:
+    std::string text{};
+    utils::ThreadPool pool{3};
+
+    static size_t count_frames(std::string const &compressed) {
+      size_t frames = 0;
+      for (size_t pos = 0; pos < compressed.size(); ++frames) {
+        pos += ZSTD_findFrameCompressedSize(compressed.data() + pos, compressed.size() - pos);
+      }
+      return frames;
+    }
+};
+
+TEST_F(ZstdppParallelTestF, RoundTripCompatibleWithStream) {
+  for (size_t chunk_size : {size_t{4096}, size_t{1} << 20, size_t{64} << 20}) {
+    std::stringstream in(text), compressed, decompressed;
+    zstdpp::parallel::compress(in, compressed, {.chunk_size = chunk_size}, pool);
+    EXPECT_EQ((text.size() + chunk_size - 1) / chunk_size, count_frames(compressed.str()));
+
+    std::stringstream compressed_copy(compressed.str()), stream_decompressed;
+    zstdpp::stream::decompress(compressed_copy, stream_decompressed);
+    EXPECT_EQ(text, stream_decompressed.str());
+
+    zstdpp::parallel::decompress(compressed, decompressed, pool);
+    EXPECT_EQ(text, decompressed.str());
+  }
+
+  std::stringstream empty_in, empty_compressed, empty_out;
+  zstdpp::parallel::compress(empty_in, empty_compressed, {}, pool);
+  zstdpp::parallel::decompress(empty_compressed, empty_out, pool);
+  EXPECT_TRUE(empty_out.str().empty());
+}
+
+TEST_F(ZstdppParallelTestF, FallsBackOnFramesWithoutContentSize) {
+  // One stream::compress frame (size unknown), alone or after splittable frames
+  std::stringstream in(text), single;
+  zstdpp::stream::compress(in, single);
+  std::stringstream head_in(text.substr(0, 100000)), head;
+  zstdpp::parallel::compress(head_in, head, {.chunk_size = 30000}, pool);
+
+  for (auto const &compressed : {single.str(), head.str() + single.str()}) {
+    std::stringstream compressed_in(compressed), decompressed;
+    zstdpp::parallel::decompress(compressed_in, decompressed, pool);
+    EXPECT_EQ(compressed.size() == single.str().size() ? text : text.substr(0, 100000) + text,
+              decompressed.str());
+  }
+
+  // Seekable format: independent frames, and a skippable frame (the seek table)
+  std::stringstream seekable_in(text), seekable, decompressed;
+  zstdpp::seekable::compress(seekable_in, seekable, 1 << 20);
+  zstdpp::parallel::decompress(seekable, decompressed, pool);
+  EXPECT_EQ(text, decompressed.str());
+}
+
+TEST_F(ZstdppParallelTestF, CorruptedOrTruncatedInputThrows) {
+  std::stringstream in(text), compressed;
+  zstdpp::parallel::compress(in, compressed, {.chunk_size = 1 << 20}, pool);
+
+  auto truncated = compressed.str();
+  truncated.resize(truncated.size() - 10);
+  std::stringstream truncated_in(truncated), out;
+  EXPECT_THROW(zstdpp::parallel::decompress(truncated_in, out, pool), std::runtime_error);
+
+  auto corrupted = compressed.str();
+  corrupted[corrupted.size() / 2] ^= 0x5A;
+  std::stringstream corrupted_in(corrupted);
+  EXPECT_THROW(zstdpp::parallel::decompress(corrupted_in, out, pool), std::runtime_error);
+
+  std::stringstream garbage("not a zstd frame at all");
+  EXPECT_THROW(zstdpp::parallel::decompress(garbage, out, pool), std::runtime_error);
+}
+
+TEST_F(ZstdppParallelTestF, ForgedContentSizesAreNotTrusted) {
+  // Frames of a few KiB, with a 4-byte Frame_Content_Size right after the descriptor (single segment)
+  std::stringstream in(text.substr(0, 300000)), compressed;
+  zstdpp::parallel::compress(in, compressed, {.chunk_size = 70000}, pool);
+  auto forged = compressed.str();
+  ASSERT_EQ(0xA0, static_cast<unsigned char>(forged[4]) & 0xE0);
+  ASSERT_LT(ZSTD_findFrameCompressedSize(forged.data(), forged.size()), size_t{16} << 10);
+
+  // 512 MiB: within max_frame_content, but far more than such a frame can produce
+  for (int k = 0; k < 4; ++k) {
+    forged[5 + k] = static_cast<char>((size_t{512} << 20) >> (8 * k));
+  }
+  std::stringstream forged_in(forged), out;
+  EXPECT_THROW(zstdpp::parallel::decompress(forged_in, out, pool), std::runtime_error);
+}
@@ -0,0 +1,55 @@
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <string>
+
+#include "zstdpp_pipeline.hpp"
+
+class ZstdppPipelineTestF : public ::testing::Test {
+  protected:
+    void SetUp() override {
+      for (int i = 0; text.size() < (5 << 20); ++i) {
+        text += "record " + std::to_string(i) + ": pipelined zstd streaming\n";
+      }
+    }
+
+  public:
+    std::string text{};
+};
+
+TEST_F(ZstdppPipelineTestF, RoundTripCompatibleWithStream) {
+  // Small chunks and few buffers: the stages wait on each other all the time
+  for (auto const &options : {zstdpp::pipeline::Options{}, zstdpp::pipeline::Options{.buffers = 2, .chunk_size = 4096}}) {
+    std::stringstream in(text), compressed, decompressed;
+    zstdpp::pipeline::compress(in, compressed, 1, 3, options);
+    EXPECT_LT(compressed.str().size(), text.size() / 4);
+
+    std::stringstream compressed_copy(compressed.str()), stream_decompressed;
+    zstdpp::stream::decompress(compressed_copy, stream_decompressed);
+    EXPECT_EQ(text, stream_decompressed.str());
+
+    zstdpp::pipeline::decompress(compressed, decompressed, options);
+    EXPECT_EQ(text, decompressed.str());
+  }
+
+  std::stringstream empty_in, empty_compressed, empty_out;
+  zstdpp::pipeline::compress(empty_in, empty_compressed);
+  zstdpp::pipeline::decompress(empty_compressed, empty_out);
+  EXPECT_TRUE(empty_out.str().empty());
+}
+
+TEST_F(ZstdppPipelineTestF, ErrorsStopEveryStage) {
+  std::stringstream in(text), compressed;
+  zstdpp::stream::compress(in, compressed);
+
+  auto corrupted = compressed.str();
+  corrupted[corrupted.size() / 2] ^= 0x5A;
+  std::stringstream corrupted_in(corrupted), out;
+  EXPECT_THROW(zstdpp::pipeline::decompress(corrupted_in, out, {.buffers = 2, .chunk_size = 4096}),
+               std::runtime_error);
+
+  auto truncated = compressed.str();
+  truncated.resize(truncated.size() - 16);
+  std::stringstream truncated_in(truncated), truncated_out;
+  EXPECT_THROW(zstdpp::pipeline::decompress(truncated_in, truncated_out), std::runtime_error);
+}
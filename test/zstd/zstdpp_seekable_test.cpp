@@ -0,0 +1,76 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <sstream>
+#include <string>
+
+#include "zstdpp_seekable.hpp"
+
+class ZstdppSeekableTestF : public ::testing::Test {
+  protected:
+    void SetUp() override {
+      // 1 MiB of lines with unique numbers, so every range is distinguishable
+      for (int i = 0; plain.size() < (1 << 20); ++i) {
+        plain += "line " + std::to_string(i) + ": the quick brown fox jumps over the lazy dog\n";
+      }
+      std::stringstream in(plain);
+      zstdpp::seekable::compress(in, compressed, frame_size);
+    }
+
+  public:
+    static constexpr std::size_t frame_size = 64 * 1024;
+    std::string plain{};
+    std::stringstream compressed{};
+};
+
+TEST_F(ZstdppSeekableTestF, SeekTableDescribesFrames) {
+  auto const table = zstdpp::seekable::SeekTable::read(compressed);
+
+  EXPECT_EQ(plain.size(), table.decompressed_size());
+  EXPECT_EQ((plain.size() + frame_size - 1) / frame_size, table.frames().size());
+  EXPECT_EQ(frame_size, table.frames().front().decompressed_size);
+  EXPECT_EQ(0u, table.frame_index(frame_size - 1));
+  EXPECT_EQ(1u, table.frame_index(frame_size));
+}
+
+TEST_F(ZstdppSeekableTestF, ReadAtRandomOffsets) {
+  zstdpp::seekable::Reader reader(compressed);
+  ASSERT_EQ(plain.size(), reader.size());
+
+  // within a frame, across frame boundaries, at the end, and past the end
+  for (std::uint64_t offset : {std::uint64_t{0}, std::uint64_t{100}, std::uint64_t{frame_size - 10},
+                               std::uint64_t{3 * frame_size + 5}, std::uint64_t{plain.size() - 7}}) {
+    auto const range = reader.read_at(offset, 2 * frame_size + 20);
+    EXPECT_EQ(plain.substr(offset, 2 * frame_size + 20), zstdpp::utils::to_string(range));
+  }
+  EXPECT_TRUE(reader.read_at(plain.size() + 1, 10).empty());
+}
+
+TEST_F(ZstdppSeekableTestF, PlainDecoderSkipsSeekTable) {
+  std::stringstream decompressed{};
+  zstdpp::stream::decompress(compressed, decompressed);
+  EXPECT_EQ(plain, decompressed.str());
+}
+
+TEST_F(ZstdppSeekableTestF, ForgedFrameSizesAreRejected) {
+  auto const original = compressed.str();
+  auto const nb_frames = (plain.size() + frame_size - 1) / frame_size;
+  // Decompressed_Size of entry `i`
+  auto const forge = [&](std::size_t i, std::uint32_t size) {
+    auto bytes = original;
+    auto const pos = bytes.size() - zstdpp::seekable::footer_size - (nb_frames - i) * 8 + 4;
+    for (int k = 0; k < 4; ++k) {
+      bytes[pos + k] = static_cast<char>(size >> (8 * k));
+    }
+    return bytes;
+  };
+
+  std::stringstream too_large(forge(0, 0x80000000u));
+  EXPECT_THROW(zstdpp::seekable::SeekTable::read(too_large), std::runtime_error);
+
+  // Within the limit, but more than the frame holds: rejected before allocating for it
+  std::stringstream lying(forge(1, 1u << 29));
+  zstdpp::seekable::Reader reader(lying);
+  EXPECT_EQ(plain.substr(0, 100), zstdpp::utils::to_string(reader.read_at(0, 100)));
+  EXPECT_THROW(reader.read_at(frame_size, 100), std::runtime_error);
+}
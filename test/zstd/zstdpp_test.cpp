@@ -1,7 +1,15 @@
 #include <gtest/gtest.h>
 
+#include <array>
+#include <cstddef>
+#include <cstring>
 #include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <vector>
 
+#include "corpus.hpp"
 #include "zstdpp_helper.hpp"
 
 class ZstdppTestF : public ::testing::Test {
@@ -35,6 +43,11 @@ TEST_F(ZstdppTestF, BlockRoundTrip) {
   std::cout << "\nDecompressed Data: " << decompressed_str << '\n';
   
   EXPECT_EQ(input, decompressed_str);
+  // By value: no worst-case capacity kept; caller buffer: kept for reuse
+  EXPECT_EQ(compressed.size(), compressed.capacity());
+  buffer_t reused{};
+  zstdpp::inplace::compress(zstdpp::utils::to_bytes(input), reused, compress_level);
+  EXPECT_EQ(zstdpp::compress_bound(input.size()), reused.capacity());
 }
 
 TEST_F(ZstdppTestF, StreamRoundTrip) {
@@ -59,3 +72,194 @@ TEST_F(ZstdppTestF, StreamRoundTrip) {
 
   EXPECT_EQ(input, decomp_str);
 }
+
+TEST_F(ZstdppTestF, ContextPoolSteadyStateAllocatesNothing) {
+  zstdpp::ContextPool pool{};
+  auto const src = zstdpp::utils::to_bytes(input);
+
+  // Warm up: the first calls create the contexts and their workspaces
+  for (int i = 0; i < 4; ++i) {
+    auto const compressed = zstdpp::compress(pool, src);
+    EXPECT_EQ(src, zstdpp::decompress(pool, compressed));
+  }
+  auto const warm = pool.stats();
+  EXPECT_GT(warm.allocations, 0u);
+
+  for (int i = 0; i < 100; ++i) {
+    auto const compressed = zstdpp::compress(pool, src);
+    EXPECT_EQ(src, zstdpp::decompress(pool, compressed));
+  }
+  auto const steady = pool.stats();
+  EXPECT_EQ(warm.allocations, steady.allocations);
+  EXPECT_EQ(warm.created, steady.created);
+  EXPECT_EQ(warm.reused + 200, steady.reused);
+}
+
+TEST_F(ZstdppTestF, ContextPoolSharedAcrossThreads) {
+  zstdpp::ContextPool pool{2};
+  auto const src = zstdpp::utils::to_bytes(input);
+
+  std::vector<std::thread> workers;
+  std::vector<int> failures(4, 0);
+  for (std::size_t t = 0; t < failures.size(); ++t) {
+    workers.emplace_back([&, t] {
+      for (int i = 0; i < 50; ++i) {
+        std::stringstream compressed, decompressed;
+        std::stringstream in(input);
+        zstdpp::stream::compress(pool, in, compressed);
+        zstdpp::stream::decompress(pool, compressed, decompressed);
+        failures[t] += (decompressed.str() != input);
+        failures[t] += (zstdpp::decompress(pool, zstdpp::compress(pool, src)) != src);
+      }
+    });
+  }
+  for (auto& worker : workers) {
+    worker.join();
+  }
+
+  for (auto const failure : failures) {
+    EXPECT_EQ(failure, 0);
+  }
+  // Each thread keeps at most one context of each kind alive at a time
+  EXPECT_LE(pool.stats().created, 2 * failures.size());
+}
+
+TEST_F(ZstdppTestF, CompressionLevelIsApplied) {
+  // Pseudo-random words picked from the input text
+  buffer_t src{};
+  std::uint32_t seed = 1;
+  for (int i = 0; i < 20000; ++i) {
+    seed = seed * 1664525u + 1013904223u;
+    auto const pos = (seed >> 8) % (input.size() - 8);
+    src.insert(src.end(), input.begin() + pos, input.begin() + pos + 1 + (seed % 7));
+  }
+
+  auto const fast = zstdpp::compress(src, -5);
+  auto const normal = zstdpp::compress(src, 3);
+  auto const strong = zstdpp::compress(src, zstdpp::Params{}.level(19).checksum());
+
+  EXPECT_GT(fast.size(), normal.size());
+  EXPECT_LT(strong.size(), normal.size());
+  for (auto compressed : {fast, normal, strong}) {
+    EXPECT_EQ(src, zstdpp::decompress(compressed));
+  }
+}
+
+TEST_F(ZstdppTestF, StreamParamsRoundTrip) {
+  auto const params = zstdpp::Params{}
+                          .level(5)
+                          .strategy(ZSTD_btlazy2)
+                          .window_log(24)
+                          .hash_log(20)
+                          .chain_log(20)
+                          .long_distance_matching()
+                          .ldm_hash_log(20)
+                          .checksum()
+                          .content_size(false);
+  std::string text{};
+  for (int i = 0; i < 200; ++i) {
+    text += input;
+  }
+
+  std::stringstream in(text), compressed, decompressed;
+  zstdpp::stream::compress(in, compressed, params);
+  zstdpp::stream::decompress(compressed, decompressed, params);
+
+  EXPECT_EQ(text, decompressed.str());
+  EXPECT_THROW(zstdpp::compress(zstdpp::utils::to_bytes(input), zstdpp::Params{}.window_log(1)),
+               std::runtime_error);
+}
+
+TEST_F(ZstdppTestF, SpanRoundTripIntoCallerBuffers) {
+  std::array<std::byte, 1024> compressed{};
+  std::array<std::byte, 1024> decompressed{};
+  ASSERT_LE(zstdpp::compress_bound(input.size()), compressed.size());
+
+  auto const comp_size = zstdpp::compress_into(std::string_view(input), compressed);
+  ASSERT_TRUE(comp_size) << comp_size.message();
+
+  auto const frame = std::span(compressed).first(*comp_size);
+  EXPECT_EQ(input.size(), zstdpp::decompressed_size(frame).value());
+
+  auto const decomp_size = zstdpp::decompress_into(frame, decompressed);
+  ASSERT_TRUE(decomp_size) << decomp_size.message();
+  EXPECT_EQ(input, std::string_view(reinterpret_cast<char const*>(decompressed.data()), *decomp_size));
+
+  // Errors are reported, not thrown
+  auto const too_small = zstdpp::compress_into(std::string_view(input), std::span(compressed).first(8));
+  EXPECT_FALSE(too_small);
+  EXPECT_EQ(ZSTD_error_dstSize_tooSmall, too_small.error());
+  EXPECT_FALSE(zstdpp::decompress_into(frame.first(frame.size() / 2), decompressed));
+  EXPECT_THROW(too_small.value(), std::runtime_error);
+  auto const invalid = zstdpp::compress_into(zstdpp::utils::as_bytes(input), compressed, zstdpp::Params{}.window_log(1));
+  EXPECT_EQ(ZSTD_error_parameter_outOfBound, invalid.error());
+}
+
+TEST_F(ZstdppTestF, MappedFileRoundTrip) {
+  auto const dir = std::filesystem::temp_directory_path();
+  std::string const infile{(dir / "input_mmap.txt").string()}, outfile{(dir / "output_mmap.zst").string()},
+      decomp_outfile{(dir / "decompressed_mmap.txt").string()};
+
+  // Several slices of the in-place compression loop
+  std::string text{};
+  for (int i = 0; text.size() < (9 << 20); ++i) {
+    text += "line " + std::to_string(i) + ": " + input;
+  }
+  fs::create_file(infile, zstdpp::utils::to_bytes(text));
+
+  zstdpp::stream_compress(infile, outfile);
+  auto const compressed = fs::map_file(outfile);
+  EXPECT_EQ(text.size(), ZSTD_getFrameContentSize(compressed.data(), compressed.size()));
+
+  // Known content size: decompressed into the mapping of the output file
+  zstdpp::stream_decompress(outfile, decomp_outfile);
+  auto const decompressed = fs::map_file(decomp_outfile);
+  ASSERT_EQ(text.size(), decompressed.size());
+  EXPECT_EQ(0, std::memcmp(text.data(), decompressed.data(), text.size()));
+
+  // Unknown content size (compressed from a stream): decompressed through a stream
+  {
+    std::stringstream in(text);
+    std::ofstream out(outfile, std::ios::binary);
+    zstdpp::stream::compress(in, out);
+  }
+  zstdpp::stream_decompress(outfile, decomp_outfile);
+  EXPECT_EQ(text, zstdpp::utils::to_string(fs::read_file(decomp_outfile)));
+
+  // Empty files are not mapped
+  fs::create_file(infile, {});
+  zstdpp::stream_compress(infile, outfile);
+  zstdpp::stream_decompress(outfile, decomp_outfile);
+  EXPECT_EQ(0u, std::filesystem::file_size(decomp_outfile));
+
+  // Forged content sizes: one raw block of a single byte
+  auto const forged = [](std::uint64_t content_size) {
+    zstdpp::buffer_t frame{0x28, 0xB5, 0x2F, 0xFD, 0xE0};
+    for (int i = 0; i < 8; ++i) {
+      frame.push_back(static_cast<unsigned char>(content_size >> (8 * i)));
+    }
+    frame.insert(frame.end(), {0x09, 0x00, 0x00, 'x'});
+    return frame;
+  };
+  for (std::uint64_t const content_size : {std::uint64_t{1} << 40, std::uint64_t{1000}}) {
+    SCOPED_TRACE(content_size);
+    fs::create_file(outfile, forged(content_size));
+    EXPECT_THROW(zstdpp::stream_decompress(outfile, decomp_outfile), std::runtime_error);
+    EXPECT_FALSE(std::filesystem::exists(decomp_outfile));
+  }
+}
+
+TEST_F(ZstdppTestF, CorpusRoundTrip) {
+  for (auto kind : utils::corpus::all_kinds) {
+    SCOPED_TRACE(utils::corpus::name(kind));
+    auto const data = utils::corpus::load(kind, 3 << 20);
+
+    auto const compressed = zstdpp::compress(data);
+    EXPECT_EQ(data, zstdpp::decompress(compressed));
+
+    std::stringstream in(std::string(data.begin(), data.end())), stream_compressed, stream_decompressed;
+    zstdpp::stream::compress(in, stream_compressed, 2, 3);
+    zstdpp::stream::decompress(stream_compressed, stream_decompressed);
+    EXPECT_EQ(in.str(), stream_decompressed.str());
+  }
+}
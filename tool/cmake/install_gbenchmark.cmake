@@ -29,5 +29,5 @@ endfunction()
 
 # link google-benchmark to target
 function(link_gbenchmark target)
-  target_link_libraries(${target} benchmark::benchmark)
+  target_link_libraries(${target} PRIVATE benchmark::benchmark)
 endfunction()
\ No newline at end of file